@@ -10,14 +10,46 @@ Modified: 2012-02-02
 #include <iostream>
 #include <fstream>
 #include <iomanip>
+#include <sstream>
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
 #include <rl_pursuit/json/json.h>
 #include <rl_pursuit/factory/WorldFactory.h>
 #include <rl_pursuit/common/Util.h>
 #include <rl_pursuit/learning/OutputDT.h>
 
+struct TrialSettings {
+  unsigned int numEpisodes;
+  unsigned int maxNumStepsPerEpisode;
+  unsigned int numStepsPerEpisode;
+  bool runForFixedLength;
+  bool displayDescriptionQ;
+  bool displayObsQ;
+  bool displayStepsPerEpisodeQ;
+  bool displayStepsPerTrialQ;
+  bool outputDTCSVQ;
+  std::string outputDTFilename;
+  unsigned int outputDTSteps;
+};
+
+// the trials left for the worker threads and their buffered output
+struct TrialQueue {
+  TrialQueue(int numTrials);
+
+  boost::mutex mutex;
+  int numTrials;
+  int nextTrial;
+  int nextOutput; // the first trial whose output hasn't been printed
+  std::vector<boost::shared_ptr<std::ostringstream> > outputs;
+};
+
+unsigned int getRandomSeed(unsigned int trialNum, bool randomizeSeedQ);
+// returns false if the DT output has collected enough data before the trial started
+bool runTrial(const Json::Value &options, const TrialSettings &settings, int trial, unsigned int trialNum, unsigned int randomSeed, std::vector<unsigned int> &numSteps, std::vector<unsigned int> &numCaptures, std::ostream &out, boost::shared_ptr<OutputDT> &outputDT, boost::shared_ptr<std::vector<Action::Type> > &actions);
+void runTrialsWorker(const Json::Value &options, const TrialSettings &settings, int startTrial, bool randomizeSeedQ, TrialQueue &queue, std::vector<std::vector<unsigned int> > &numSteps, std::vector<std::vector<unsigned int> > &numCaptures);
 void displaySummary(double timePassed, const std::vector<std::vector<unsigned int> > &numSteps);
-void displayStepsPerTrial(bool displayStepsPerEpisodeQ, const std::vector<unsigned int> &numStepsPerTrial);
+void displayStepsPerTrial(std::ostream &out, bool displayStepsPerEpisodeQ, const std::vector<unsigned int> &numStepsPerTrial);
 void saveResults(const std::string &filename, int startTrial, const std::vector<std::vector<unsigned int> > &numSteps);
 void saveConfig(const Json::Value &options);
 void replaceOptsDir(Json::Value &options);
@@ -84,133 +116,70 @@ int main(int argc, const char *argv[])
 
   replaceOptsJob(options,boost::lexical_cast<std::string>(jobNum)); 
 
-  unsigned int numEpisodes = options.get("numEpisodesPerTrial",1).asUInt();
-  bool displayDescriptionQ = options["verbosity"].get("description",true).asBool();
+  TrialSettings settings;
+  settings.numEpisodes = options.get("numEpisodesPerTrial",1).asUInt();
+  settings.maxNumStepsPerEpisode = maxNumStepsPerEpisode;
+  settings.displayDescriptionQ = options["verbosity"].get("description",true).asBool();
   bool displaySummaryQ = options["verbosity"].get("summary",true).asBool();
-  bool displayObsQ = options["verbosity"].get("observation",true).asBool();
-  bool displayStepsPerEpisodeQ = options["verbosity"].get("stepsPerEpisode",true).asBool();
-  bool displayStepsPerTrialQ = options["verbosity"].get("stepsPerTrial",true).asBool();
+  settings.displayObsQ = options["verbosity"].get("observation",true).asBool();
+  settings.displayStepsPerEpisodeQ = options["verbosity"].get("stepsPerEpisode",true).asBool();
+  settings.displayStepsPerTrialQ = options["verbosity"].get("stepsPerTrial",true).asBool();
   std::string saveFilename = options["save"].get("results","").asString();
   bool saveResultsQ = (saveFilename != "");
   bool randomizeSeedQ = options.get("randomizeSeed",false).asBool();
   // running for fixed lengths
-  unsigned int numStepsPerEpisode = options.get("numStepsPerEpisode",0).asUInt();
-  bool runForFixedLength = (numStepsPerEpisode != 0);
+  settings.numStepsPerEpisode = options.get("numStepsPerEpisode",0).asUInt();
+  settings.runForFixedLength = (settings.numStepsPerEpisode != 0);
 
   // get the output DT information
-  unsigned int outputDTSteps = options["verbosity"].get("dtsteps",0).asUInt();
-  std::string outputDTFilename = options["verbosity"].get("dtfile","").asString();
-  bool outputDTCSVQ = (outputDTFilename != "");
+  settings.outputDTSteps = options["verbosity"].get("dtsteps",0).asUInt();
+  settings.outputDTFilename = options["verbosity"].get("dtfile","").asString();
+  settings.outputDTCSVQ = (settings.outputDTFilename != "");
   boost::shared_ptr<OutputDT> outputDT;
   boost::shared_ptr<std::vector<Action::Type> > actions;
 
-  Observation obs;
+  // trials run in parallel on this many threads, each on its own world
+  unsigned int numThreads = options.get("threads",1).asUInt();
+  if (numThreads == 0)
+    numThreads = 1;
+  if (settings.outputDTCSVQ && (numThreads > 1)) {
+    std::cerr << "WARNING: the DT output needs the trials in order, running with 1 thread" << std::endl;
+    numThreads = 1;
+  }
+  if (numThreads > (unsigned int)numTrials)
+    numThreads = numTrials;
+
   double startTime = getTime();
 
-  std::vector<std::vector<unsigned int> > numSteps(numTrials,std::vector<unsigned int>(numEpisodes,0));
-  std::vector<std::vector<unsigned int> > numCaptures(numTrials,std::vector<unsigned int>(numEpisodes,0));
+  std::vector<std::vector<unsigned int> > numSteps(numTrials,std::vector<unsigned int>(settings.numEpisodes,0));
+  std::vector<std::vector<unsigned int> > numCaptures(numTrials,std::vector<unsigned int>(settings.numEpisodes,0));
   std::vector<std::vector<unsigned int> > *results = &numSteps;
-  if (runForFixedLength)
+  if (settings.runForFixedLength)
     results = &numCaptures;
 
   std::cout << "Running for " << numTrials << " trials" << std::endl;
   
   unsigned int trialNum;
-  unsigned int randomSeed;
-  for (int trial = 0; trial < numTrials; trial++) {
-    trialNum = trial + startTrial;
-    if (randomizeSeedQ)
-      randomSeed = getTime() * 1000000 + 1000 * getpid() + trialNum; // hopefully random enough
-    else
-      randomSeed = trialNum;
-    //std::cout << "RANDOM SEED: " << randomSeed << std::endl;
-
-    Json::Value trialOptions(options);
-    replaceOptsTrial(trialOptions,trialNum);
-
-    boost::shared_ptr<World> world = createWorldAgents(randomSeed,trialNum,trialOptions);
-    boost::shared_ptr<const WorldModel> model = world->getModel();
-    std::cout << "Ad hoc agent ind: " << model->getAdhocInd() << std::endl;
-
-    // INITIALIZATION
-    if (trial == 0) {
-      if (displayDescriptionQ)
-        std::cout << world->generateDescription() << std::endl;
-      if (outputDTCSVQ) {
-        // set up the actions
-        actions = boost::shared_ptr<std::vector<Action::Type> >(new std::vector<Action::Type>(model->getNumAgents()));
-        // create models for the DT csv output if required
-        std::vector<std::string> modelNames;
-        //modelNames.push_back("GR");
-        //modelNames.push_back("TA");
-        //modelNames.push_back("GP");
-        //modelNames.push_back("PD");
-        outputDT = boost::shared_ptr<OutputDT>(new OutputDT(outputDTFilename,model->getDims(),model->getNumAgents()-1,modelNames,true,false,outputDTSteps));
-      }
-    }
-
-    if (outputDTCSVQ) {
-      if (outputDT->hasCollectedSufficientData()) {
+  // of the last trial, for finalizing the DT output, which is always run serially
+  unsigned int randomSeed = 0;
+  if (numThreads > 1) {
+    // each trial's output is buffered and printed in order once it finishes
+    TrialQueue queue(numTrials);
+    boost::thread_group threads;
+    for (unsigned int i = 0; i < numThreads; i++)
+      threads.create_thread(boost::bind(&runTrialsWorker,boost::cref(options),boost::cref(settings),startTrial,randomizeSeedQ,boost::ref(queue),boost::ref(numSteps),boost::ref(numCaptures)));
+    threads.join_all();
+  } else {
+    for (int trial = 0; trial < numTrials; trial++) {
+      trialNum = trial + startTrial;
+      randomSeed = getRandomSeed(trialNum,randomizeSeedQ);
+      if (!runTrial(options,settings,trial,trialNum,randomSeed,numSteps[trial],numCaptures[trial],std::cout,outputDT,actions)) {
         std::cout << "WARNING: collected sufficient data, stopping with " << trial << " trials" << std::endl;
         numSteps.resize(trial);
         break;
       }
-    }
-    
-    
-    if (displayStepsPerTrialQ)
-      std::cout << "trial " << std::setw(2) << trialNum << ": " << std::flush;
-    
-    for (unsigned int episode = 0; episode < numEpisodes; episode++) {
-      world->randomizePositions();
-      world->restartAgents();
-      if (outputDTCSVQ) {
-        // for the first step, add the observation, since it keeps a history of 1
-        world->generateObservation(obs);
-        outputDT->saveStep(trial,numSteps[trial][episode],obs,*actions);
-      }
-      while (!model->isPreyCaptured()) {
-        numSteps[trial][episode]++;
-        // check end conditions
-        if (runForFixedLength) {
-          if (numSteps[trial][episode] > numStepsPerEpisode)
-            break;
-        } else {
-          if (numSteps[trial][episode] > maxNumStepsPerEpisode) {
-            std::cerr << "TRIAL " << trial << " EPISODE " << episode << " TOO LONG" << std::endl;
-            break;
-          }
-        }
-
-        if (displayObsQ) {
-          world->generateObservation(obs);
-          std::cout << obs << std::endl;
-        }
-        world->step(actions);
-        if (outputDTCSVQ){
-          world->generateObservation(obs);  // should follow world->step so that we can extract the observed actions of the previous step
-          outputDT->saveStep(trial,numSteps[trial][episode],obs,*actions);
-        }
-
-        // if we want to run for a fixed length and the prey is captured, find a new position for the prey
-        if (runForFixedLength && model->isPreyCaptured()) {
-          //std::cout << "Prey is captured, generating new position" << std::endl;
-          world->randomizePreyPosition();
-          numCaptures[trial][episode]++;
-        }
-      } // while the episode lasts
-
-      if (displayObsQ) {
-        world->generateObservation(obs);
-        std::cout << obs << std::endl;
-      }
-      if (displayStepsPerEpisodeQ)
-        std::cout << std::setw(3) << (*results)[trial][episode] << " " << std::flush;
-    }
-    if (displayStepsPerTrialQ)
-      displayStepsPerTrial(displayStepsPerEpisodeQ,(*results)[trial]);
-
-  } // end for trial
+    } // end for trial
+  }
   double endTime = getTime();
   // optionally display the summary
   if (displaySummaryQ)
@@ -219,12 +188,147 @@ int main(int argc, const char *argv[])
   if (saveResultsQ)
     saveResults(saveFilename,startTrial,*results);
   // optionally finialize the saving of data for the DT
-  if (outputDTCSVQ)
+  if (settings.outputDTCSVQ)
     outputDT->finalizeSave(randomSeed);
 
   return 0;
 }
 
+unsigned int getRandomSeed(unsigned int trialNum, bool randomizeSeedQ) {
+  if (randomizeSeedQ)
+    return getTime() * 1000000 + 1000 * getpid() + trialNum; // hopefully random enough
+  else
+    return trialNum;
+}
+
+bool runTrial(const Json::Value &options, const TrialSettings &settings, int trial, unsigned int trialNum, unsigned int randomSeed, std::vector<unsigned int> &numSteps, std::vector<unsigned int> &numCaptures, std::ostream &out, boost::shared_ptr<OutputDT> &outputDT, boost::shared_ptr<std::vector<Action::Type> > &actions) {
+  Observation obs;
+  std::vector<unsigned int> *results = &numSteps;
+  if (settings.runForFixedLength)
+    results = &numCaptures;
+  //std::cout << "RANDOM SEED: " << randomSeed << std::endl;
+
+  Json::Value trialOptions(options);
+  replaceOptsTrial(trialOptions,trialNum);
+
+  boost::shared_ptr<World> world = createWorldAgents(randomSeed,trialNum,trialOptions);
+  boost::shared_ptr<const WorldModel> model = world->getModel();
+  out << "Ad hoc agent ind: " << model->getAdhocInd() << std::endl;
+
+  // INITIALIZATION
+  if (trial == 0) {
+    if (settings.displayDescriptionQ)
+      out << world->generateDescription() << std::endl;
+    if (settings.outputDTCSVQ) {
+      // set up the actions
+      actions = boost::shared_ptr<std::vector<Action::Type> >(new std::vector<Action::Type>(model->getNumAgents()));
+      // create models for the DT csv output if required
+      std::vector<std::string> modelNames;
+      //modelNames.push_back("GR");
+      //modelNames.push_back("TA");
+      //modelNames.push_back("GP");
+      //modelNames.push_back("PD");
+      outputDT = boost::shared_ptr<OutputDT>(new OutputDT(settings.outputDTFilename,model->getDims(),model->getNumAgents()-1,modelNames,true,false,settings.outputDTSteps));
+    }
+  }
+
+  if (settings.outputDTCSVQ) {
+    if (outputDT->hasCollectedSufficientData())
+      return false;
+  }
+  
+  
+  if (settings.displayStepsPerTrialQ)
+    out << "trial " << std::setw(2) << trialNum << ": " << std::flush;
+  
+  for (unsigned int episode = 0; episode < settings.numEpisodes; episode++) {
+    world->randomizePositions();
+    world->restartAgents();
+    if (settings.outputDTCSVQ) {
+      // for the first step, add the observation, since it keeps a history of 1
+      world->generateObservation(obs);
+      outputDT->saveStep(trial,numSteps[episode],obs,*actions);
+    }
+    while (!model->isPreyCaptured()) {
+      numSteps[episode]++;
+      // check end conditions
+      if (settings.runForFixedLength) {
+        if (numSteps[episode] > settings.numStepsPerEpisode)
+          break;
+      } else {
+        if (numSteps[episode] > settings.maxNumStepsPerEpisode) {
+          std::cerr << "TRIAL " << trial << " EPISODE " << episode << " TOO LONG" << std::endl;
+          break;
+        }
+      }
+
+      if (settings.displayObsQ) {
+        world->generateObservation(obs);
+        out << obs << std::endl;
+      }
+      world->step(actions);
+      if (settings.outputDTCSVQ){
+        world->generateObservation(obs);  // should follow world->step so that we can extract the observed actions of the previous step
+        outputDT->saveStep(trial,numSteps[episode],obs,*actions);
+      }
+
+      // if we want to run for a fixed length and the prey is captured, find a new position for the prey
+      if (settings.runForFixedLength && model->isPreyCaptured()) {
+        //std::cout << "Prey is captured, generating new position" << std::endl;
+        world->randomizePreyPosition();
+        numCaptures[episode]++;
+      }
+    } // while the episode lasts
+
+    if (settings.displayObsQ) {
+      world->generateObservation(obs);
+      out << obs << std::endl;
+    }
+    if (settings.displayStepsPerEpisodeQ)
+      out << std::setw(3) << (*results)[episode] << " " << std::flush;
+  }
+  if (settings.displayStepsPerTrialQ)
+    displayStepsPerTrial(out,settings.displayStepsPerEpisodeQ,*results);
+  return true;
+}
+
+TrialQueue::TrialQueue(int numTrials):
+  numTrials(numTrials),
+  nextTrial(0),
+  nextOutput(0),
+  outputs(numTrials)
+{
+}
+
+void runTrialsWorker(const Json::Value &options, const TrialSettings &settings, int startTrial, bool randomizeSeedQ, TrialQueue &queue, std::vector<std::vector<unsigned int> > &numSteps, std::vector<std::vector<unsigned int> > &numCaptures) {
+  // the DT output is only used with a single thread
+  boost::shared_ptr<OutputDT> outputDT;
+  boost::shared_ptr<std::vector<Action::Type> > actions;
+  while (true) {
+    int trial;
+    {
+      boost::mutex::scoped_lock lock(queue.mutex);
+      if (queue.nextTrial >= queue.numTrials)
+        return;
+      trial = queue.nextTrial++;
+    }
+    unsigned int trialNum = trial + startTrial;
+    boost::shared_ptr<std::ostringstream> out(new std::ostringstream());
+    out->copyfmt(std::cout);
+    runTrial(options,settings,trial,trialNum,getRandomSeed(trialNum,randomizeSeedQ),numSteps[trial],numCaptures[trial],*out,outputDT,actions);
+
+    boost::mutex::scoped_lock lock(queue.mutex);
+    queue.outputs[trial] = out;
+    while ((queue.nextOutput < queue.numTrials) && (queue.outputs[queue.nextOutput].get() != NULL)) {
+      std::ostringstream &trialOut = *(queue.outputs[queue.nextOutput]);
+      std::cout << trialOut.str() << std::flush;
+      std::cout.copyfmt(trialOut); // keep the formatting as if the trial printed directly
+      queue.outputs[queue.nextOutput].reset();
+      queue.nextOutput++;
+    }
+  }
+}
+
 void displaySummary(double timePassed, const std::vector<std::vector<unsigned int> > &numSteps) {
   std::cout << "Avg Steps Per Episode: ";
   unsigned int numStepsPerEpisode;
@@ -238,14 +342,14 @@ void displaySummary(double timePassed, const std::vector<std::vector<unsigned in
   std::cout << "time: " << timePassed << std::endl;
 }
 
-void displayStepsPerTrial(bool displayStepsPerEpisodeQ, const std::vector<unsigned int> &numStepsPerTrial) {
+void displayStepsPerTrial(std::ostream &out, bool displayStepsPerEpisodeQ, const std::vector<unsigned int> &numStepsPerTrial) {
   unsigned int numEpisodes = numStepsPerTrial.size();
   unsigned int steps = 0;
   for (unsigned int episode = 0; episode < numEpisodes; episode++)
     steps += numStepsPerTrial[episode];
   if (displayStepsPerEpisodeQ)
-    std::cout << " = ";
-  std::cout << std::setprecision(3) << steps / ((float)numEpisodes) << std::endl;
+    out << " = ";
+  out << std::setprecision(3) << steps / ((float)numEpisodes) << std::endl;
 }
 
 void saveResults(const std::string &filename, int startTrial, const std::vector<std::vector<unsigned int> > &numSteps) {
@@ -0,0 +1,62 @@
+/*
+File: AliasTable.cpp
+Author: Samuel Barrett
+Description: samples from a discrete distribution in constant time with
+  Walker's alias method, built with Vose's pairing of small and large entries
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include "AliasTable.h"
+#include <cassert>
+
+AliasTable::AliasTable() {
+}
+
+void AliasTable::build(const std::vector<double> &probs) {
+  unsigned int n = probs.size();
+  double total = 0;
+  for (unsigned int i = 0; i < n; i++)
+    total += probs[i];
+  assert(total > 0);
+
+  keepProbs.resize(n);
+  aliases.resize(n);
+  scaledProbs.resize(n);
+  small.clear();
+  large.clear();
+  // scaled so the average entry is 1
+  for (unsigned int i = 0; i < n; i++) {
+    scaledProbs[i] = probs[i] * n / total;
+    aliases[i] = i;
+    if (scaledProbs[i] < 1.0)
+      small.push_back(i);
+    else
+      large.push_back(i);
+  }
+  // each small entry is topped up to 1 by a large one
+  while (!small.empty() && !large.empty()) {
+    unsigned int s = small.back();
+    unsigned int l = large.back();
+    small.pop_back();
+    keepProbs[s] = scaledProbs[s];
+    aliases[s] = l;
+    scaledProbs[l] -= 1.0 - scaledProbs[s];
+    if (scaledProbs[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // whatever's left is 1 up to rounding
+  for (unsigned int i = 0; i < large.size(); i++)
+    keepProbs[large[i]] = 1.0;
+  for (unsigned int i = 0; i < small.size(); i++)
+    keepProbs[small[i]] = 1.0;
+}
+
+unsigned int AliasTable::sample(RNG &rng) const {
+  unsigned int ind = rng.randomInt(keepProbs.size());
+  if (rng.randomFloat() < keepProbs[ind])
+    return ind;
+  return aliases[ind];
+}
@@ -0,0 +1,37 @@
+#ifndef ALIASTABLE_H4QZ7M2E
+#define ALIASTABLE_H4QZ7M2E
+
+/*
+File: AliasTable.h
+Author: Samuel Barrett
+Description: samples from a discrete distribution in constant time with
+  Walker's alias method. Each entry keeps some of its own probability and
+  hands the rest of its 1/n share to one alias, so a sample is a uniform
+  entry followed by a single biased coin flip. Building it takes O(n), so
+  it's for distributions that are sampled many times between changes.
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <vector>
+#include "RNG.h"
+
+class AliasTable {
+public:
+  AliasTable();
+
+  // probs needn't be normalized, but they can't all be 0
+  void build(const std::vector<double> &probs);
+  unsigned int sample(RNG &rng) const;
+  unsigned int size() const {return keepProbs.size();}
+
+private:
+  std::vector<double> keepProbs; // of sampling the entry itself rather than its alias
+  std::vector<unsigned int> aliases;
+  // scratch space for build
+  std::vector<double> scaledProbs;
+  std::vector<unsigned int> small;
+  std::vector<unsigned int> large;
+};
+
+#endif /* end of include guard: ALIASTABLE_H4QZ7M2E */
@@ -0,0 +1,114 @@
+#ifndef DEADLINE_H8QZ3VKE
+#define DEADLINE_H8QZ3VKE
+
+/*
+File: Deadline.h
+Author: Samuel Barrett
+Description: a planning deadline that doesn't read the clock on every step.
+  expired() is called once per unit of work and only reads the monotonic
+  clock every stepsPerCheck calls. After each read, stepsPerCheck is adapted
+  so that reads are about checkPeriod seconds apart, given the measured cost
+  of a step, without letting a single interval overshoot the time that's
+  left. Copies share the end time but count their steps separately, so each
+  thread should use its own copy.
+Created:  2013-08-15
+Modified: 2013-08-15
+*/
+
+#include <time.h>
+
+class Deadline {
+public:
+  Deadline(double checkPeriod = 0.0001, unsigned int maxStepsPerCheck = 4096):
+    checkPeriod(checkPeriod),
+    maxStepsPerCheck(maxStepsPerCheck),
+    active(false),
+    passed(false),
+    startTime(0),
+    endTime(0)
+  {
+    resetCounts(0);
+  }
+
+  // duration in seconds, if it's <= 0 the deadline never expires
+  void start(double duration) {
+    startTime = now();
+    active = (duration > 0);
+    passed = false;
+    endTime = startTime + duration;
+    resetCounts(startTime);
+  }
+
+  // counts one step, true once the deadline has passed
+  inline bool expired() {
+    if (passed)
+      return true;
+    if (!active)
+      return false;
+    if (++steps < stepsPerCheck)
+      return false;
+    return checkClock();
+  }
+
+  bool hasPassed() const {
+    return passed;
+  }
+
+  double elapsed() const {
+    return now() - startTime;
+  }
+
+  unsigned int getNumClockReads() const {
+    return numClockReads;
+  }
+
+  static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC,&ts);
+    return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+  }
+
+private:
+  void resetCounts(double time) {
+    steps = 0;
+    stepsPerCheck = 1;
+    lastCheckTime = time;
+    numClockReads = 0;
+  }
+
+  bool checkClock() {
+    double time = now();
+    numClockReads++;
+    if (time >= endTime) {
+      passed = true;
+      return true;
+    }
+    double stepCost = (time - lastCheckTime) / steps;
+    double target = checkPeriod;
+    // don't plan to run past the end before the next read
+    if (target > 0.5 * (endTime - time))
+      target = 0.5 * (endTime - time);
+    if (stepCost * maxStepsPerCheck <= target)
+      stepsPerCheck = maxStepsPerCheck;
+    else if (stepCost >= target)
+      stepsPerCheck = 1;
+    else
+      stepsPerCheck = (unsigned int)(target / stepCost);
+    steps = 0;
+    lastCheckTime = time;
+    return false;
+  }
+
+  double checkPeriod;
+  unsigned int maxStepsPerCheck;
+  bool active;
+  bool passed;
+  double startTime;
+  double endTime;
+  double lastCheckTime;
+  unsigned int steps;
+  unsigned int stepsPerCheck;
+  unsigned int numClockReads;
+};
+
+#endif /* end of include guard: DEADLINE_H8QZ3VKE */
@@ -0,0 +1,130 @@
+#ifndef DENSEMAP_R4M8XH2C
+#define DENSEMAP_R4M8XH2C
+
+/*
+File: DenseMap.h
+Author: Samuel Barrett
+Description: a map for keys that are small non-negative integers or enums
+  (less than N <= 32), stored inline as an array with a bitmask of the
+  present keys. It mirrors the parts of the std::map interface that the
+  planners use and iterates in key order.
+Created:  2013-08-13
+Modified: 2013-08-19
+*/
+
+#include <cassert>
+#include <utility>
+#include <boost/cstdint.hpp>
+#include <boost/static_assert.hpp>
+
+template <class Key, class T, unsigned int N>
+class DenseMap {
+  BOOST_STATIC_ASSERT(N <= 32);
+public:
+  typedef std::pair<Key,T> value_type;
+
+  class iterator {
+  public:
+    iterator():
+      map(NULL),
+      ind(N)
+    {}
+    value_type& operator*() const { return map->entries[ind]; }
+    value_type* operator->() const { return &(map->entries[ind]); }
+    iterator& operator++() {
+      ind++;
+      skipToPresent();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator it(*this);
+      ++(*this);
+      return it;
+    }
+    bool operator==(const iterator &other) const { return ind == other.ind; }
+    bool operator!=(const iterator &other) const { return ind != other.ind; }
+
+  private:
+    iterator(DenseMap<Key,T,N> *map, unsigned int ind):
+      map(map),
+      ind(ind)
+    {}
+    void skipToPresent() {
+      while ((ind < N) && !map->isPresent(ind))
+        ind++;
+    }
+    DenseMap<Key,T,N> *map;
+    unsigned int ind;
+    friend class DenseMap<Key,T,N>;
+  };
+
+  DenseMap():
+    present(0)
+  {}
+
+  iterator begin() {
+    iterator it(this,0);
+    it.skipToPresent();
+    return it;
+  }
+
+  iterator end() {
+    return iterator(this,N);
+  }
+
+  iterator find(const Key &key) {
+    unsigned int ind = (unsigned int)key;
+    if ((ind < N) && isPresent(ind))
+      return iterator(this,ind);
+    return end();
+  }
+
+  std::pair<iterator,bool> insert(const value_type &val) {
+    unsigned int ind = (unsigned int)val.first;
+    assert(ind < N);
+    if (isPresent(ind))
+      return std::make_pair(iterator(this,ind),false);
+    entries[ind] = val;
+    present |= (1u << ind);
+    return std::make_pair(iterator(this,ind),true);
+  }
+
+  T& operator[](const Key &key) {
+    return insert(value_type(key,T())).first->second;
+  }
+
+  void erase(iterator position) {
+    assert(position.ind < N);
+    present &= ~(1u << position.ind);
+  }
+
+  size_t erase(const Key &key) {
+    unsigned int ind = (unsigned int)key;
+    if ((ind >= N) || !isPresent(ind))
+      return 0;
+    present &= ~(1u << ind);
+    return 1;
+  }
+
+  void clear() {
+    present = 0;
+  }
+
+  size_t size() const {
+    return __builtin_popcount(present);
+  }
+
+  bool empty() const {
+    return present == 0;
+  }
+
+private:
+  bool isPresent(unsigned int ind) const {
+    return (present >> ind) & 1;
+  }
+
+  uint32_t present;
+  value_type entries[N];
+};
+
+#endif /* end of include guard: DENSEMAP_R4M8XH2C */
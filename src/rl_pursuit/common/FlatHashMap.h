@@ -0,0 +1,225 @@
+#ifndef FLATHASHMAP_K7T2WQ9D
+#define FLATHASHMAP_K7T2WQ9D
+
+/*
+File: FlatHashMap.h
+Author: Samuel Barrett
+Description: an open addressing hash map for integral keys, with the values
+  stored inline in the buckets so a lookup normally touches a single bucket.
+  It mirrors the parts of the std::map interface that the planners use, but
+  inserting may move every value, so pointers into the map only stay valid
+  until the next insert that changes numRehashes(). Erasing leaves a
+  tombstone, so erase(it++) is fine while iterating.
+Created:  2013-08-13
+Modified: 2013-08-13
+*/
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <boost/cstdint.hpp>
+
+template <class Key, class T>
+class FlatHashMap {
+public:
+  typedef std::pair<Key,T> value_type;
+
+private:
+  enum BucketStatus {
+    EMPTY,
+    FULL,
+    DELETED
+  };
+
+  struct Bucket {
+    Bucket():
+      status(EMPTY),
+      entry(Key(),T())
+    {}
+    unsigned char status;
+    value_type entry;
+  };
+
+public:
+  class iterator {
+  public:
+    iterator():
+      buckets(NULL),
+      ind(0),
+      numBuckets(0)
+    {}
+    value_type& operator*() const { return buckets[ind].entry; }
+    value_type* operator->() const { return &(buckets[ind].entry); }
+    iterator& operator++() {
+      ind++;
+      skipToFull();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator it(*this);
+      ++(*this);
+      return it;
+    }
+    bool operator==(const iterator &other) const { return ind == other.ind; }
+    bool operator!=(const iterator &other) const { return ind != other.ind; }
+
+  private:
+    iterator(Bucket *buckets, unsigned int ind, unsigned int numBuckets):
+      buckets(buckets),
+      ind(ind),
+      numBuckets(numBuckets)
+    {}
+    void skipToFull() {
+      while ((ind < numBuckets) && (buckets[ind].status != FULL))
+        ind++;
+    }
+    Bucket *buckets;
+    unsigned int ind;
+    unsigned int numBuckets;
+    friend class FlatHashMap<Key,T>;
+  };
+
+  FlatHashMap(unsigned int initialBuckets = 1024):
+    buckets(roundUpToPowerOf2(initialBuckets)),
+    numFull(0),
+    numDeleted(0),
+    rehashCount(0)
+  {}
+
+  iterator begin() {
+    iterator it(bucketPtr(),0,buckets.size());
+    it.skipToFull();
+    return it;
+  }
+
+  iterator end() {
+    return iterator(bucketPtr(),buckets.size(),buckets.size());
+  }
+
+  iterator find(const Key &key) {
+    unsigned int mask = buckets.size() - 1;
+    for (unsigned int ind = hash(key) & mask; ; ind = (ind + 1) & mask) {
+      Bucket &bucket = buckets[ind];
+      if (bucket.status == EMPTY)
+        return end();
+      if ((bucket.status == FULL) && (bucket.entry.first == key))
+        return iterator(bucketPtr(),ind,buckets.size());
+    }
+  }
+
+  std::pair<iterator,bool> insert(const value_type &val) {
+    if (4 * (numFull + numDeleted + 1) > 3 * buckets.size())
+      rehash();
+    unsigned int mask = buckets.size() - 1;
+    int firstDeleted = -1;
+    unsigned int ind;
+    for (ind = hash(val.first) & mask; buckets[ind].status != EMPTY; ind = (ind + 1) & mask) {
+      Bucket &bucket = buckets[ind];
+      if (bucket.status == DELETED) {
+        if (firstDeleted < 0)
+          firstDeleted = ind;
+      } else if (bucket.entry.first == val.first)
+        return std::make_pair(iterator(bucketPtr(),ind,buckets.size()),false);
+    }
+    if (firstDeleted >= 0) {
+      ind = firstDeleted;
+      numDeleted--;
+    }
+    buckets[ind].status = FULL;
+    buckets[ind].entry = val;
+    numFull++;
+    return std::make_pair(iterator(bucketPtr(),ind,buckets.size()),true);
+  }
+
+  T& operator[](const Key &key) {
+    return insert(value_type(key,T())).first->second;
+  }
+
+  void erase(iterator position) {
+    Bucket &bucket = buckets[position.ind];
+    bucket.status = DELETED;
+    bucket.entry.second = T(); // release anything the value holds
+    numFull--;
+    numDeleted++;
+  }
+
+  size_t erase(const Key &key) {
+    iterator it = find(key);
+    if (it == end())
+      return 0;
+    erase(it);
+    return 1;
+  }
+
+  void clear() {
+    for (unsigned int i = 0; i < buckets.size(); i++) {
+      if (buckets[i].status == FULL)
+        buckets[i].entry.second = T();
+      buckets[i].status = EMPTY;
+    }
+    numFull = 0;
+    numDeleted = 0;
+  }
+
+  size_t size() const {
+    return numFull;
+  }
+
+  bool empty() const {
+    return numFull == 0;
+  }
+
+  unsigned int bucket_count() const {
+    return buckets.size();
+  }
+
+  unsigned int numRehashes() const {
+    return rehashCount;
+  }
+
+private:
+  static unsigned int roundUpToPowerOf2(unsigned int n) {
+    unsigned int res = 16;
+    while (res < n)
+      res *= 2;
+    return res;
+  }
+
+  static unsigned int hash(const Key &key) {
+    // fibonacci hashing, the states pack positions into the low bits
+    return (unsigned int)(((uint64_t)key * 0x9E3779B97F4A7C15ULL) >> 32);
+  }
+
+  Bucket* bucketPtr() {
+    return &(buckets[0]);
+  }
+
+  void rehash() {
+    // grow if the table is actually full, otherwise just drop the tombstones
+    unsigned int numBuckets = buckets.size();
+    if (4 * (numFull + 1) > numBuckets)
+      numBuckets *= 2;
+    std::vector<Bucket> old(numBuckets);
+    old.swap(buckets);
+    unsigned int mask = buckets.size() - 1;
+    for (unsigned int i = 0; i < old.size(); i++) {
+      if (old[i].status != FULL)
+        continue;
+      unsigned int ind = hash(old[i].entry.first) & mask;
+      while (buckets[ind].status != EMPTY)
+        ind = (ind + 1) & mask;
+      buckets[ind].status = FULL;
+      buckets[ind].entry.first = old[i].entry.first;
+      std::swap(buckets[ind].entry.second,old[i].entry.second);
+    }
+    numDeleted = 0;
+    rehashCount++;
+  }
+
+  std::vector<Bucket> buckets;
+  unsigned int numFull;
+  unsigned int numDeleted;
+  unsigned int rehashCount;
+};
+
+#endif /* end of include guard: FLATHASHMAP_K7T2WQ9D */
@@ -0,0 +1,113 @@
+#ifndef GENERATIONALARENA_W2F9LQ6B
+#define GENERATIONALARENA_W2F9LQ6B
+
+/*
+File: GenerationalArena.h
+Author: Samuel Barrett
+Description: an arena that hands out objects in chunks tagged with the
+  generation they were allocated in. Old generations are released in bulk by
+  handing their chunks back to a free list, without touching the objects, so
+  the cost is per chunk rather than per object. Released objects are
+  overwritten by assignment when their slot is reused. Pointers stay valid
+  until their generation is released.
+Created:  2013-08-14
+Modified: 2013-08-14
+*/
+
+#include <deque>
+#include <vector>
+#include <boost/shared_array.hpp>
+
+template <class T>
+class GenerationalArena {
+public:
+  GenerationalArena(unsigned int chunkSize = 512):
+    chunkSize(chunkSize),
+    numAllocated(0)
+  {
+    generations.push_back(Generation(0));
+  }
+
+  // copies val into the current generation
+  T* allocate(const T &val) {
+    Generation &gen = generations.back();
+    if ((gen.chunks.size() == 0) || (gen.used == chunkSize)) {
+      gen.chunks.push_back(getChunk());
+      gen.used = 0;
+    }
+    T *ptr = &(chunks[gen.chunks.back()][gen.used]);
+    *ptr = val;
+    gen.used++;
+    numAllocated++;
+    return ptr;
+  }
+
+  unsigned int generation() const {
+    return generations.back().id;
+  }
+
+  bool isLive(unsigned int id) const {
+    return (id >= generations.front().id) && (id <= generations.back().id);
+  }
+
+  void startGeneration() {
+    generations.push_back(Generation(generation() + 1));
+  }
+
+  // releases all generations before id, the current one is always kept
+  void releaseBefore(unsigned int id) {
+    while ((generations.size() > 1) && (generations.front().id < id)) {
+      releaseChunks(generations.front());
+      generations.pop_front();
+    }
+  }
+
+  // releases everything, but keeps counting generations from the current one
+  void clear() {
+    unsigned int id = generation() + 1;
+    for (unsigned int i = 0; i < generations.size(); i++)
+      releaseChunks(generations[i]);
+    generations.clear();
+    generations.push_back(Generation(id));
+  }
+
+  // number of objects in the live generations
+  size_t size() const {
+    return numAllocated;
+  }
+
+private:
+  struct Generation {
+    Generation(unsigned int id):
+      id(id),
+      used(0)
+    {}
+    unsigned int id;
+    std::vector<unsigned int> chunks;
+    unsigned int used; // slots used in the last chunk
+  };
+
+  unsigned int getChunk() {
+    if (freeChunks.size() > 0) {
+      unsigned int ind = freeChunks.back();
+      freeChunks.pop_back();
+      return ind;
+    }
+    chunks.push_back(boost::shared_array<T>(new T[chunkSize]));
+    return chunks.size() - 1;
+  }
+
+  void releaseChunks(Generation &gen) {
+    freeChunks.insert(freeChunks.end(),gen.chunks.begin(),gen.chunks.end());
+    if (gen.chunks.size() > 0)
+      numAllocated -= (gen.chunks.size() - 1) * chunkSize + gen.used;
+  }
+
+  unsigned int chunkSize;
+  std::deque<Generation> generations;
+  std::vector<boost::shared_array<T> > chunks;
+  std::vector<unsigned int> freeChunks;
+  size_t numAllocated;
+};
+
+#endif /* end of include guard: GENERATIONALARENA_W2F9LQ6B */
@@ -0,0 +1,150 @@
+/*
+File: RNG.cpp
+Author: Samuel Barrett
+Description: jumping ahead in the tinymt32 streams. The state transition is
+  linear over GF(2), so n steps can be taken by evaluating x^n modulo its
+  characteristic polynomial at the transition. The polynomial is found once
+  from the generator itself with Berlekamp-Massey.
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include "RNG.h"
+#include <cassert>
+
+struct RNG::JumpTables {
+  JumpTables();
+
+  Poly charPoly; // degree 127
+  Poly xInverse; // x^-1 mod charPoly
+  Poly jumpPoly; // x^(2^64) mod charPoly
+};
+
+RNG::JumpTables::JumpTables() {
+  // the low bit of status[3] is a linear function of the state, so its
+  // sequence satisfies the characteristic polynomial of the transition
+  const unsigned int numBits = 4 * TINYMT32_MEXP;
+  RNG rng(1);
+  std::vector<unsigned char> seq(numBits);
+  for (unsigned int i = 0; i < numBits; i++) {
+    tinymt32::tinymt32_next_state(&rng.internal);
+    seq[i] = rng.internal.status[3] & 1;
+  }
+
+  // Berlekamp-Massey, c is the connection polynomial
+  std::vector<unsigned char> c(numBits + 1,0);
+  std::vector<unsigned char> b(numBits + 1,0);
+  std::vector<unsigned char> temp;
+  c[0] = b[0] = 1;
+  int len = 0;
+  int m = -1;
+  for (int n = 0; n < (int)numBits; n++) {
+    unsigned char d = seq[n];
+    for (int i = 1; i <= len; i++)
+      d ^= c[i] & seq[n - i];
+    if (d == 0)
+      continue;
+    temp = c;
+    for (int i = 0; i + n - m <= (int)numBits; i++)
+      c[i + n - m] ^= b[i];
+    if (2 * len <= n) {
+      len = n + 1 - len;
+      m = n;
+      b = temp;
+    }
+  }
+  assert(len == TINYMT32_MEXP);
+
+  // the characteristic polynomial is the reverse of the connection polynomial
+  for (int i = 0; i <= len; i++) {
+    if (!c[i])
+      continue;
+    unsigned int bit = len - i;
+    if (bit < 64)
+      charPoly.lo |= (uint64_t)1 << bit;
+    else
+      charPoly.hi |= (uint64_t)1 << (bit - 64);
+  }
+  assert(charPoly.getBit(0)); // so x is invertible
+  // x * (charPoly - 1) / x = 1 mod charPoly
+  xInverse = Poly((charPoly.lo >> 1) | (charPoly.hi << 63),charPoly.hi >> 1);
+  jumpPoly = Poly(2);
+  for (unsigned int i = 0; i < 64; i++)
+    jumpPoly = mulMod(jumpPoly,jumpPoly,charPoly);
+}
+
+const RNG::JumpTables& RNG::getJumpTables() {
+  static const JumpTables tables;
+  return tables;
+}
+
+RNG::Poly RNG::mulMod(const Poly &a, const Poly &b, const Poly &mod) {
+  Poly res;
+  for (int i = TINYMT32_MEXP - 1; i >= 0; i--) {
+    // res *= x
+    res.hi = (res.hi << 1) | (res.lo >> 63);
+    res.lo <<= 1;
+    if (res.getBit(TINYMT32_MEXP)) {
+      res.lo ^= mod.lo;
+      res.hi ^= mod.hi;
+    }
+    if (a.getBit(i)) {
+      res.lo ^= b.lo;
+      res.hi ^= b.hi;
+    }
+  }
+  return res;
+}
+
+RNG::Poly RNG::powMod(const Poly &base, uint64_t exponent, const Poly &mod) {
+  Poly res(1);
+  for (int i = 63; i >= 0; i--) {
+    res = mulMod(res,res,mod);
+    if ((exponent >> i) & 1)
+      res = mulMod(res,base,mod);
+  }
+  return res;
+}
+
+void RNG::advance(const Poly &xPowN) {
+  const JumpTables &tables = getJumpTables();
+  // the top bit of status[0] isn't part of the 127 bit state, so evaluate
+  // x^(n-1) on the state and take the last step normally, which drops it
+  Poly poly = mulMod(xPowN,tables.xInverse,tables.charPoly);
+  tinymt32::tinymt32_t res = internal;
+  for (unsigned int k = 0; k < 4; k++)
+    res.status[k] = 0;
+  for (int i = TINYMT32_MEXP - 1; i >= 0; i--) {
+    tinymt32::tinymt32_next_state(&res);
+    if (poly.getBit(i)) {
+      for (unsigned int k = 0; k < 4; k++)
+        res.status[k] ^= internal.status[k];
+    }
+  }
+  internal = res;
+  tinymt32::tinymt32_next_state(&internal);
+}
+
+void RNG::jump() {
+  advance(getJumpTables().jumpPoly);
+}
+
+void RNG::discard(uint64_t n) {
+  if (n == 0)
+    return;
+  const JumpTables &tables = getJumpTables();
+  advance(powMod(Poly(2),n,tables.charPoly));
+}
+
+RNG RNG::split() {
+  RNG child(*this);
+  jump();
+  return child;
+}
+
+RNG RNG::getStream(uint32_t streamInd) const {
+  const JumpTables &tables = getJumpTables();
+  RNG stream(*this);
+  stream.advance(powMod(tables.jumpPoly,(uint64_t)streamInd + 1,tables.charPoly));
+  return stream;
+}
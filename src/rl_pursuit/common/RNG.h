@@ -4,12 +4,15 @@
 /*
 File: RNG.h
 Author: Samuel Barrett
-Description: a random number generator based on tinymt32
+Description: a random number generator based on tinymt32. Streams can be
+  split for threads, trials, or rollouts by jumping ahead, which gives
+  streams that don't overlap and only depend on where the parent was.
 Created:  2011-08-23
-Modified: 2011-08-23
+Modified: 2013-08-19
 */
 
 #include "tinymt32.h"
+#include <algorithm>
 #include <cstdlib>
 #include <vector>
 
@@ -29,29 +32,82 @@ public:
     return tinymt32::tinymt32_generate_uint32(&internal);
   }
 
+  // modulo, so slightly biased for large max, but kept for reproducibility
   int32_t randomInt(int32_t max) {
     return tinymt32::tinymt32_generate_uint32(&internal) % max;
   }
 
   int32_t randomInt(int32_t min,int32_t max) {
     uint32_t temp = tinymt32::tinymt32_generate_uint32(&internal);
-    int32_t val = temp % (max - min) - min;
+    int32_t val = temp % (max - min) + min;
     return val;
   }
+
+  // bulk versions, giving the same values as calling the ones above n times
+  void randomUInts(uint32_t *vals, unsigned int n) {
+    for (unsigned int i = 0; i < n; i++)
+      vals[i] = tinymt32::tinymt32_generate_uint32(&internal);
+  }
+
+  void randomFloats(float *vals, unsigned int n) {
+    for (unsigned int i = 0; i < n; i++)
+      vals[i] = tinymt32::tinymt32_generate_float(&internal);
+  }
+
+  void randomInts(int32_t *vals, unsigned int n, int32_t max) {
+    for (unsigned int i = 0; i < n; i++)
+      vals[i] = tinymt32::tinymt32_generate_uint32(&internal) % max;
+  }
   
   void randomOrdering(std::vector<uint32_t> &inds) {
+    uint32_t vals[ORDERING_BATCH];
     uint32_t j;
     uint32_t temp;
     for (uint32_t i = 0; i < inds.size(); i++)
       inds[i] = i;
-    for (int i = (int)inds.size()-1; i >= 0; i--) {
-      j = randomInt(i+1);
-      temp = inds[i];
-      inds[i] = inds[j];
-      inds[j] = temp;
+    int i = (int)inds.size()-1;
+    while (i >= 0) {
+      unsigned int n = std::min(i + 1,(int)ORDERING_BATCH);
+      randomUInts(vals,n);
+      for (unsigned int k = 0; k < n; k++, i--) {
+        j = vals[k] % (i+1);
+        temp = inds[i];
+        inds[i] = inds[j];
+        inds[j] = temp;
+      }
     }
   }
 
+  // skips ahead 2^64 draws
+  void jump();
+  // skips ahead n draws, the same as drawing n values but takes O(log n)
+  void discard(uint64_t n);
+  // returns a stream starting at the current state, and jumps this one past
+  // the 2^64 draws given to it, so they never overlap
+  RNG split();
+  // the stream starting (streamInd + 1) jumps ahead of the current state,
+  // without changing this one. Different indices never overlap, so these can
+  // be handed out per thread, trial, or rollout
+  RNG getStream(uint32_t streamInd) const;
+
+private:
+  // a polynomial over GF(2) with degree below 128, bit i is the coefficient of x^i
+  struct Poly {
+    Poly(uint64_t lo = 0, uint64_t hi = 0): lo(lo), hi(hi) {}
+    bool getBit(unsigned int i) const {
+      return ((i < 64 ? lo >> i : hi >> (i - 64)) & 1) != 0;
+    }
+    uint64_t lo;
+    uint64_t hi;
+  };
+  struct JumpTables;
+
+  static const unsigned int ORDERING_BATCH = 16;
+  static const JumpTables& getJumpTables();
+  static Poly mulMod(const Poly &a, const Poly &b, const Poly &mod);
+  static Poly powMod(const Poly &base, uint64_t exponent, const Poly &mod);
+  void advance(const Poly &xPowN); // by n draws, given x^n mod the characteristic polynomial
+
 private:
   tinymt32::tinymt32_t internal;
 };
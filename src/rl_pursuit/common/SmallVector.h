@@ -0,0 +1,106 @@
+#ifndef SMALLVECTOR_Q5N7TJ2D
+#define SMALLVECTOR_Q5N7TJ2D
+
+/*
+File: SmallVector.h
+Author: Samuel Barrett
+Description: a contiguous vector that keeps up to N elements inline and
+  only allocates once it grows past that. T must be default constructible
+  and assignable, since the inline slots always exist.
+Created:  2013-08-15
+Modified: 2013-08-17
+*/
+
+#include <cstddef>
+
+template <class T, unsigned int N>
+class SmallVector {
+public:
+  typedef T* iterator;
+  typedef const T* const_iterator;
+
+  SmallVector():
+    data(inlineData),
+    numElements(0),
+    capacity(N)
+  {}
+
+  explicit SmallVector(unsigned int size):
+    data(inlineData),
+    numElements(0),
+    capacity(N)
+  {
+    resize(size);
+  }
+
+  SmallVector(const SmallVector<T,N> &other):
+    data(inlineData),
+    numElements(0),
+    capacity(N)
+  {
+    *this = other;
+  }
+
+  ~SmallVector() {
+    if (data != inlineData)
+      delete[] data;
+  }
+
+  SmallVector<T,N>& operator=(const SmallVector<T,N> &other) {
+    if (this == &other)
+      return *this;
+    numElements = 0;
+    reserve(other.numElements);
+    for (unsigned int i = 0; i < other.numElements; i++)
+      data[i] = other.data[i];
+    numElements = other.numElements;
+    return *this;
+  }
+
+  void push_back(const T &val) {
+    if (numElements == capacity)
+      reserve(2 * capacity);
+    data[numElements++] = val;
+  }
+
+  void reserve(unsigned int newCapacity) {
+    if (newCapacity <= capacity)
+      return;
+    T *newData = new T[newCapacity];
+    for (unsigned int i = 0; i < numElements; i++)
+      newData[i] = data[i];
+    if (data != inlineData)
+      delete[] data;
+    data = newData;
+    capacity = newCapacity;
+  }
+
+  // new elements are default values
+  void resize(unsigned int size) {
+    reserve(size);
+    for (unsigned int i = numElements; i < size; i++)
+      data[i] = T();
+    numElements = size;
+  }
+
+  // keeps any allocated memory
+  void clear() {
+    numElements = 0;
+  }
+
+  size_t size() const { return numElements; }
+  T& operator[](unsigned int ind) { return data[ind]; }
+  const T& operator[](unsigned int ind) const { return data[ind]; }
+  iterator begin() { return data; }
+  iterator end() { return data + numElements; }
+  const_iterator begin() const { return data; }
+  const_iterator end() const { return data + numElements; }
+
+private:
+  T *data;
+  unsigned int numElements;
+  unsigned int capacity;
+  T inlineData[N];
+};
+
+#endif /* end of include guard: SMALLVECTOR_Q5N7TJ2D */
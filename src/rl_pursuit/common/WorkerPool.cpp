@@ -0,0 +1,75 @@
+/*
+File: WorkerPool.cpp
+Author: Samuel Barrett
+Description: threads that stay alive between calls to run
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include "WorkerPool.h"
+#include <algorithm>
+#include <boost/bind.hpp>
+
+WorkerPool::WorkerPool(unsigned int numThreads):
+  numThreads(std::max(numThreads,1u)),
+  task(NULL),
+  numTasks(0),
+  nextTask(0),
+  numUnfinished(0),
+  stopping(false)
+{
+  // the caller of run is the first thread
+  for (unsigned int i = 1; i < this->numThreads; i++)
+    threads.create_thread(boost::bind(&WorkerPool::workerLoop,this));
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    boost::lock_guard<boost::mutex> lock(mutex);
+    stopping = true;
+  }
+  tasksAvailable.notify_all();
+  threads.join_all();
+}
+
+void WorkerPool::run(unsigned int numTasks, const Task &task) {
+  if ((numThreads == 1) || (numTasks <= 1)) {
+    for (unsigned int i = 0; i < numTasks; i++)
+      task(i);
+    return;
+  }
+  boost::unique_lock<boost::mutex> lock(mutex);
+  this->task = &task;
+  this->numTasks = numTasks;
+  nextTask = 0;
+  numUnfinished = numTasks;
+  tasksAvailable.notify_all();
+  runTasks(lock);
+  while (numUnfinished > 0)
+    tasksFinished.wait(lock);
+  this->task = NULL;
+}
+
+void WorkerPool::workerLoop() {
+  boost::unique_lock<boost::mutex> lock(mutex);
+  while (true) {
+    while (!stopping && ((task == NULL) || (nextTask >= numTasks)))
+      tasksAvailable.wait(lock);
+    if (stopping)
+      return;
+    runTasks(lock);
+  }
+}
+
+void WorkerPool::runTasks(boost::unique_lock<boost::mutex> &lock) {
+  while (nextTask < numTasks) {
+    unsigned int ind = nextTask++;
+    const Task &current = *task;
+    lock.unlock();
+    current(ind);
+    lock.lock();
+    numUnfinished--;
+    if (numUnfinished == 0)
+      tasksFinished.notify_all();
+  }
+}
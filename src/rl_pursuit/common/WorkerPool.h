@@ -0,0 +1,48 @@
+#ifndef WORKERPOOL_P3N8VX2Q
+#define WORKERPOOL_P3N8VX2Q
+
+/*
+File: WorkerPool.h
+Author: Samuel Barrett
+Description: threads that stay alive between calls to run, for spreading
+  short loops with independent iterations over the cores without starting
+  threads each time. The calling thread takes tasks too, so a pool of n
+  threads starts n - 1 of them. Which thread runs a task isn't fixed, so
+  tasks should write their results to their own slots and have the caller
+  combine them in order afterwards.
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+
+class WorkerPool {
+public:
+  typedef boost::function<void (unsigned int)> Task;
+
+  WorkerPool(unsigned int numThreads);
+  ~WorkerPool();
+
+  // calls task(i) for every i < numTasks and returns when they've all finished
+  void run(unsigned int numTasks, const Task &task);
+  unsigned int getNumThreads() const {return numThreads;}
+
+private:
+  void workerLoop();
+  void runTasks(boost::unique_lock<boost::mutex> &lock); // until none are left
+
+private:
+  const unsigned int numThreads;
+  boost::thread_group threads;
+  boost::mutex mutex;
+  boost::condition_variable tasksAvailable;
+  boost::condition_variable tasksFinished;
+  const Task *task; // NULL between runs
+  unsigned int numTasks;
+  unsigned int nextTask;
+  unsigned int numUnfinished;
+  bool stopping;
+};
+
+#endif /* end of include guard: WORKERPOOL_P3N8VX2Q */
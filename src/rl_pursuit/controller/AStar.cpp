@@ -40,7 +40,8 @@ bool AStar::Nodeequal::operator() (const boost::shared_ptr<Node> &node1, const b
 }
   
 AStar::AStar(const Point2D &dims):
-  dims(dims)
+  dims(dims),
+  geometry(Geometry::get(dims))
 {
 }
 
@@ -48,7 +49,7 @@ AStar::~AStar() {
   clear();
 }
 
-void AStar::plan(const Point2D &start, const Point2D &goal, const std::vector<Point2D> &obstacles) {
+void AStar::plan(const Point2D &start, const Point2D &goal, const PositionList &obstacles) {
   // set the goal, and clear the previous plan
   this->goal = goal;
   clear();
@@ -86,7 +87,7 @@ void AStar::plan(const Point2D &start, const Point2D &goal, const std::vector<Po
     closedNodes.insert(node); // add the node to the closed set
     // search its neighbors
     for (unsigned int i = 0; i < Action::NUM_NEIGHBORS; i++) {
-      pos = movePosition(dims,node->pos,(Action::Type)i);
+      pos = geometry->movePosition(node->pos,(Action::Type)i);
       newNode = boost::shared_ptr<Node>(new Node(node->gcost + 1,0,pos,node));
       if (closedNodes.count(newNode) > 0) {
         continue;
@@ -126,7 +127,7 @@ bool AStar::foundPath() {
 }
 
 void AStar::setHeuristic(boost::shared_ptr<Node>node) {
-  node->hcost = getDistanceToPoint(dims,node->pos,goal);
+  node->hcost = geometry->getDistanceToPoint(node->pos,goal);
 }
 
 void AStar::clear() {
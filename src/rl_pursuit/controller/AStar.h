@@ -13,6 +13,8 @@ Modified: 2011-09-09
 #include <boost/unordered_set.hpp>
 #include <boost/shared_ptr.hpp>
 #include <rl_pursuit/common/Point2D.h>
+#include <rl_pursuit/model/Common.h>
+#include <rl_pursuit/model/Geometry.h>
 
 class AStar {
 public:
@@ -37,12 +39,13 @@ public:
 public:
   AStar(const Point2D &dims);
   ~AStar();
-  void plan(const Point2D &start, const Point2D &goal, const std::vector<Point2D> &obstacles);
+  void plan(const Point2D &start, const Point2D &goal, const PositionList &obstacles);
   Point2D getFirstStep();
   bool foundPath();
 
 private:
   const Point2D dims;
+  boost::shared_ptr<const Geometry> geometry;
   std::vector<boost::shared_ptr<Node> > openHeap;
   boost::unordered_set<boost::shared_ptr<Node>, Nodehash, Nodeequal> openNodes;
   boost::unordered_set<boost::shared_ptr<Node>, Nodehash, Nodeequal> closedNodes;
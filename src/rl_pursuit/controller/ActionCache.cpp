@@ -0,0 +1,184 @@
+/*
+File: ActionCache.cpp
+Author: Samuel Barrett
+Description: a bounded cache of the action distributions that agents return
+  for an observation, shared by a world and its clones
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include "ActionCache.h"
+#include <cassert>
+
+const unsigned int ActionCache::NONE = (unsigned int)-1;
+
+static inline uint64_t combine(uint64_t seed, uint64_t val) {
+  return seed ^ (val + 0x9E3779B97F4A7C15ULL + (seed << 6) + (seed >> 2));
+}
+
+static inline uint64_t pack(const Point2D &pos) {
+  return ((uint64_t)(uint32_t)pos.x << 32) | (uint32_t)pos.y;
+}
+
+ActionCache::Stats::Stats():
+  hits(0),
+  misses(0),
+  evictions(0),
+  invalidations(0)
+{
+}
+
+double ActionCache::Stats::getHitRate() const {
+  if (hits + misses == 0)
+    return 0;
+  return hits / (double)(hits + misses);
+}
+
+ActionCache::ActionCache(unsigned int capacity):
+  capacity(capacity),
+  index(2 * capacity),
+  head(NONE),
+  tail(NONE)
+{
+  assert(capacity > 0);
+  entries.reserve(capacity);
+}
+
+bool ActionCache::get(const Observation &obs, ActionProbs &actionProbs) {
+  uint64_t key = getKey(obs);
+  boost::mutex::scoped_lock lock(mutex);
+  FlatHashMap<uint64_t,unsigned int>::iterator it = index.find(key);
+  if (it == index.end()) {
+    stats.misses++;
+    return false;
+  }
+  unsigned int ind = it->second;
+  const Entry &entry = entries[ind];
+  if ((entry.generation != getGeneration(obs.myInd)) || !matches(entry,obs)) {
+    stats.misses++;
+    return false;
+  }
+  actionProbs = entry.actionProbs;
+  unlink(ind);
+  pushFront(ind);
+  stats.hits++;
+  return true;
+}
+
+void ActionCache::put(const Observation &obs, const ActionProbs &actionProbs) {
+  uint64_t key = getKey(obs);
+  boost::mutex::scoped_lock lock(mutex);
+  unsigned int ind;
+  FlatHashMap<uint64_t,unsigned int>::iterator it = index.find(key);
+  if (it != index.end()) {
+    // replaces a stale entry or a different observation with the same key
+    ind = it->second;
+    unlink(ind);
+  } else if (entries.size() < capacity) {
+    ind = entries.size();
+    entries.push_back(Entry());
+    index[key] = ind;
+  } else {
+    ind = tail;
+    unlink(ind);
+    index.erase(entries[ind].key);
+    index[key] = ind;
+    stats.evictions++;
+  }
+
+  Entry &entry = entries[ind];
+  entry.key = key;
+  entry.generation = getGeneration(obs.myInd);
+  entry.positions = obs.positions;
+  entry.preyInd = obs.preyInd;
+  entry.myInd = obs.myInd;
+  entry.absPrey = obs.absPrey;
+  entry.prevPreyCaptured = obs.prevPreyCaptured;
+  entry.actionProbs = actionProbs;
+  pushFront(ind);
+}
+
+void ActionCache::invalidateAgent(unsigned int agentInd) {
+  boost::mutex::scoped_lock lock(mutex);
+  if (agentInd >= generations.size())
+    generations.resize(agentInd + 1,0);
+  generations[agentInd]++;
+  stats.invalidations++;
+}
+
+void ActionCache::clear() {
+  boost::mutex::scoped_lock lock(mutex);
+  entries.clear();
+  index.clear();
+  head = NONE;
+  tail = NONE;
+}
+
+unsigned int ActionCache::size() const {
+  boost::mutex::scoped_lock lock(mutex);
+  return entries.size();
+}
+
+ActionCache::Stats ActionCache::getStats() const {
+  boost::mutex::scoped_lock lock(mutex);
+  return stats;
+}
+
+void ActionCache::resetStats() {
+  boost::mutex::scoped_lock lock(mutex);
+  stats = Stats();
+}
+
+uint64_t ActionCache::getKey(const Observation &obs) {
+  uint64_t key = combine(obs.myInd,(uint64_t)(uint32_t)obs.preyInd | ((uint64_t)obs.prevPreyCaptured << 32));
+  key = combine(key,pack(obs.absPrey));
+  for (unsigned int i = 0; i < obs.positions.size(); i++)
+    key = combine(key,pack(obs.positions[i]));
+  // finish with the splitmix64 mixer, since the map only hashes with a multiply
+  key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+  return key ^ (key >> 31);
+}
+
+bool ActionCache::matches(const Entry &entry, const Observation &obs) const {
+  if ((entry.myInd != obs.myInd) || (entry.preyInd != obs.preyInd) || (entry.prevPreyCaptured != obs.prevPreyCaptured) || (entry.absPrey != obs.absPrey))
+    return false;
+  if (entry.positions.size() != obs.positions.size())
+    return false;
+  for (unsigned int i = 0; i < obs.positions.size(); i++) {
+    if (entry.positions[i] != obs.positions[i])
+      return false;
+  }
+  return true;
+}
+
+unsigned int ActionCache::getGeneration(unsigned int agentInd) const {
+  if (agentInd >= generations.size())
+    return 0;
+  return generations[agentInd];
+}
+
+void ActionCache::unlink(unsigned int ind) {
+  Entry &entry = entries[ind];
+  if (entry.prev != NONE)
+    entries[entry.prev].next = entry.next;
+  else if (head == ind)
+    head = entry.next;
+  if (entry.next != NONE)
+    entries[entry.next].prev = entry.prev;
+  else if (tail == ind)
+    tail = entry.prev;
+  entry.prev = NONE;
+  entry.next = NONE;
+}
+
+void ActionCache::pushFront(unsigned int ind) {
+  Entry &entry = entries[ind];
+  entry.prev = NONE;
+  entry.next = head;
+  if (head != NONE)
+    entries[head].prev = ind;
+  head = ind;
+  if (tail == NONE)
+    tail = ind;
+}
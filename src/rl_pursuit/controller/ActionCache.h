@@ -0,0 +1,83 @@
+#ifndef ACTIONCACHE_Q8VN3JZT
+#define ACTIONCACHE_Q8VN3JZT
+
+/*
+File: ActionCache.h
+Author: Samuel Barrett
+Description: a bounded cache of the action distributions that agents return
+  for an observation, shared by a world and its clones so every rollout can
+  reuse them. Only agents whose step depends on nothing but the observation
+  should be cached. Entries are keyed by a hash of the observation and the
+  agent's index, the full observation is checked on lookup, and the least
+  recently used entry is evicted when the cache is full. Invalidating an
+  agent drops everything cached for it, which is done after it learns.
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/thread/mutex.hpp>
+#include <rl_pursuit/common/FlatHashMap.h>
+#include <rl_pursuit/model/Common.h>
+
+class ActionCache {
+public:
+  struct Stats {
+    Stats();
+    double getHitRate() const;
+
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t invalidations;
+  };
+
+  ActionCache(unsigned int capacity);
+
+  // obs.myInd is the agent's index
+  bool get(const Observation &obs, ActionProbs &actionProbs);
+  void put(const Observation &obs, const ActionProbs &actionProbs);
+  void invalidateAgent(unsigned int agentInd);
+  void clear();
+
+  unsigned int getCapacity() const {return capacity;}
+  unsigned int size() const;
+  Stats getStats() const;
+  void resetStats();
+
+private:
+  static const unsigned int NONE;
+
+  struct Entry {
+    uint64_t key;
+    unsigned int generation;
+    PositionList positions;
+    int preyInd;
+    unsigned int myInd;
+    Point2D absPrey;
+    bool prevPreyCaptured;
+    ActionProbs actionProbs;
+    // least recently used list
+    unsigned int prev;
+    unsigned int next;
+  };
+
+  static uint64_t getKey(const Observation &obs);
+  bool matches(const Entry &entry, const Observation &obs) const;
+  unsigned int getGeneration(unsigned int agentInd) const;
+  void unlink(unsigned int ind);
+  void pushFront(unsigned int ind);
+
+private:
+  const unsigned int capacity;
+  mutable boost::mutex mutex;
+  std::vector<Entry> entries;
+  FlatHashMap<uint64_t,unsigned int> index; // key -> entry
+  unsigned int head; // most recently used
+  unsigned int tail; // least recently used
+  std::vector<unsigned int> generations; // per agent, bumped to invalidate
+  Stats stats;
+};
+
+#endif /* end of include guard: ACTIONCACHE_Q8VN3JZT */
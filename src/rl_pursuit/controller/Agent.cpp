@@ -2,7 +2,8 @@
 
 Agent::Agent(boost::shared_ptr<RNG> rng, const Point2D &dims):
   rng(rng),
-  dims(dims)
+  dims(dims),
+  geometry(Geometry::get(dims))
 {}
 
 Agent::~Agent() {
@@ -6,7 +6,7 @@ File: Agent.h
 Author: Samuel Barrett
 Description: Abstract agent type
 Created:  2011-08-22
-Modified: 2011-08-22
+Modified: 2013-08-19
 */
 
 #include <string>
@@ -14,6 +14,7 @@ Modified: 2011-08-22
 
 #include <rl_pursuit/common/RNG.h>
 #include <rl_pursuit/model/Common.h>
+#include <rl_pursuit/model/Geometry.h>
 #include <rl_pursuit/common/Util.h>
 
 class Agent {
@@ -28,11 +29,22 @@ public:
   virtual std::string generateLongDescription(unsigned int indentation = 0);
   virtual Agent* clone() = 0;
   virtual void learn(const Observation &prevObs, const Observation &currentObs, unsigned int ind);
+  // copies whatever step changes from source, an agent of the same type, so pooled
+  // simulations can be rewound without cloning. false means clone instead
+  virtual bool copyStepState(const Agent &/*source*/) { return false; }
+  // true if step depends on nothing but the observation, so its results can be cached
+  virtual bool isStepCacheable() const { return false; }
+  // true if learn can change what step returns
+  virtual bool learnsOnline() const { return false; }
+  // false if step writes to something shared with the clones, so they can't
+  // step in different threads at once
+  virtual bool canStepInParallel() const { return true; }
   //virtual void minimalStep(const Observation &[>obs<]) {}
 
 protected:
   boost::shared_ptr<RNG> rng;
   const Point2D dims;
+  boost::shared_ptr<const Geometry> geometry; // shared by everything with these dims
 };
 
 typedef boost::shared_ptr<Agent> AgentPtr;
@@ -30,6 +30,10 @@ public:
     return new AgentDummy(*this);
   }
 
+  bool copyStepState(const Agent &) {
+    return true; // step doesn't keep any state
+  }
+
 private:
   ActionProbs action;
 };
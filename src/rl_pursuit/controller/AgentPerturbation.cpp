@@ -58,6 +58,18 @@ AgentPerturbation* AgentPerturbation::clone() {
   return copy;
 }
 
+bool AgentPerturbation::copyStepState(const Agent &source) {
+  return agent->copyStepState(*(static_cast<const AgentPerturbation&>(source).agent));
+}
+
+bool AgentPerturbation::isStepCacheable() const {
+  return agent->isStepCacheable();
+}
+
+bool AgentPerturbation::learnsOnline() const {
+  return agent->learnsOnline();
+}
+
 void AgentPerturbation::learn(const Observation &prevObs, const Observation &currentObs, unsigned int ind) {
   agent->learn(prevObs,currentObs,ind);
 }
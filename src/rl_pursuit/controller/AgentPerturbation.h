@@ -6,7 +6,7 @@ File: AgentPerturbation.h
 Author: Samuel Barrett
 Description: perturbation of another agent
 Created:  2012-02-01
-Modified: 2012-02-01
+Modified: 2013-08-19
 */
 
 #include "Agent.h"
@@ -31,6 +31,12 @@ public:
   std::string generateLongDescription(unsigned int indentation = 0);
 
   AgentPerturbation* clone();
+  bool copyStepState(const Agent &source);
+  bool isStepCacheable() const;
+  bool learnsOnline() const;
+  bool canStepInParallel() const {
+    return agent->canStepInParallel();
+  }
 
   void learn(const Observation &prevObs, const Observation &currentObs, unsigned int ind);
 
@@ -29,6 +29,14 @@ public:
   AgentRandom* clone() {
     return new AgentRandom(*this);
   }
+
+  bool copyStepState(const Agent &) {
+    return true; // step doesn't keep any state
+  }
+
+  bool isStepCacheable() const {
+    return true;
+  }
 };
 
 #endif /* end of include guard: AGENTRANDOM_2VL5554W */
@@ -3,10 +3,11 @@ File: ModelUpdater.cpp
 Author: Samuel Barrett
 Description: abstract class for updating the models
 Created:  2011-09-21
-Modified: 2011-09-21
+Modified: 2013-08-19
 */
 
 #include "ModelUpdater.h"
+#include <boost/bind.hpp>
 #include <boost/lexical_cast.hpp>
 
 //#define MODELUPDATER_DEBUG
@@ -27,15 +28,19 @@ ModelInfo::ModelInfo(const boost::shared_ptr<WorldMDP> &mdp, const std::string &
 ModelUpdater::ModelUpdater(boost::shared_ptr<RNG> rng, const std::vector<ModelInfo> &models):
   rng(rng),
   models(models),
-  modelStillUsed(models.size(),true)
+  modelStillUsed(models.size(),true),
+  numSearchWorkers(0),
+  modelsCanStepInParallel(true)
 {
   normalizeModelProbs();
+  clearModelPools();
 }
 
 void ModelUpdater::set(const ModelUpdater &other) {
   models.clear();
   for (unsigned int i = 0; i < other.models.size(); i++)
     models.push_back(ModelInfo(other.models[i].mdp->clone(),other.models[i].description,other.models[i].prob));
+  clearModelPools();
 }
 
 //void ModelUpdater::copyModel(unsigned int ind, Model &model, boost::shared_ptr<Agent> adhocAgent) const {
@@ -53,6 +58,7 @@ void ModelUpdater::set(const ModelUpdater &other) {
 void ModelUpdater::learnControllers(const Observation &prevObs, const Observation &currentObs) {
   for (unsigned int i = 0; i < models.size(); i++)
     models[i].mdp->learnControllers(prevObs,currentObs);
+  clearModelPools(); // the agents may have learned state that isn't shared with the clones
   //Observation absPrevObs(prevObs);
   //Observation absCurrentObs(currentObs);
   //absPrevObs.uncenterPrey(mdp->getDims());
@@ -68,7 +74,7 @@ void ModelUpdater::learnControllers(const Observation &prevObs, const Observatio
 boost::shared_ptr<WorldMDP> ModelUpdater::selectModel(const State_t &state) {
   unsigned int ind = selectModelInd(state);
   //boost::shared_ptr<WorldMDP> mdp(new WorldMDP(*(models[ind].mdp)));
-  boost::shared_ptr<WorldMDP> mdp = models[ind].mdp->clone();
+  boost::shared_ptr<WorldMDP> mdp = borrowModel(ind,models[ind].pool);
   mdp->setState(state);
   OUTPUT("Select Model: " << ind << " " << models[ind].description);
   return mdp;
@@ -76,6 +82,53 @@ boost::shared_ptr<WorldMDP> ModelUpdater::selectModel(const State_t &state) {
   //mdp->setAgents(models[ind]);
 }
 
+boost::shared_ptr<WorldMDP> ModelUpdater::selectModel(const State_t &state, boost::shared_ptr<RNG> rng, unsigned int workerInd) {
+  if (!canSelectModelsInParallel())
+    return boost::shared_ptr<WorldMDP>();
+  if (workerInd >= numSearchWorkers) {
+    std::cerr << "ModelUpdater: ERROR, no model pool for search worker " << workerInd << ", call setNumSearchWorkers first" << std::endl;
+    exit(72);
+  }
+  unsigned int ind = sampleModelInd(state,*rng);
+  boost::shared_ptr<WorldMDP> mdp = borrowModel(ind,models[ind].workerPools[workerInd]);
+  mdp->setRNG(rng); // a rewound copy can have picked up the model's stream again
+  mdp->setState(state);
+  OUTPUT("Select Model: " << ind << " " << models[ind].description);
+  return mdp;
+}
+
+unsigned int ModelUpdater::sampleModelInd(const State_t &, RNG &) const {
+  std::cerr << "ModelUpdater: ERROR, this updater can't select models from several threads" << std::endl;
+  exit(70);
+}
+
+boost::shared_ptr<WorldMDP> ModelUpdater::borrowModel(unsigned int ind, std::vector<boost::shared_ptr<WorldMDP> > &pool) {
+  // a copy that only the pool still holds is finished with its last rollout,
+  // so rewind it instead of cloning the model again
+  for (unsigned int i = 0; i < pool.size(); i++) {
+    if (pool[i].unique()) {
+      pool[i]->rewind(*(models[ind].mdp));
+      return pool[i];
+    }
+  }
+  pool.push_back(models[ind].mdp->clone());
+  return pool.back();
+}
+
+void ModelUpdater::clearModelPools() {
+  modelsCanStepInParallel = true;
+  for (unsigned int i = 0; i < models.size(); i++) {
+    models[i].pool.clear();
+    models[i].workerPools.assign(numSearchWorkers,std::vector<boost::shared_ptr<WorldMDP> >());
+    modelsCanStepInParallel = modelsCanStepInParallel && models[i].mdp->canStepInParallel();
+  }
+}
+
+void ModelUpdater::setNumSearchWorkers(unsigned int numWorkers) {
+  numSearchWorkers = numWorkers;
+  clearModelPools();
+}
+
 void ModelUpdater::normalizeModelProbs() {
   double total = 0;
   for (unsigned int i = 0; i < models.size(); i++)
@@ -140,24 +193,35 @@ void ModelUpdater::updateControllerInformation(const Observation &obs) {
   //float reward;
   //State_t state;
   //bool terminal;
-  for (unsigned int i = 0; i < models.size(); i++) {
-    models[i].mdp->setState(obs);
-    models[i].mdp->step(Action::NOOP);
-    //mdp->setAgents(models[i]);
-    //mdp->takeAction(Action::NOOP,reward,state,terminal);
-  }
+  runModelTasks(boost::bind(&ModelUpdater::updateModelControllerInformation,this,_1,boost::cref(obs)));
   // reset the mdp
   //mdp->setState(obs);
   //std::cout << "STOP UPDATE CONTROLLER INFO" << std::endl;
 }
 
+void ModelUpdater::updateModelControllerInformation(unsigned int ind, const Observation &obs) {
+  models[ind].mdp->setState(obs);
+  models[ind].mdp->step(Action::NOOP);
+  //mdp->setAgents(models[i]);
+  //mdp->takeAction(Action::NOOP,reward,state,terminal);
+}
+
+void ModelUpdater::runModelTasks(const WorkerPool::Task &task) {
+  if (workerPool.get() != NULL) {
+    workerPool->run(models.size(),task);
+  } else {
+    for (unsigned int i = 0; i < models.size(); i++)
+      task(i);
+  }
+}
+
 void ModelUpdater::setPreyPos(const Point2D &preyPos) {
   for (unsigned int i = 0; i < models.size(); i++)
     models[i].mdp->setPreyPos(preyPos);
 }
 
 State_t ModelUpdater::getState(const Observation &obs) {
-  return models[0].mdp->getState(obs);
+  return models[0].mdp->getRootState(obs); // the models share the root
 }
 
 void ModelUpdater::enableOutput(const boost::shared_ptr<std::ostream> &outputStream) {
@@ -189,3 +253,17 @@ void ModelUpdater::enablePrecisionOutput(const boost::shared_ptr<std::ostream> &
 void ModelUpdater::disablePrecisionOutput() {
   precisionOutputStream.reset();
 }
+
+void ModelUpdater::setNumThreads(unsigned int numThreads) {
+  if (numThreads == 0) {
+    workerPool.reset();
+    return;
+  }
+  workerPool = boost::shared_ptr<WorkerPool>(new WorkerPool(numThreads));
+  // the models shared the planner's streams, which can't be drawn from in
+  // parallel and would be drawn from in a different order by each run
+  RNG base(rng->randomUInt());
+  for (unsigned int i = 0; i < models.size(); i++)
+    models[i].mdp->setRNG(boost::shared_ptr<RNG>(new RNG(base.getStream(i))));
+  clearModelPools(); // the copies still have the old streams
+}
@@ -6,13 +6,14 @@ File: ModelUpdater.h
 Author: Samuel Barrett
 Description: abstract class for updating the models
 Created:  2011-09-21
-Modified: 2011-09-21
+Modified: 2013-08-19
 */
 
 #include <vector>
 #include <string>
 #include <boost/shared_ptr.hpp>
 #include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/common/WorkerPool.h>
 #include <rl_pursuit/controller/WorldMDP.h>
 #include <rl_pursuit/controller/Agent.h>
 #include <rl_pursuit/controller/State.h>
@@ -22,6 +23,8 @@ struct ModelInfo {
   boost::shared_ptr<WorldMDP> mdp;
   std::string description;
   double prob;
+  std::vector<boost::shared_ptr<WorldMDP> > pool; // clones of mdp for the rollouts
+  std::vector<std::vector<boost::shared_ptr<WorldMDP> > > workerPools; // the same for each search worker
 };
 
 class ModelUpdater {
@@ -33,7 +36,18 @@ public:
   virtual void updateRealWorldAction(const Observation &prevObs, Action::Type lastAction, const Observation &currentObs) = 0;
   virtual void updateSimulationAction(const Action::Type &action, const State_t &state) = 0;
   virtual void learnControllers(const Observation &prevObs, const Observation &currentObs);
+  // only for the planning thread, the copy comes from the model's rewind pool,
+  // which isn't locked. Worker threads use the version with their own rng
   boost::shared_ptr<WorldMDP> selectModel(const State_t &state);
+  // a copy of a model that draws from rng, for the planner's worker thread
+  // workerInd. The copies come from that worker's own rewind pool and the
+  // rest of the updater is only read, so the workers can call it at once, but
+  // not while the beliefs are being updated. NULL unless the updater
+  // canSelectModelsInParallel
+  boost::shared_ptr<WorldMDP> selectModel(const State_t &state, boost::shared_ptr<RNG> rng, unsigned int workerInd);
+  virtual bool canSelectModelsInParallel() const {return false;}
+  // makes the pools for the worker threads, call before they search
+  void setNumSearchWorkers(unsigned int numWorkers);
   std::string generateDescription(unsigned int indentation = 0);
   std::vector<double> getBeliefs();
   void updateControllerInformation(const Observation &obs);
@@ -50,9 +64,25 @@ public:
   void enablePrecisionOutput(const boost::shared_ptr<std::ostream> &outputStream);
   void disablePrecisionOutput();
 
+  // with numThreads > 0, the models are updated on that many threads, and each
+  // model gets its own stream of random numbers so the results are the same
+  // for any number of threads. 0 updates them in order with the shared streams
+  void setNumThreads(unsigned int numThreads);
+
 protected:
   virtual unsigned int selectModelInd(const State_t &state) = 0;
+  // like selectModelInd, but only reads the updater, for selectModel from the workers
+  virtual unsigned int sampleModelInd(const State_t &state, RNG &rng) const;
+  // a copy of the model from pool, rewound if a finished one is free.
+  // Freeness is checked with unique() and nothing is locked, so each pool
+  // must only be used from one thread at a time
+  boost::shared_ptr<WorldMDP> borrowModel(unsigned int ind, std::vector<boost::shared_ptr<WorldMDP> > &pool);
+  // also checks again whether the models' clones can step in several threads
+  void clearModelPools();
   void removeModel(unsigned int ind);
+  void updateModelControllerInformation(unsigned int ind, const Observation &obs);
+  // calls task(i) for each model, on the worker pool if there is one
+  void runModelTasks(const WorkerPool::Task &task);
   virtual std::string generateSpecificDescription() = 0;
 
 protected:
@@ -61,6 +91,9 @@ protected:
   std::vector<bool> modelStillUsed;
   boost::shared_ptr<std::ostream> outputStream;
   boost::shared_ptr<std::ostream> precisionOutputStream;
+  boost::shared_ptr<WorkerPool> workerPool; // NULL updates the models in order
+  unsigned int numSearchWorkers;
+  bool modelsCanStepInParallel; // updated with the pools, the agents can change when they learn
 };
 
 #endif /* end of include guard: MODELUPDATER_82ED5P8 */
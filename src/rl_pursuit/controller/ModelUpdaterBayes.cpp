@@ -3,13 +3,17 @@ File: ModelUpdaterBayes.cpp
 Author: Samuel Barrett
 Description: a model updater using bayesian updates, also handles updating by polynomial function of the loss
 Created:  2011-09-21
-Modified: 2011-10-02
+Modified: 2013-08-19
 */
 
 #undef DEBUG_MODELS
 
 #include "ModelUpdaterBayes.h"
 #include <math.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <boost/bind.hpp>
 
 //const float ModelUpdaterBayes::MIN_MODEL_PROB = 0.001;
 
@@ -33,12 +37,16 @@ ModelUpdaterBayes::ModelUpdaterBayes(boost::shared_ptr<RNG> rng, const std::vect
       exit(45);
     }
   }
+  resetLogBeliefs();
 }
 
 void ModelUpdaterBayes::updateRealWorldAction(const Observation &prevObs, Action::Type lastAction, const Observation &currentObs) {
   if (p.stepsUntilSafetyModel == 0) {
     models.clear();
     models.push_back(*safetyModel);
+    clearModelPools(); // the safety model was copied before the search workers were set
+    normalizeModelProbs();
+    resetLogBeliefs();
     std::cout << "SWITCHING TO SAFETY" << std::endl;
   }
   p.stepsUntilSafetyModel--;
@@ -52,9 +60,7 @@ void ModelUpdaterBayes::updateRealWorldAction(const Observation &prevObs, Action
   if (p.modelUpdateType == ModelUpdateType::none)
     return;
 
-  std::vector<double> newModelProbs(models.size());
-  for (unsigned int i = 0; i < models.size(); i++)
-    newModelProbs[i] = models[i].prob;
+  newLogBeliefs = logBeliefs;
 
 #ifdef DEBUG_MODELS
   std::cout << "ORIG PROBS: " << std::endl;
@@ -63,33 +69,31 @@ void ModelUpdaterBayes::updateRealWorldAction(const Observation &prevObs, Action
 #endif
 
   // calculate the new model probabilities
-  getNewModelProbs(prevObs,lastAction,currentObs,newModelProbs);
+  getNewModelLogProbs(prevObs,lastAction,currentObs,newLogBeliefs);
   // reset the mdp
   //mdp->setState(currentObs); // TODO removed in model change, is this okay to leave out?
-  // normalize the probabilities
-  normalizeProbs(newModelProbs);
-  // check if all zero probs
-  if (allProbsTooLow(newModelProbs)) {
+  // normalize the probabilities, unless every model said the step was impossible
+  if (!normalizeLogProbs(newLogBeliefs)) {
 #ifdef DEBUG_MODELS
     std::cout << "All model probs too low" << std::endl;
 #endif
     return;
   }
   // set our models
-  for (unsigned int i = 0; i < models.size(); i++)
-    models[i].prob = newModelProbs[i];
+  logBeliefs.swap(newLogBeliefs);
   // delete models with very low probabilities
   if (p.addUpdateNoise) {
 #ifdef DEBUG_MODELS
   std::cout << "before noise PROBS: " << std::endl;
   for (unsigned int i = 0; i < models.size(); i++)
-    std::cout << "  " << models[i].description << ": " << models[i].prob << std::endl;
+    std::cout << "  " << models[i].description << ": " << exp(logBeliefs[i]) << std::endl;
 #endif
     for (unsigned int i = 0; i < models.size(); i++)
-      models[i].prob = (1 - p.updateNoise) * models[i].prob + p.updateNoise / models.size();
+      logBeliefs[i] = log((1 - p.updateNoise) * exp(logBeliefs[i]) + p.updateNoise / models.size());
   } else {
     removeLowProbabilityModels();
   }
+  setProbsFromLogBeliefs();
 #ifdef DEBUG_MODELS
   std::cout << "NEW PROBS: " << std::endl;
   for (unsigned int i = 0; i < models.size(); i++)
@@ -101,34 +105,44 @@ void ModelUpdaterBayes::updateSimulationAction(const Action::Type &, const State
   // DO NOTHING
 }
 
-unsigned int ModelUpdaterBayes::selectModelInd(const State_t &) {
-  // sample the current probs
-  float val = rng->randomFloat();
-  double total = 0;
-  unsigned int selectedInd;
-  for (selectedInd = 0; selectedInd < models.size() - 1; selectedInd++) { // -1 because if it's not in the first n - 1, it's in the last and it makes the later processing easier
-    total += models[selectedInd].prob;
-    if (val < total)
-      break;
-  }
-  return selectedInd;
+unsigned int ModelUpdaterBayes::selectModelInd(const State_t &state) {
+  return sampleModelInd(state,*rng);
+}
+
+unsigned int ModelUpdaterBayes::sampleModelInd(const State_t &, RNG &rng) const {
+  // the table is rebuilt whenever the beliefs change, so sampling is O(1)
+  return modelSampler.sample(rng);
 }
 
-void ModelUpdaterBayes::getNewModelProbs(const Observation &prevObs, Action::Type lastAction, const Observation &currentObs, std::vector<double> &newModelProbs) {
+void ModelUpdaterBayes::getNewModelLogProbs(const Observation &prevObs, Action::Type lastAction, const Observation &currentObs, std::vector<double> &newLogProbs) {
   double modelProb;
   double loss;
   double eta = p.lossEta; // eta must be <= 0.5
+  // each model's likelihood goes in its own slot, and they're combined in
+  // order afterwards so the result doesn't depend on the threads
+  modelLikelihoods.resize(models.size());
+  modelAgentProbs.resize(models.size());
+  runModelTasks(boost::bind(&ModelUpdaterBayes::calculateModelProb,this,_1,boost::cref(prevObs),lastAction,boost::cref(currentObs)));
+
   if (precisionOutputStream.get() != NULL)
     (*precisionOutputStream) << "-----" << std::endl;
   for (unsigned int i = 0; i < models.size(); i++) {
-    modelProb = calculateModelProb(i,prevObs,lastAction,currentObs);
+    modelProb = modelLikelihoods[i];
+    if (precisionOutputStream.get() != NULL) {
+      std::ostream &out = *precisionOutputStream;
+      out << models[i].description;
+      for (unsigned int j = 0; j < modelAgentProbs[i].size(); j++) {
+        out << "," << modelAgentProbs[i][j];
+      }
+      out << std::endl;
+    }
     switch(p.modelUpdateType) {
       case ModelUpdateType::bayesian:
-        newModelProbs[i] *= modelProb;
+        newLogProbs[i] += log(modelProb); // -inf for a model that can't explain the step
         break;
       case ModelUpdateType::polynomial:
         loss = 1.0 - modelProb;
-        newModelProbs[i] *= (1 - eta * loss);
+        newLogProbs[i] += log(1 - eta * loss);
         break;
       case ModelUpdateType::none:
         assert(false);
@@ -140,53 +154,86 @@ void ModelUpdaterBayes::getNewModelProbs(const Observation &prevObs, Action::Typ
   }
 }
 
-double ModelUpdaterBayes::calculateModelProb(unsigned int modelInd, const Observation &prevObs, Action::Type lastAction, const Observation &currentObs) {
-  boost::shared_ptr<WorldMDP> mdp = models[modelInd].mdp->clone();
-  //boost::shared_ptr<WorldMDP> mdp = models[modelInd].mdp;
-  //(*(models[modelInd].mdp));
-  //mdp->setAgents(model);
-  std::vector<double> agentProbs;
-  double prob = mdp->getOutcomeProb(prevObs,lastAction,currentObs,agentProbs);
-  if (precisionOutputStream.get() != NULL) {
-    std::ostream &out = *precisionOutputStream;
-    out << models[modelInd].description;
-    for (unsigned int i = 0; i < agentProbs.size(); i++) {
-      out << "," << agentProbs[i];
-    }
-    out << std::endl;
+void ModelUpdaterBayes::calculateModelProb(unsigned int modelInd, const Observation &prevObs, Action::Type lastAction, const Observation &currentObs) {
+  // the likelihood doesn't change the model, so there's no need to clone it
+  modelLikelihoods[modelInd] = models[modelInd].mdp->getOutcomeProb(prevObs,lastAction,currentObs,modelAgentProbs[modelInd],p.exactOutcomeProbs);
+  //std::cout << "    CALCULATE MODEL PROB FOR " << modelInd << " = " << modelLikelihoods[modelInd] << std::endl;
+}
+
+bool ModelUpdaterBayes::normalizeLogProbs(std::vector<double> &logProbs) {
+  // log-sum-exp, shifted by the largest so the biggest term is exp(0)
+  double maxLogProb = -std::numeric_limits<double>::infinity();
+  for (unsigned int i = 0; i < logProbs.size(); i++) {
+    if (isnan(logProbs[i]))
+      return false;
+    maxLogProb = std::max(maxLogProb,logProbs[i]);
   }
-  //std::cout << "    CALCULATE MODEL PROB FOR " << modelInd << " = " << prob << std::endl;
-  return prob;
+  if (isinf(maxLogProb))
+    return false;
+  double total = 0;
+  for (unsigned int i = 0; i < logProbs.size(); i++)
+    total += exp(logProbs[i] - maxLogProb);
+  double logTotal = maxLogProb + log(total);
+  for (unsigned int i = 0; i < logProbs.size(); i++)
+    logProbs[i] -= logTotal;
+  return true;
 }
 
-bool ModelUpdaterBayes::allProbsTooLow(const std::vector<double> &newModelProbs) {
-  // check for a divide by 0
-  for (unsigned int i = 0; i < newModelProbs.size(); i++)
-    if (isinf(newModelProbs[i]) || isnan(newModelProbs[i]))
-      return true;
-  return false;
+void ModelUpdaterBayes::resetLogBeliefs() {
+  logBeliefs.resize(models.size());
+  for (unsigned int i = 0; i < models.size(); i++)
+    logBeliefs[i] = log(models[i].prob);
+  setProbsFromLogBeliefs();
+}
+
+void ModelUpdaterBayes::setProbsFromLogBeliefs() {
+  modelProbs.resize(models.size());
+  for (unsigned int i = 0; i < models.size(); i++)
+    modelProbs[i] = models[i].prob = exp(logBeliefs[i]);
+  if (!models.empty())
+    modelSampler.build(modelProbs);
 }
 
 void ModelUpdaterBayes::removeLowProbabilityModels() {
+  double logCutoff = log(p.MIN_MODEL_PROB);
+  unsigned int numAtCutoff = models.size(); // how many tied with the cutoff can stay
+  // with maxModels, the cutoff rises to the maxModels'th largest belief
+  if (p.allowRemovingModels && (p.maxModels > 0) && (models.size() > p.maxModels)) {
+    sortedLogBeliefs = logBeliefs;
+    std::nth_element(sortedLogBeliefs.begin(),sortedLogBeliefs.begin() + p.maxModels - 1,sortedLogBeliefs.end(),std::greater<double>());
+    double logKth = sortedLogBeliefs[p.maxModels - 1];
+    if (logKth >= logCutoff) {
+      logCutoff = logKth;
+      numAtCutoff = p.maxModels;
+      for (unsigned int i = 0; i + 1 < p.maxModels; i++) {
+        if (sortedLogBeliefs[i] > logKth)
+          numAtCutoff--;
+      }
+    }
+  }
+
   bool removedModels = false;
   unsigned int i = 0;
   // remove the models that are below the threshold
   while (i < models.size()) {
-    if (models[i].prob < p.MIN_MODEL_PROB) {
-      if (p.allowRemovingModels)
-        removeModel(i);
-      else {
-        models[i].prob = p.MIN_MODEL_PROB;
-        ++i;
-      }
-      removedModels = true;
+    if ((logBeliefs[i] > logCutoff) || ((logBeliefs[i] == logCutoff) && (numAtCutoff > 0))) {
+      if (logBeliefs[i] == logCutoff)
+        numAtCutoff--;
+      ++i;
+      continue;
+    }
+    if (p.allowRemovingModels) {
+      removeModel(i);
+      logBeliefs.erase(logBeliefs.begin() + i);
     } else {
+      logBeliefs[i] = logCutoff;
       ++i;
     }
+    removedModels = true;
   }
   // renormalize if we removed models
   if (removedModels)
-    normalizeModelProbs();
+    normalizeLogProbs(logBeliefs);
 }
 
 std::string ModelUpdaterBayes::generateSpecificDescription() {
@@ -6,13 +6,14 @@ File: ModelUpdaterBayes.h
 Author: Samuel Barrett
 Description: a model updater using bayesian updates, also handles updating by polynomial function of the loss
 Created:  2011-09-21
-Modified: 2011-10-02
+Modified: 2013-08-19
 */
 
 #include "ModelUpdater.h"
 #include <rl_pursuit/gtest/gtest_prod.h>
 #include <rl_pursuit/common/Params.h>
 #include <rl_pursuit/common/Enum.h>
+#include <rl_pursuit/common/AliasTable.h>
 
 ENUM(ModelUpdateType,
   bayesian,
@@ -33,7 +34,9 @@ public:
   _(std::string,safetyModelDesc,safetyModelDesc,"pd") \
   _(float,lossEta,lossEta,0.5) \
   _(bool,addUpdateNoise,addUpdateNoise,false) \
-  _(float,updateNoise,updateNoise,0.05)
+  _(float,updateNoise,updateNoise,0.05) \
+  _(bool,exactOutcomeProbs,exactOutcomeProbs,false) \
+  _(unsigned int,maxModels,maxModels,0)
 
   Params_STRUCT(PARAMS)
 #undef PARAMS
@@ -45,18 +48,40 @@ public:
   ModelUpdaterBayes(boost::shared_ptr<RNG> rng, const std::vector<ModelInfo> &models, const Params &p);
   void updateRealWorldAction(const Observation &prevObs, Action::Type lastAction, const Observation &currentObs);
   void updateSimulationAction(const Action::Type &action, const State_t &state);
+  // only while none of the models' agents share anything that step writes,
+  // like a classifier's cache or buffers
+  bool canSelectModelsInParallel() const {return modelsCanStepInParallel;}
 
 protected:
   unsigned int selectModelInd(const State_t &state);
-  void getNewModelProbs(const Observation &prevObs, Action::Type lastAction, const Observation &currentObs, std::vector<double> &newModelProbs);
-  double calculateModelProb(unsigned int modelInd, const Observation &prevObs, Action::Type lastAction, const Observation &currentObs);
-  bool allProbsTooLow(const std::vector<double> &newModelProbs);
+  unsigned int sampleModelInd(const State_t &state, RNG &rng) const;
+  // adds the log of each model's update to newLogProbs
+  void getNewModelLogProbs(const Observation &prevObs, Action::Type lastAction, const Observation &currentObs, std::vector<double> &newLogProbs);
+  // fills in the model's slot of modelLikelihoods and modelAgentProbs, so the models can be done in parallel
+  void calculateModelProb(unsigned int modelInd, const Observation &prevObs, Action::Type lastAction, const Observation &currentObs);
+  // false if they're all 0, or not numbers
+  bool normalizeLogProbs(std::vector<double> &logProbs);
+  void resetLogBeliefs(); // from the models' probs
+  void setProbsFromLogBeliefs(); // and rebuilds the sampler
+  // below minModelProb or outside the best maxModels
   void removeLowProbabilityModels();
   std::string generateSpecificDescription();
 
 protected:
   ModelInfo *safetyModel;
+  // from calculateModelProb for each model
+  std::vector<double> modelLikelihoods;
+  std::vector<std::vector<double> > modelAgentProbs;
+  // the beliefs are kept as logs, so long runs of small likelihoods don't
+  // underflow, and models[i].prob follows them
+  std::vector<double> logBeliefs;
+  std::vector<double> newLogBeliefs;
+  std::vector<double> sortedLogBeliefs; // for maxModels
+  std::vector<double> modelProbs;
+  AliasTable modelSampler;
   FRIEND_TEST(ModelUpdaterBayesTest,AdvancedTests);
+  FRIEND_TEST(ModelUpdaterBayesTest,LogBeliefs);
+  FRIEND_TEST(ModelUpdaterBayesTest,ParallelSelection);
 };
 
 #endif /* end of include guard: MODELUPDATERBAYES_S4U00VNJ */
@@ -66,6 +66,12 @@ void PredatorClassifier::restart() {
   stepHistory.reset();
 }
 
+bool PredatorClassifier::copyStepState(const Agent &source) {
+  // the classifier is shared between clones, only the history changes in step
+  stepHistory = static_cast<const PredatorClassifier&>(source).stepHistory;
+  return true;
+}
+
 std::string PredatorClassifier::generateDescription() {
   std::string msg = "PredatorClassifier: chooses actions using a classifier";
   if (trainingPeriod >= 0)
@@ -86,7 +92,7 @@ void PredatorClassifier::learn(const Observation &prevObs, const Observation &cu
   if (trainingPeriod < 0)
     return;
 
-  Point2D move = getDifferenceToPoint(dims,prevObs.positions[ind],currentObs.positions[ind]);
+  Point2D move = geometry->getDifferenceToPoint(prevObs.positions[ind],currentObs.positions[ind]);
   InstancePtr instance = featureExtractor.extract(prevObs,learnHistory);
   instance->label = getAction(move);
   (*instance)[FeatureType::Pred_act] = instance->label;
@@ -6,7 +6,7 @@ File: PredatorClassifier.h
 Author: Samuel Barrett
 Description: a predator that selects actions using a decision tree
 Created:  2011-09-15
-Modified: 2011-12-02
+Modified: 2013-08-19
 */
 
 #include "Agent.h"
@@ -28,6 +28,15 @@ public:
   PredatorClassifier* clone() {
     return new PredatorClassifier(*this);
   }
+  bool copyStepState(const Agent &source);
+  // not cacheable, the features include this agent's recent actions
+  bool learnsOnline() const {
+    return (trainingPeriod >= 0) && !preventTraining;
+  }
+  // the clones share the classifier
+  bool canStepInParallel() const {
+    return classifier->canClassifyInParallel();
+  }
 
   boost::shared_ptr<Classifier> getClassifier() {
     return classifier;
@@ -4,7 +4,7 @@
 #include <rl_pursuit/common/Util.h>
 #include <iostream>
 
-Point2D getGreedyDesiredPosition(const Point2D &dims, const Observation &obs) {
+Point2D getGreedyDesiredPosition(const Geometry &geometry, const Observation &obs) {
   unsigned int minDist = -1;
   unsigned int dist;
   Point2D minPos;
@@ -15,7 +15,7 @@ Point2D getGreedyDesiredPosition(const Point2D &dims, const Observation &obs) {
   int collision;
 
   for (int action = 0; action < Action::NUM_NEIGHBORS; action++) {
-    pos = movePosition(dims,preyPos,(Action::Type)action);
+    pos = geometry.movePosition(preyPos,(Action::Type)action);
     //std::cout << "pos: " << pos << std::endl;
     collision = obs.getCollision(pos);
     if (collision == (int)obs.myInd) {
@@ -23,7 +23,7 @@ Point2D getGreedyDesiredPosition(const Point2D &dims, const Observation &obs) {
       return preyPos;
     } else if (collision < 0) {
       // not already occupied by another predator
-      dist = getDistanceToPoint(dims,pos,myPos);
+      dist = geometry.getDistanceToPoint(pos,myPos);
       //std::cout << "dist: " << dist << std::endl;
       if (dist < minDist) {
         minDist = dist;
@@ -35,17 +35,17 @@ Point2D getGreedyDesiredPosition(const Point2D &dims, const Observation &obs) {
   return minPos;
 }
 
-Action::Type greedyObstacleAvoid(const Point2D &dims, const Observation &obs, const Point2D &dest) {
+Action::Type greedyObstacleAvoid(const Geometry &geometry, const Observation &obs, const Point2D &dest) {
   const Point2D &myPos = obs.myPos();
   //std::cout << "me: " << myPos << " dest: " << dest << std::endl;
-  Point2D diff = getDifferenceToPoint(dims,myPos,dest);
+  Point2D diff = geometry.getDifferenceToPoint(myPos,dest);
   //std::cout << "diff: " << diff << std::endl;
 
   Point2D move1 = Point2D(sgn(diff.x),0);
   Point2D move2 = Point2D(0,sgn(diff.y));
   //std::cout << "moves: " << move1 << " " << move2 << std::endl;
-  Point2D pos1 = movePosition(dims,myPos,move1);
-  Point2D pos2 = movePosition(dims,myPos,move2);
+  Point2D pos1 = geometry.movePosition(myPos,move1);
+  Point2D pos2 = geometry.movePosition(myPos,move2);
   //std::cout << "pos: " << pos1 << " " << pos2 << std::endl;
   int col1 = obs.getCollision(pos1);
   int col2 = obs.getCollision(pos2);
@@ -80,7 +80,7 @@ Action::Type greedyObstacleAvoid(const Point2D &dims, const Observation &obs, co
 }
 
 ActionProbs PredatorGreedy::step(const Observation &obs) {
-  Point2D dest = getGreedyDesiredPosition(dims,obs);
-  Action::Type action = greedyObstacleAvoid(dims,obs,dest);
+  Point2D dest = getGreedyDesiredPosition(*geometry,obs);
+  Action::Type action = greedyObstacleAvoid(*geometry,obs,dest);
   return ActionProbs(action);
 }
@@ -12,8 +12,8 @@ Modified: 2011-08-22
 #include "Agent.h"
 #include <rl_pursuit/model/Common.h>
 
-Point2D getGreedyDesiredPosition(const Point2D &dims, const Observation &obs);
-Action::Type greedyObstacleAvoid(const Point2D &dims, const Observation &obs, const Point2D &dest);
+Point2D getGreedyDesiredPosition(const Geometry &geometry, const Observation &obs);
+Action::Type greedyObstacleAvoid(const Geometry &geometry, const Observation &obs, const Point2D &dest);
 
 class PredatorGreedy: public Agent {
 public:
@@ -29,6 +29,14 @@ public:
   PredatorGreedy* clone() {
     return new PredatorGreedy(*this);
   }
+
+  bool copyStepState(const Agent &) {
+    return true; // step doesn't keep any state
+  }
+
+  bool isStepCacheable() const {
+    return true;
+  }
 };
 
 #endif /* end of include guard: PREDATORGREEDY_BSWV5ETY */
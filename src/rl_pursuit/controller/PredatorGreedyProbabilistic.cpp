@@ -17,12 +17,12 @@ PredatorGreedyProbabilistic::PredatorGreedyProbabilistic(boost::shared_ptr<RNG>
 {}
 
 ActionProbs PredatorGreedyProbabilistic::step(const Observation &obs) {
-  Point2D desiredPosition = getGreedyDesiredPosition(dims,obs);
+  Point2D desiredPosition = getGreedyDesiredPosition(*geometry,obs);
   // can select either dimension and go in either direction for that dimension
   Point2D dists[2]; // dir is index
   Point2D minDists;
-  dists[0] = wrapPoint(dims,desiredPosition - obs.myPos());
-  dists[1] = wrapPoint(dims,obs.myPos() - desiredPosition);
+  dists[0] = geometry->wrapPoint(desiredPosition - obs.myPos());
+  dists[1] = geometry->wrapPoint(obs.myPos() - desiredPosition);
   minDists.x = min(dists[0].x,dists[1].x);
   minDists.y = min(dists[0].y,dists[1].y);
   // adjust the distances to account for obstacles
@@ -31,7 +31,7 @@ ActionProbs PredatorGreedyProbabilistic::step(const Observation &obs) {
   int collision;
   for (unsigned int i = 0; i < Action::NUM_NEIGHBORS; i++) {
     move = Action::MOVES[i];
-    pos = movePosition(dims,obs.myPos(),move);
+    pos = geometry->movePosition(obs.myPos(),move);
     collision = obs.getCollision(pos);
     if ((collision >= 0) && (collision != obs.preyInd)) {
       if (move.x > 0)
@@ -23,6 +23,14 @@ public:
     return new PredatorGreedyProbabilistic(*this);
   }
 
+  bool copyStepState(const Agent &) {
+    return true; // step doesn't keep any state
+  }
+
+  bool isStepCacheable() const {
+    return true;
+  }
+
 private:
   static const unsigned int blockedPenalty;
   static const float dimensionFactor;
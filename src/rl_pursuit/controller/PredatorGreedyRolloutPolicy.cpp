@@ -0,0 +1,20 @@
+#include "PredatorGreedyRolloutPolicy.h"
+#include <iostream>
+#include <rl_pursuit/controller/PredatorGreedy.h>
+#include <rl_pursuit/controller/WorldMDP.h>
+
+Action::Type PredatorGreedyRolloutPolicy::selectAction(ModelPtr model, const State_t &/*state*/, RNG &/*rng*/) {
+  WorldMDP *mdp = dynamic_cast<WorldMDP*>(model.get());
+  if (mdp == NULL) {
+    std::cerr << "PredatorGreedyRolloutPolicy: ERROR, model must be a WorldMDP" << std::endl;
+    exit(62);
+  }
+  Observation obs;
+  mdp->generateAdhocObservation(obs);
+  const Geometry &geometry = mdp->getGeometry();
+  return greedyObstacleAvoid(geometry,obs,getGreedyDesiredPosition(geometry,obs));
+}
+
+std::string PredatorGreedyRolloutPolicy::generateDescription(unsigned int indentation) {
+  return indent(indentation) + "PredatorGreedyRolloutPolicy";
+}
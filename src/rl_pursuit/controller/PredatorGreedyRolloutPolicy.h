@@ -0,0 +1,22 @@
+#ifndef PREDATORGREEDYROLLOUTPOLICY_V8D3NQ1K
+#define PREDATORGREEDYROLLOUTPOLICY_V8D3NQ1K
+
+/*
+File: PredatorGreedyRolloutPolicy.h
+Author: Samuel Barrett
+Description: a default policy for MCTS rollouts that moves the adhoc agent
+  like PredatorGreedy does. The model must be a WorldMDP.
+Created:  2013-08-16
+Modified: 2013-08-16
+*/
+
+#include <rl_pursuit/planning/RolloutPolicy.h>
+#include <rl_pursuit/controller/State.h>
+
+class PredatorGreedyRolloutPolicy: public RolloutPolicy<State_t,Action::Type> {
+public:
+  Action::Type selectAction(ModelPtr model, const State_t &state, RNG &rng);
+  std::string generateDescription(unsigned int indentation = 0);
+};
+
+#endif /* end of include guard: PREDATORGREEDYROLLOUTPOLICY_V8D3NQ1K */
@@ -1,11 +1,19 @@
 #include "PredatorMCTS.h"
+#include <fstream>
+#include <boost/thread/mutex.hpp>
 
 //#define PREDATOR_MCTS_TIMING
 
+#ifdef PREDATOR_MCTS_TIMING
+// shared by every predator, so only meaningful with a single trial thread
 double PREDATOR_MCTS_TIMING_MODEL_UPDATE = 0.;
 double PREDATOR_MCTS_TIMING_SEARCH = 0.;
 double PREDATOR_MCTS_TIMING_UPDATE_CONTROLLER = 0.;
 double PREDATOR_MCTS_TIMING_PRUNING = 0.;
+#endif
+
+// the trials running in parallel append to the same profile file
+static boost::mutex profileFileMutex;
 
 PredatorMCTS::PredatorMCTS(boost::shared_ptr<RNG> rng, const Point2D &dims, boost::shared_ptr<MCTS<State_t,Action::Type> > planner, boost::shared_ptr<ModelUpdater> modelUpdater, boost::shared_ptr<QuandryDetector> quandryDetector, const Params &p):
   Agent(rng,dims),
@@ -15,12 +23,16 @@ PredatorMCTS::PredatorMCTS(boost::shared_ptr<RNG> rng, const Point2D &dims, boos
   prevAction(Action::NUM_MOVES),
   movingToTarget(false),
   pathPlanner(dims),
+  profileTrial(0),
+  profileEpisode(0),
   p(p)
 {
+#ifdef PREDATOR_MCTS_TIMING
   PREDATOR_MCTS_TIMING_MODEL_UPDATE = 0.;
   PREDATOR_MCTS_TIMING_SEARCH = 0.;
   PREDATOR_MCTS_TIMING_UPDATE_CONTROLLER = 0.;
   PREDATOR_MCTS_TIMING_PRUNING = 0.;
+#endif
 }
 
 ActionProbs PredatorMCTS::step(const Observation &obs) {
@@ -38,13 +50,6 @@ ActionProbs PredatorMCTS::step(const Observation &obs) {
 #endif
     //std::cout << "stop  predmcts model update" << std::endl;
   }
-#ifdef PREDATOR_MCTS_TIMING
-  tic(2);
-#endif
-  planner->pruneOldVisits(); // remove everything we didn't see last set of rollouts
-#ifdef PREDATOR_MCTS_TIMING
-  toc(PREDATOR_MCTS_TIMING_PRUNING,2);
-#endif
   // output the model updater's probabilities
   modelUpdater->output();
   // set the beliefs of the model (applicable for the belief mdp)
@@ -52,6 +57,13 @@ ActionProbs PredatorMCTS::step(const Observation &obs) {
   modelUpdater->setPreyPos(obs.absPrey);
   // do the searching
   State_t state = modelUpdater->getState(obs);
+#ifdef PREDATOR_MCTS_TIMING
+  tic(2);
+#endif
+  planner->pruneOldVisits(state); // remove everything we didn't see last set of rollouts, or that isn't below state
+#ifdef PREDATOR_MCTS_TIMING
+  toc(PREDATOR_MCTS_TIMING_PRUNING,2);
+#endif
   //std::cout << "----------START SEARCH---------" << std::endl;
 #ifdef PREDATOR_MCTS_TIMING
   tic(3);
@@ -71,7 +83,7 @@ ActionProbs PredatorMCTS::step(const Observation &obs) {
     // if stuck, move to the opposite side of the prey
     if (stuck && !movingToTarget) {
       movingToTarget = true;
-      Point2D pos = getDifferenceToPoint(dims,obs.preyPos(),obs.myPos());
+      Point2D pos = geometry->getDifferenceToPoint(obs.preyPos(),obs.myPos());
       if (abs(pos.x) > abs(pos.y)) {
         target.y = 0;
         target.x = -1 * sgn(pos.x);
@@ -87,7 +99,7 @@ ActionProbs PredatorMCTS::step(const Observation &obs) {
   // see if we're following a plan
   if (movingToTarget) {
     // move target relative to prey
-    Point2D dest = movePosition(dims,obs.preyPos(),target);
+    Point2D dest = geometry->movePosition(obs.preyPos(),target);
     if (target.x == 0)
       dest.x = obs.myPos().x;
     else
@@ -99,7 +111,7 @@ ActionProbs PredatorMCTS::step(const Observation &obs) {
     } else {
       pathPlanner.plan(obs.myPos(),dest,obs.positions);
       if (pathPlanner.foundPath()) {
-        Point2D diff = getDifferenceToPoint(dims,obs.myPos(),pathPlanner.getFirstStep());
+        Point2D diff = geometry->getDifferenceToPoint(obs.myPos(),pathPlanner.getFirstStep());
         prevAction = getAction(diff);
         //std::cout << "following plan: " << prevAction << " for " << obs<< std::endl;
       } // else, go with the uct chosen action
@@ -128,10 +140,45 @@ ActionProbs PredatorMCTS::step(const Observation &obs) {
   return ActionProbs(prevAction);
 }
 
+PredatorMCTS::~PredatorMCTS() {
+  saveProfile(); // the last episode
+}
+
 void PredatorMCTS::restart() {
   // only necessary for determining types
   //planner->restart();
   prevAction = Action::NUM_MOVES;
+  saveProfile();
+}
+
+void PredatorMCTS::setProfileOutput(const std::string &filename, unsigned int trialNum) {
+  profileFilename = filename;
+  profileTrial = trialNum;
+  profileEpisode = 0;
+  planner->resetProfile();
+}
+
+void PredatorMCTS::saveProfile() {
+  // nothing to save before the first episode
+  if ((profileFilename == "") || (planner->getProfile().getNumPlayouts() == 0))
+    return;
+  Json::Value profile = planner->getProfile().toJson();
+  profile["trial"] = profileTrial;
+  profile["episode"] = profileEpisode;
+  Json::FastWriter writer;
+  std::string line = writer.write(profile); // ends with a newline
+  {
+    // whole lines, but parallel trials' lines are in whatever order they finish
+    boost::mutex::scoped_lock lock(profileFileMutex);
+    std::ofstream out(profileFilename.c_str(),std::ios_base::app);
+    if (!out.good())
+      std::cerr << "PredatorMCTS: WARNING, can't open profile file: " << profileFilename << std::endl;
+    else
+      out << line;
+    out.close();
+  }
+  planner->resetProfile();
+  profileEpisode++;
 }
 
 std::string PredatorMCTS::generateDescription() {
@@ -6,7 +6,7 @@ File: PredatorMCTS.h
 Author: Samuel Barrett
 Description: a predator that uses MCTS to evaluate actions
 Created:  2011-08-23
-Modified: 2011-08-23
+Modified: 2013-08-19
 */
 
 #include <boost/shared_ptr.hpp>
@@ -30,16 +30,24 @@ public:
 
 public:
   PredatorMCTS(boost::shared_ptr<RNG> rng, const Point2D &dims, boost::shared_ptr<MCTS<State_t,Action::Type> > planner, boost::shared_ptr<ModelUpdater> modelUpdater, boost::shared_ptr<QuandryDetector> quandryDetector, const Params &p);
+  ~PredatorMCTS();
 
   ActionProbs step(const Observation &obs);
   void restart();
   std::string generateDescription();
   std::string generateLongDescription(unsigned int indentation = 0);
+  // appends the planner's profile to filename as a json line after each episode.
+  // With several trial threads the lines are interleaved in no fixed order, so
+  // use their trial and episode fields rather than their position
+  void setProfileOutput(const std::string &filename, unsigned int trialNum);
 
   PredatorMCTS* clone() {
     assert(false); // don't do this
     return new PredatorMCTS(*this);
   }
+  bool canStepInParallel() const {
+    return false; // the planner would be shared
+  }
 
 protected:
   boost::shared_ptr<MCTS<State_t,Action::Type> > planner;
@@ -52,7 +60,14 @@ protected:
   Point2D target;
   AStar pathPlanner;
 
+  std::string profileFilename;
+  unsigned int profileTrial;
+  unsigned int profileEpisode;
+
   Params p;
+
+protected:
+  void saveProfile();
 };
 
 #endif /* end of include guard: PREDATORMCTS_ERF6V5UK */
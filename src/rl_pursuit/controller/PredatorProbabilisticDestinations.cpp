@@ -17,11 +17,11 @@ PredatorProbabilisticDestinations::PredatorProbabilisticDestinations(boost::shar
 ActionProbs PredatorProbabilisticDestinations::step(const Observation &obs) {
   actionProbs.reset();
 
-  unsigned int distanceToPrey = getDistanceToPoint(dims,obs.myPos(),obs.preyPos());
+  unsigned int distanceToPrey = geometry->getDistanceToPoint(obs.myPos(),obs.preyPos());
 
   if (distanceToPrey == 1) {
     // if right next to the prey, move onto it
-    Action::Type action = getAction(getDifferenceToPoint(dims,obs.myPos(),obs.preyPos()));
+    Action::Type action = getAction(geometry->getDifferenceToPoint(obs.myPos(),obs.preyPos()));
     return ActionProbs(action);
   }
 
@@ -55,14 +55,14 @@ void PredatorProbabilisticDestinations::setDestinationsForDistance(const Observa
   Point2D diff(dist,0);
   Point2D change(-1,1); // keeps us on the diamond
   while (diff.x > -dist) {
-    destinations.push_back(movePosition(dims,obs.preyPos(),diff));
+    destinations.push_back(geometry->movePosition(obs.preyPos(),diff));
     if (diff.y == dist)
       change.y *= -1;
     diff += change;
   }
   change.x *= -1;
   while (diff.x < dist) {
-    destinations.push_back(movePosition(dims,obs.preyPos(),diff));
+    destinations.push_back(geometry->movePosition(obs.preyPos(),diff));
     if (diff.y == -dist)
       change.y *= -1;
     diff += change;
@@ -81,7 +81,7 @@ void PredatorProbabilisticDestinations::evaluateDestinations(const Observation &
     // if the destination is occupied, don't choose it
     if (obs.getCollision(destinations[i]) >= 0)
       continue;
-    diff = getDifferenceToPoint(dims,obs.myPos(),destinations[i]);
+    diff = geometry->getDifferenceToPoint(obs.myPos(),destinations[i]);
     if (abs(diff.x) > abs(diff.y)) {
       chosenMove.x = sgn(diff.x);
       chosenMove.y = 0;
@@ -90,7 +90,7 @@ void PredatorProbabilisticDestinations::evaluateDestinations(const Observation &
       chosenMove.y = sgn(diff.y);
     }
     // check if the next position is occupied, if it is, don't choose it
-    nextPos = movePosition(dims,obs.myPos(),chosenMove);
+    nextPos = geometry->movePosition(obs.myPos(),chosenMove);
     assert(nextPos != obs.myPos()); // really shouldn't happen
     if (obs.getCollision(nextPos) >= 0)
       continue;
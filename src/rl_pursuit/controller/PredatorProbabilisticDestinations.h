@@ -24,6 +24,14 @@ public:
     return new PredatorProbabilisticDestinations(*this);
   }
 
+  bool copyStepState(const Agent &) {
+    return true; // step doesn't keep any state
+  }
+
+  bool isStepCacheable() const {
+    return true;
+  }
+
 private:
   void setDistanceProbs(unsigned distanceToPrey);
   void setDestinationsForDistance(const Observation &obs, int dist);
@@ -30,7 +30,7 @@ ActionProbs PredatorSurround::step(const Observation &obs) {
   avoidLocations = obs.positions; // reset the avoid locations to the current positions of agents
   // don't get too close to the prey
   for (unsigned int i = 0; i < Action::NUM_NEIGHBORS; i++) 
-    avoidLocations.push_back(movePosition(dims,obs.preyPos(),(Action::Type)i));
+    avoidLocations.push_back(geometry->movePosition(obs.preyPos(),(Action::Type)i));
   // get the capture mode
   setCaptureMode(obs);
   if (isStuck)
@@ -76,7 +76,7 @@ Point2D PredatorSurround::getMoveToPoint(const Point2D &start, const Point2D &en
       foundMove = false;
       return Point2D(0,0);
     }
-    diff = getDifferenceToPoint(dims,start,planner.getFirstStep());
+    diff = geometry->getDifferenceToPoint(start,planner.getFirstStep());
   }
   foundMove = true;
   return diff;
@@ -86,7 +86,7 @@ Point2D PredatorSurround::getDesiredPosition(const Observation &obs) {
   assert(obs.preyInd == 0);
 
   if (captureMode) {
-    return getGreedyDesiredPosition(dims,obs);
+    return getGreedyDesiredPosition(*geometry,obs);
   } else {
     // get the desired destination
     assignDesiredDests(obs);
@@ -114,7 +114,7 @@ void PredatorSurround::setCaptureMode(const Observation &obs) {
   for (unsigned int i = 0; i < obs.positions.size(); i++) {
     if ((int)i == obs.preyInd)
       continue;
-    dist = getDistanceToPoint(dims,obs.positions[i],obs.preyPos());
+    dist = geometry->getDistanceToPoint(obs.positions[i],obs.preyPos());
     if (dist > captureDist) {
       captureMode = false;
       return;
@@ -134,9 +134,9 @@ void PredatorSurround::assignDesiredDests(const Observation &obs) {
   
   // get the possible destinations and the dists to the predators
   for (int destInd = 0; destInd < NUM_DESTS; destInd++) {
-    possibleDests[destInd] = movePosition(dims,obs.preyPos(),2 * Action::MOVES[destInd]);
+    possibleDests[destInd] = geometry->movePosition(obs.preyPos(),2 * Action::MOVES[destInd]);
     for (int pred = 0; pred < NUM_PREDATORS; pred++) {
-      distances[pred][destInd] = getDistanceToPoint(dims,obs.positions[pred + 1],possibleDests[destInd]); // +1 because prey is in position 0
+      distances[pred][destInd] = geometry->getDistanceToPoint(obs.positions[pred + 1],possibleDests[destInd]); // +1 because prey is in position 0
     }
   }
 
@@ -174,7 +174,7 @@ void PredatorSurround::assignDesiredDests(const Observation &obs) {
 
   // don't move if you're next to the prey
   for (int i = 0; i < NUM_DESTS; i++) {
-    if (getDistanceToPoint(dims,obs.preyPos(),obs.positions[i+1]) == 1)
+    if (geometry->getDistanceToPoint(obs.preyPos(),obs.positions[i+1]) == 1)
       destAssignments[i] = obs.positions[i+1]; // +1 because prey is 0
   }
 }
@@ -40,7 +40,7 @@ protected:
   bool captureMode;
   bool assignedDestsQ;
   Point2D destAssignments[NUM_PREDATORS];
-  std::vector<Point2D> avoidLocations;
+  PositionList avoidLocations;
   Observation prevObs;
   Observation prevPrevObs;
 };
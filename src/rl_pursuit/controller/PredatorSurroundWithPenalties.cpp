@@ -66,8 +66,8 @@ void PredatorSurroundWithPenalties::setPenaltyMode(const Observation &obs) {
         //continue;
       if (expectedMoves[i] == Action::NUM_ACTIONS)
         continue; // wasn't sure what that guy was going to do
-      Point2D move = getDifferenceToPoint(dims,prevObs.positions[i+1],obs.positions[i+1]);
-      Point2D desiredPosition = movePosition(dims,prevObs.positions[i+1],expectedMoves[i]);
+      Point2D move = geometry->getDifferenceToPoint(prevObs.positions[i+1],obs.positions[i+1]);
+      Point2D desiredPosition = geometry->movePosition(prevObs.positions[i+1],expectedMoves[i]);
       bool desiredPositionOccupied = false;
       for (unsigned int j = 0; j < obs.positions.size(); j++) {
         if ((desiredPosition == obs.positions[j]) || (desiredPosition == prevObs.positions[j])){
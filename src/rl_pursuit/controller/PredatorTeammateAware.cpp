@@ -3,7 +3,7 @@ File: PredatorTeammateAware.cpp
 Author: Samuel Barrett
 Description: a teammate aware predator - lets the farthest away predators select their destination first, then runs A* to reach the destination
 Created:  2011-08-31
-Modified: 2011-08-31
+Modified: 2013-08-19
 */
 
 #include "PredatorTeammateAware.h"
@@ -23,65 +23,68 @@ std::string PredatorTeammateAware::generateDescription() {
 }
 
 ActionProbs PredatorTeammateAware::step(const Observation &obs) {
-  Point2D dest = getTeammateAwareDesiredPosition(dims,obs);
+  Point2D dest = getTeammateAwareDesiredPosition(*geometry,obs);
   planner.plan(obs.myPos(),dest,obs.positions);
   if (!planner.foundPath()) {
     //std::cout << "NO PATH FOUND, moving randomly: " << obs << " " << dest << std::endl;
     return ActionProbs(Action::RANDOM);
   }
-  Point2D diff = getDifferenceToPoint(dims,obs.myPos(),planner.getFirstStep());
+  Point2D diff = geometry->getDifferenceToPoint(obs.myPos(),planner.getFirstStep());
   return ActionProbs(getAction(diff));
 }
 
-Point2D getTeammateAwareDesiredPosition(const Point2D &dims, const Observation &obs) {
-  Point2D dests[NUM_PREDATORS];
-  assignTeammateAwareDesiredDests(dims,obs,dests,true,true,1);
+Point2D getTeammateAwareDesiredPosition(const Geometry &geometry, const Observation &obs) {
+  PositionList dests;
+  assignTeammateAwareDesiredDests(geometry,obs,dests,true,true,1);
   //std::cout << obs << std::endl;
   //std::cout << "MY DEST: " << dests[obs.myInd + 1] << std::endl;
   //std::cout << "DESTS: " << dests[0] << " " << dests[1] << " " << dests[2] << " " << dests[3] << std::endl;
   return dests[obs.myInd - 1]; // -1 because prey is 0
 }
 
-void assignTeammateAwareDesiredDests(const Point2D &dims, const Observation &obs, Point2D dests[NUM_PREDATORS], bool stopAfterAssigningCurrentPred, bool moveOntoPreyIfAtDest, int distFactor) {
+static inline void findClosestDest(const int *distances, int &minDist, unsigned int &minInd) {
+  minDist = 999999;
+  minInd = 0;
+  for (unsigned int destInd = 0; destInd < NUM_DESTS; destInd++) {
+    if (distances[destInd] < minDist) {
+      minDist = distances[destInd];
+      minInd = destInd;
+    }
+  }
+}
+
+void assignTeammateAwareDesiredDests(const Geometry &geometry, const Observation &obs, PositionList &dests, bool stopAfterAssigningCurrentPred, bool moveOntoPreyIfAtDest, int distFactor) {
   // FIXME assuming prey is in position 0
   assert(obs.preyInd == 0);
-  // FIXME assuming 4 predators and 1 prey
-  assert(obs.positions.size() == NUM_PREDATORS + 1);
+  assert(obs.positions.size() > 1);
+  const unsigned int numPredators = obs.positions.size() - 1;
+  dests.resize(numPredators);
 
   // check how far each predator is to each surrounding spot
-  int distances[NUM_PREDATORS][NUM_DESTS];
+  SmallVector<int,MAX_INLINE_AGENTS * NUM_DESTS> distances(numPredators * NUM_DESTS); // [pred * NUM_DESTS + dest]
   Point2D possibleDests[NUM_DESTS];
-  int minDists[NUM_PREDATORS];
-  unsigned int minInds[NUM_PREDATORS];
-  for (unsigned int pred = 0; pred < NUM_PREDATORS; pred++) {
-    minDists[pred] = 999999;
-    minInds[pred] = 0;
-  }
-  
+  SmallVector<int,MAX_INLINE_AGENTS> minDists(numPredators);
+  SmallVector<unsigned int,MAX_INLINE_AGENTS> minInds(numPredators);
 
-  Point2D dest;
-  for (unsigned int destInd = 0; destInd < NUM_DESTS; destInd++) {
-    dest = movePosition(dims,obs.preyPos(),distFactor * Action::MOVES[destInd]);
-    possibleDests[destInd] = dest;
-    for (unsigned int pred = 0; pred < NUM_PREDATORS; pred++) {
-      distances[pred][destInd] = getDistanceToPoint(dims,obs.positions[pred + 1],dest); // +1 because prey is in position 0
-      if (distances[pred][destInd] < minDists[pred]) {
-        minDists[pred] = distances[pred][destInd];
-        minInds[pred] = destInd;
-      }
-    }
+  for (unsigned int destInd = 0; destInd < NUM_DESTS; destInd++)
+    possibleDests[destInd] = geometry.movePosition(obs.preyPos(),distFactor * Action::MOVES[destInd]);
+  for (unsigned int pred = 0; pred < numPredators; pred++) {
+    for (unsigned int destInd = 0; destInd < NUM_DESTS; destInd++)
+      distances[pred * NUM_DESTS + destInd] = geometry.getDistanceToPoint(obs.positions[pred + 1],possibleDests[destInd]); // +1 because prey is in position 0
+    findClosestDest(&distances[pred * NUM_DESTS],minDists[pred],minInds[pred]);
   }
   
   int maxDist;
   unsigned int maxDistPred = 0;
   unsigned int chosenDest = 0;
+  unsigned int numAssigned = 0;
   //std::cout << obs << std::endl;
   //while(true) {
-  for (int numUnassignedPreds = NUM_PREDATORS; numUnassignedPreds > 0; numUnassignedPreds--) {
+  for (int numUnassignedPreds = numPredators; numUnassignedPreds > 0; numUnassignedPreds--) {
     // get which predator is the farthest from the points
     //std::cout << "minDists: ";
     maxDist = -1;
-    for (unsigned int pred = 0; pred < NUM_PREDATORS; pred++) {
+    for (unsigned int pred = 0; pred < numPredators; pred++) {
       //std::cout << minDists[pred] << " ";
       if (minDists[pred] > maxDist) {
         maxDist = minDists[pred];
@@ -107,20 +110,23 @@ void assignTeammateAwareDesiredDests(const Point2D &dims, const Observation &obs
     
     // make it clear this predator has chosen
     minDists[maxDistPred] = -1;
+    numAssigned++;
+    bool allDestsTaken = (numAssigned % NUM_DESTS == 0);
     // remove this option for the other predators
-    for (unsigned int pred = 0; pred < NUM_PREDATORS; pred++) {
+    for (unsigned int pred = 0; pred < numPredators; pred++) {
       if (minDists[pred] < 0)
         continue;
-      distances[pred][chosenDest] = 999999;
-      if (minInds[pred] == chosenDest) {
-        minDists[pred] = 999999;
-        for (unsigned int neighbor = 0; neighbor < NUM_DESTS; neighbor++) {
-          if (distances[pred][neighbor] < minDists[pred]) {
-            minDists[pred] = distances[pred][neighbor];
-            minInds[pred] = neighbor;
-          }
-        }
+      int *predDistances = &distances[pred * NUM_DESTS];
+      if (allDestsTaken) {
+        // the predators that are left line up behind the others
+        for (unsigned int destInd = 0; destInd < NUM_DESTS; destInd++)
+          predDistances[destInd] = geometry.getDistanceToPoint(obs.positions[pred + 1],possibleDests[destInd]);
+        findClosestDest(predDistances,minDists[pred],minInds[pred]);
+        continue;
       }
+      predDistances[chosenDest] = 999999;
+      if (minInds[pred] == chosenDest)
+        findClosestDest(predDistances,minDists[pred],minInds[pred]);
     } // end for pred
   } // end while
 }
@@ -6,17 +6,18 @@ File: PredatorTeammateAware.h
 Author: Samuel Barrett
 Description: a teammate aware predator - lets the farthest away predators select their destination first, then runs A* to reach the destination
 Created:  2011-08-31
-Modified: 2011-08-31
+Modified: 2013-08-19
 */
 
 #include "Agent.h"
 #include "AStar.h"
 
-const unsigned int NUM_PREDATORS = 4;
 const unsigned int NUM_DESTS = Action::NUM_NEIGHBORS;
 
-Point2D getTeammateAwareDesiredPosition(const Point2D &dims, const Observation &obs);
-void assignTeammateAwareDesiredDests(const Point2D &dims, const Observation &obs, Point2D dests[NUM_PREDATORS], bool stopAfterAssigningCurrentPred, bool moveOntoPreyIfAtDest, int distFactor = 1);
+Point2D getTeammateAwareDesiredPosition(const Geometry &geometry, const Observation &obs);
+// dests gets one entry per predator. With more predators than dests, the
+// dests are offered again to the ones left once they've all been taken
+void assignTeammateAwareDesiredDests(const Geometry &geometry, const Observation &obs, PositionList &dests, bool stopAfterAssigningCurrentPred, bool moveOntoPreyIfAtDest, int distFactor = 1);
 
 class PredatorTeammateAware: public Agent {
 public:
@@ -29,6 +30,14 @@ public:
     return new PredatorTeammateAware(*this);
   }
 
+  bool copyStepState(const Agent &) {
+    return true; // step doesn't keep any state
+  }
+
+  bool isStepCacheable() const {
+    return true;
+  }
+
 private:
   AStar planner;
 };
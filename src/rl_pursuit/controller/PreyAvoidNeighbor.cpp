@@ -70,7 +70,7 @@ void PreyAvoidNeighbor::getNeighborMoves(const Observation &obs, std::vector<Poi
   Point2D pos;
   bool occupied;
   for (unsigned int i = 0; i < Action::NUM_NEIGHBORS; i++) {
-    pos = movePosition(dims,obs.myPos(),(Action::Type)i);
+    pos = geometry->movePosition(obs.myPos(),(Action::Type)i);
     occupied = false;
     for (unsigned int j = 0; j < obs.positions.size(); j++) {
       if (obs.positions[j] == pos) {
@@ -21,6 +21,14 @@ public:
     return new PreyAvoidNeighbor(*this);
   }
 
+  bool copyStepState(const Agent &) {
+    return true; // step doesn't keep any state
+  }
+
+  bool isStepCacheable() const {
+    return true;
+  }
+
 private:
   void getNeighborMoves(const Observation &obs, std::vector<Point2D> &neighborMoves);
   ActionProbs moveWithNoNeighbors();
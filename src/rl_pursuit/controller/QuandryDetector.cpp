@@ -2,6 +2,7 @@
 
 QuandryDetector::QuandryDetector(const Point2D &dims, const Params &p):
   dims(dims),
+  geometry(Geometry::get(dims)),
   p(p),
   history(p.historySize + 1) // +1 because one for the current
 {
@@ -11,7 +12,7 @@ bool QuandryDetector::detect(const Observation &obs) {
   //std::cout << "new obs: " << obs << std::endl;
   history.push_back(obs);
   Observation &current = history.back();
-  current.centerPrey(dims);
+  current.centerPrey(*geometry);
   //std::cout << "post center obs: " << current << std::endl;
   // not stuck if we just started
   if (history.size() < p.historySize + 1) { // not until we have a full history
@@ -25,7 +26,7 @@ bool QuandryDetector::detect(const Observation &obs) {
     for (unsigned int i = 0; i < current.positions.size(); i++) {
       if (i == obs.myInd)
         continue;
-      unsigned int dist = getDistanceToPoint(dims,history[historyInd].positions[i],current.positions[i]);
+      unsigned int dist = geometry->getDistanceToPoint(history[historyInd].positions[i],current.positions[i]);
       if (dist >= p.notStuckDistMoved) {
         //std::cout << "not stuck " << historyInd << "/" << history.size() << " " << i << " - " << history[historyInd].positions[i] << " " << current.positions[i] << std::endl;
         return false;
@@ -3,6 +3,7 @@
 
 #include <boost/circular_buffer.hpp>
 #include <rl_pursuit/model/Common.h>
+#include <rl_pursuit/model/Geometry.h>
 #include <rl_pursuit/common/Params.h>
 
 class QuandryDetector {
@@ -21,6 +22,7 @@ public:
 
 protected:
   Point2D dims;
+  boost::shared_ptr<const Geometry> geometry;
   Params p;
 
   boost::circular_buffer<Observation> history;
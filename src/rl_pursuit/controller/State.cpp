@@ -3,11 +3,12 @@ File: State.h
 Author: Samuel Barrett
 Description: State for planning
 Created:  2011-09-21
-Modified: 2011-09-21
+Modified: 2013-08-19
 */
 
 #include "State.h"
 #include <iostream>
+#include <limits>
 #include <boost/lexical_cast.hpp>
 #include <rl_pursuit/common/Util.h>
 
@@ -62,6 +63,25 @@ std::size_t hash_value(const State &s) {
 }
 */
 
+bool isStatePackedExactly(const Point2D &dims, unsigned int numAgents, bool usePreySymmetry) {
+  const uint64_t numCells = dims.x * dims.y;
+  unsigned int numPacked = numAgents;
+  if (usePreySymmetry && (numPacked > 0))
+    numPacked--;
+  uint64_t numStates = 1;
+  for (unsigned int i = 0; i < numPacked; i++) {
+    if (numStates > std::numeric_limits<uint64_t>::max() / numCells)
+      return false;
+    numStates *= numCells;
+  }
+  return true;
+}
+
+static inline State_t hashPosition(State_t state, const Point2D &pos) {
+  state ^= (uint64_t)(pos.y * 65536 + pos.x) + 0x9E3779B97F4A7C15ULL + (state << 6) + (state >> 2);
+  return state;
+}
+
 State_t getStateFromObs(const Point2D &dims, const Observation &obs, bool usePreySymmetry) {
   State_t state = 0;
   Point2D pos;
@@ -74,6 +94,15 @@ State_t getStateFromObs(const Point2D &dims, const Observation &obs, bool usePre
     endInd = 1;
   }
 
+  if (!isStatePackedExactly(dims,obs.positions.size(),usePreySymmetry)) {
+    for (int i = ((int)obs.positions.size())-1; i >= endInd; i--)
+      state = hashPosition(state,movePosition(dims,obs.positions[i],offset));
+    // finish with the splitmix64 mixer, the planner's tables only hash with a multiply
+    state = (state ^ (state >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    state = (state ^ (state >> 27)) * 0x94D049BB133111EBULL;
+    return state ^ (state >> 31);
+  }
+
   for (int i = ((int)obs.positions.size())-1; i >= endInd; i--) {
     pos = obs.positions[i];
     pos = movePosition(dims,pos,offset);
@@ -85,13 +114,13 @@ State_t getStateFromObs(const Point2D &dims, const Observation &obs, bool usePre
   return state;
 }
 
-void getPositionsFromState(State_t state, const Point2D &dims, std::vector<Point2D> &positions, bool usePreySymmetry) {
+void getPositionsFromState(State_t state, const Point2D &dims, PositionList &positions, bool usePreySymmetry) {
   // first agent is in center
   //positions[0] = 0.5f * dims;
   getPositionsFromState(state,dims,positions,0.5f * dims, usePreySymmetry);
 }
 
-void getPositionsFromState(State_t state, const Point2D &dims, std::vector<Point2D> &positions, const Point2D &preyPos, bool usePreySymmetry) {
+void getPositionsFromState(State_t state, const Point2D &dims, PositionList &positions, const Point2D &preyPos, bool usePreySymmetry) {
   State_t origState(state);
   Point2D offset(0,0);
   int startInd = 0;
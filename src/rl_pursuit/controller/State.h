@@ -6,17 +6,29 @@ File: State.h
 Author: Samuel Barrett
 Description: State for planning
 Created:  2011-09-21
-Modified: 2011-09-21
+Modified: 2013-08-19
 */
 
 #include <rl_pursuit/common/Point2D.h>
 #include <rl_pursuit/model/Common.h>
+#include <rl_pursuit/planning/UCTNodeTable.h>
 
 const unsigned int STATE_SIZE = 5;
 typedef uint64_t State_t;
+
+// lets the UCTEstimator store the action stats inline
+template<>
+struct NumDenseActions<Action::Type> {
+  static const unsigned int value = Action::NUM_ACTIONS;
+};
+
+// the positions are packed exactly into a State_t when every arrangement of
+// the agents fits in 64 bits. Otherwise, as with many agents on large grids,
+// the state is a hash of the positions, and it can't be unpacked
+bool isStatePackedExactly(const Point2D &dims, unsigned int numAgents, bool usePreySymmetry);
 State_t getStateFromObs(const Point2D &dims, const Observation &obs, bool usePreySymmetry);
-void getPositionsFromState(State_t state, const Point2D &dims, std::vector<Point2D> &positions, bool usePreySymmetry);
-void getPositionsFromState(State_t state, const Point2D &dims, std::vector<Point2D> &positions, const Point2D &preyPos, bool usePreySymmetry);
+void getPositionsFromState(State_t state, const Point2D &dims, PositionList &positions, bool usePreySymmetry);
+void getPositionsFromState(State_t state, const Point2D &dims, PositionList &positions, const Point2D &preyPos, bool usePreySymmetry);
 
 class StateConverter {
 public:
@@ -0,0 +1,122 @@
+/*
+File: SymmetricStateMapping.cpp
+Author: Samuel Barrett
+Description: maps planning states to a canonical state shared by all the
+  states that are the same up to a symmetry
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include "SymmetricStateMapping.h"
+#include <algorithm>
+#include <iostream>
+#include <boost/lexical_cast.hpp>
+#include <rl_pursuit/common/Util.h>
+
+static inline Point2D transformMove(Point2D move, unsigned int transform) {
+  if (transform & SymmetricStateMapping::TRANSPOSE)
+    std::swap(move.x,move.y);
+  if (transform & SymmetricStateMapping::FLIP_X)
+    move.x = -move.x;
+  if (transform & SymmetricStateMapping::FLIP_Y)
+    move.y = -move.y;
+  return move;
+}
+
+static inline bool cellLess(const Point2D &a, const Point2D &b) {
+  return (a.y < b.y) || ((a.y == b.y) && (a.x < b.x));
+}
+
+SymmetricStateMapping::SymmetricStateMapping(const Point2D &dims, unsigned int numAgents, int adhocInd, bool usePreySymmetry, bool useGeometry, bool interchangeableTeammates):
+  dims(dims),
+  center(0.5f * dims),
+  numAgents(numAgents),
+  adhocInd(adhocInd),
+  interchangeableTeammates(interchangeableTeammates)
+{
+  // the states are unpacked to find their symmetric states, and the
+  // symmetries are about the prey
+  if (!usePreySymmetry || !isStatePackedExactly(dims,numAgents,usePreySymmetry)) {
+    std::cerr << "SymmetricStateMapping: ERROR, symmetric states need the prey at the center and states that are packed exactly" << std::endl;
+    exit(67);
+  }
+
+  for (Transform transform = IDENTITY; transform < NUM_TRANSFORMS; transform++) {
+    if ((transform != IDENTITY) && !useGeometry)
+      continue;
+    // rotations only take square grids to themselves
+    if ((transform & TRANSPOSE) && (dims.x != dims.y))
+      continue;
+    transforms.push_back(transform);
+  }
+
+  for (Transform transform = IDENTITY; transform < NUM_TRANSFORMS; transform++) {
+    for (unsigned int i = 0; i < Action::NUM_ACTIONS; i++) {
+      Action::Type action = (Action::Type)i;
+      Action::Type mapped = getAction(transformMove(Action::MOVES[action],transform));
+      actions[transform][action] = mapped;
+      inverseActions[transform][mapped] = action;
+    }
+  }
+}
+
+SymmetricStateMapping::Transform SymmetricStateMapping::map(State_t &state) {
+  PositionList positions(numAgents);
+  getPositionsFromState(state,dims,positions,true);
+
+  Transform bestTransform = IDENTITY;
+  State_t bestState = 0;
+  for (unsigned int i = 0; i < transforms.size(); i++) {
+    State_t transformedState = getTransformedState(positions,transforms[i]);
+    if ((i == 0) || (transformedState < bestState)) {
+      bestState = transformedState;
+      bestTransform = transforms[i];
+    }
+  }
+  state = bestState;
+  return bestTransform;
+}
+
+Action::Type SymmetricStateMapping::mapAction(const Action::Type &action, Transform transform) {
+  return actions[transform][action];
+}
+
+Action::Type SymmetricStateMapping::unmapAction(const Action::Type &action, Transform transform) {
+  return inverseActions[transform][action];
+}
+
+Point2D SymmetricStateMapping::transformPosition(const Point2D &pos, Transform transform) const {
+  return movePosition(dims,center,transformMove(getDifferenceToPoint(dims,center,pos),transform));
+}
+
+State_t SymmetricStateMapping::getTransformedState(const PositionList &positions, Transform transform) const {
+  Observation obs;
+  obs.preyInd = 0;
+  obs.positions.resize(numAgents);
+  obs.positions[0] = center;
+  for (unsigned int i = 1; i < numAgents; i++)
+    obs.positions[i] = transformPosition(positions[i],transform);
+
+  if (interchangeableTeammates) {
+    // sort the teammates' positions around the ad hoc agent's
+    PositionList teammates;
+    for (unsigned int i = 1; i < numAgents; i++) {
+      if ((int)i != adhocInd)
+        teammates.push_back(obs.positions[i]);
+    }
+    std::sort(teammates.begin(),teammates.end(),cellLess);
+    unsigned int teammateInd = 0;
+    for (unsigned int i = 1; i < numAgents; i++) {
+      if ((int)i != adhocInd)
+        obs.positions[i] = teammates[teammateInd++];
+    }
+  }
+  return getStateFromObs(dims,obs,true);
+}
+
+std::string SymmetricStateMapping::generateDescription(unsigned int indentation) {
+  std::string msg = indent(indentation) + "SymmetricStateMapping: " + boost::lexical_cast<std::string>(transforms.size()) + " transforms";
+  if (interchangeableTeammates)
+    msg += ", interchangeable teammates";
+  return msg;
+}
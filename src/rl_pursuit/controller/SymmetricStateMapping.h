@@ -0,0 +1,56 @@
+#ifndef SYMMETRICSTATEMAPPING_K3PQW8ZD
+#define SYMMETRICSTATEMAPPING_K3PQW8ZD
+
+/*
+File: SymmetricStateMapping.h
+Author: Samuel Barrett
+Description: maps planning states to a canonical state shared by all the
+  states that are the same up to a symmetry, so the planner shares their
+  statistics. With the prey at the center, the torus looks the same after
+  reflecting it about the prey, or on square grids after rotating it, and
+  the actions are reflected and rotated along with it. When the teammates
+  are interchangeable, their order doesn't matter either, but the ad hoc
+  agent always keeps its index. The canonical state is the smallest of the
+  symmetric states, preferring no transform on ties.
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <string>
+#include <vector>
+#include <rl_pursuit/controller/State.h>
+#include <rl_pursuit/planning/StateMapping.h>
+
+class SymmetricStateMapping: public StateMapping<State_t,Action::Type> {
+public:
+  enum {
+    FLIP_X = 1,
+    FLIP_Y = 2,
+    TRANSPOSE = 4, // applied before the flips
+    NUM_TRANSFORMS = 8
+  };
+
+  SymmetricStateMapping(const Point2D &dims, unsigned int numAgents, int adhocInd, bool usePreySymmetry, bool useGeometry, bool interchangeableTeammates);
+  virtual ~SymmetricStateMapping() {}
+
+  virtual Transform map(State_t &state);
+  virtual Action::Type mapAction(const Action::Type &action, Transform transform);
+  virtual Action::Type unmapAction(const Action::Type &action, Transform transform);
+  Point2D transformPosition(const Point2D &pos, Transform transform) const;
+  std::string generateDescription(unsigned int indentation = 0);
+
+private:
+  State_t getTransformedState(const PositionList &positions, Transform transform) const;
+
+private:
+  Point2D dims;
+  Point2D center;
+  unsigned int numAgents;
+  int adhocInd;
+  bool interchangeableTeammates;
+  std::vector<Transform> transforms;
+  Action::Type actions[NUM_TRANSFORMS][Action::NUM_ACTIONS];
+  Action::Type inverseActions[NUM_TRANSFORMS][Action::NUM_ACTIONS];
+};
+
+#endif /* end of include guard: SYMMETRICSTATEMAPPING_K3PQW8ZD */
@@ -9,44 +9,15 @@
 #define OUTPUT(x) ((void) 0)
 #endif
 
-/*
-bool ObservationComp::operator() (const Observation& lhs, const Observation& rhs) const {
-  if (lhs.positions.size() < rhs.positions.size())
-    return true;
-  else if (lhs.positions.size() > rhs.positions.size())
-    return false;
-  if (lhs.preyInd < rhs.preyInd)
-    return true;
-  else if (lhs.preyInd > rhs.preyInd)
-    return false;
-  for (unsigned int i = 0; i < lhs.positions.size(); i++) {
-    if (lhs.positions[i] < rhs.positions[i])
-      return true;
-    else if (rhs.positions[i] < lhs.positions[i])
-      return false;
-  }
-  return false;
-}
-
-std::size_t hash_value(const Observation &o) {
-  std::size_t seed = 0;
-  boost::hash_combine(seed,o.preyInd);
-  for (unsigned int i = 0; i < o.positions.size(); i++) {
-    boost::hash_combine(seed,o.positions[i].x);
-    boost::hash_combine(seed,o.positions[i].y);
-  }
-  return seed;
-}
-*/
 World::World(boost::shared_ptr<RNG> rng, boost::shared_ptr<WorldModel> world, double actionNoise, bool centerPrey):
   rng(rng),
   world(world),
   dims(world->getDims()),
+  geometry(Geometry::get(dims)),
   actionNoise(actionNoise),
-  centerPrey(centerPrey)
-  //cachingEnabled(false),
-  //uncachedAgentInd(-1),
-  //actionCache(new ActionCache())
+  centerPrey(centerPrey),
+  cacheSize(0),
+  exactOutcomes(dims)
 {
 }
 
@@ -54,22 +25,34 @@ void World::generateObservation(Observation &obs) {
   world->generateObservation(obs,centerPrey);
 }
 
+int World::getAgentInd(const boost::shared_ptr<Agent> &agent) const {
+  for (unsigned int i = 0; i < agents.size(); i++) {
+    if (agents[i] == agent)
+      return i;
+  }
+  return -1;
+}
+
 void World::step() {
-  std::vector<ActionProbs> actionProbList(agents.size());
-  step(boost::shared_ptr<std::vector<Action::Type> >(),actionProbList);
+  stepActionProbs.resize(agents.size());
+  step(NULL,stepActionProbs);
 }
   
 void World::step(boost::shared_ptr<std::vector<Action::Type> > actions) {
-  std::vector<ActionProbs> actionProbList(agents.size());
-  step(actions,actionProbList);
+  stepActionProbs.resize(agents.size());
+  step(actions.get(),stepActionProbs);
 }
 
 void World::step(boost::shared_ptr<std::vector<Action::Type> > actions, std::vector<ActionProbs> &actionProbList) {
+  step(actions.get(),actionProbList);
+}
+
+void World::step(std::vector<Action::Type> *actions, std::vector<ActionProbs> &actionProbList) {
   Action::Type action;
-  Observation obs;
-  std::vector<Point2D> requestedPositions(agents.size());
+  stepRequestedPositions.resize(agents.size());
   
-  generateObservation(obs);
+  // the agents all see the live observation, nothing moves until they've chosen
+  Observation &obs = world->getObservation(centerPrey);
 
   //std::vector<ActionProbs> actionProbList(agents.size());
   // get the agents actions if they weren't in the cache
@@ -87,39 +70,25 @@ void World::step(boost::shared_ptr<std::vector<Action::Type> > actions, std::vec
   // now select the actions from the probs
   for (unsigned int i = 0; i < agents.size(); i++) {
     action = actionProbList[i].selectAction(rng);
-    if (actions.get() != NULL)
+    if (actions != NULL)
       (*actions)[i] = action;
-    requestedPositions[i] = world->getAgentPosition(i,action);
+    stepRequestedPositions[i] = world->getAgentPosition(i,action);
   }
 
-  handleCollisions(requestedPositions);
+  handleCollisions(stepRequestedPositions);
   
   //std::cout << "STOP  WORLD STEP" << std::endl;
 }
-/*
-void World::setUncachedAgent(boost::shared_ptr<Agent> agent) {
-  for (unsigned int i = 0; i < agents.size(); i++) {
-    if (agents[i].get() == agent.get()) {
-      uncachedAgentInd = (int)i;
-      return;
-    }
-  }
-  assert(false);
-}
-*/
-void World::getPossibleOutcomesApprox(std::vector<AgentPtr> &agents, AgentPtr agentDummy, std::vector<std::vector<WorldStepOutcome> > &outcomesByAction) {
-  assert(false); // doesn't currently work correctly, assumes fixed ordering of agents
-  const double EPS = 0.01;
+void World::getPossibleOutcomes(std::vector<AgentPtr> &agents, AgentPtr agentDummy, std::vector<std::vector<WorldStepOutcome> > &outcomesByAction) {
   Observation obs;
   std::vector<ActionProbs> actionProbList(agents.size());
 
   // get the agents action distributions
   generateObservation(obs);
-  for (unsigned int i = 0; i < agents.size(); i++) {
+  for (unsigned int i = 0; i < agents.size(); i++)
     actionProbList[i] = getAgentAction(i,agents[i],obs);
-  }
 
-  // find the dummy agent if provided
+  // find the dummy agent
   int agentDummyInd = -1;
   for (unsigned int i = 0; i < agents.size(); i++) {
     if (agentDummy == agents[i]) {
@@ -129,94 +98,47 @@ void World::getPossibleOutcomesApprox(std::vector<AgentPtr> &agents, AgentPtr ag
   }
   assert(agentDummyInd != -1);
 
-  // calculate the probs
-  std::vector<WorldStepOutcome> outcomes(1);
-  outcomes[0].obs = obs;
-  outcomes[0].obs.uncenterPrey(dims);
-  outcomes[0].prob = 1.0;
-  //for (Action::Type dummyAction = (Action::Type)0; dummyAction <= Action::NUM_ACTIONS; dummyAction = Action::Type(dummyAction+1)) {
-  //}
-  for (unsigned int i = 0; i < agents.size(); i++) {
-    std::cout << i << std::endl;
-    std::vector<WorldStepOutcome> newOutcomes;
-    for (Action::Type a = Action::Type(0); a < Action::NUM_ACTIONS; a = Action::Type(a + 1)) {
-      std::cout << "  " << a << std::endl;
-      double actionProb;
-      if ((int)i == agentDummyInd) {
-        actionProb = 1.0;
-      } else {
-        actionProb = actionProbList[i][a];
-      }
-      if (actionProb < EPS)
-        continue;
-      for (unsigned int j = 0; j < outcomes.size(); j++) {
-        std::vector<Point2D> &positions = outcomes[j].obs.positions;
-        std::cout << "    considering outcome: " << outcomes[j].prob;
-        for (unsigned int k = 0; k < positions.size(); k++)
-          std::cout << " " << positions[k];
-        std::cout << std::endl;
-        Point2D pos = movePosition(dims,positions[i],a);
-        // check for collisions
-        bool collision = false;
-        for (unsigned int k = 0; k < positions.size(); k++) {
-          if (k == i)
-            continue;
-          if (positions[k] == pos) {
-            collision = true;
-            break;
-          }
-        } // end for k
-        WorldStepOutcome outcome(outcomes[j]);
-        outcome.prob *= actionProb;
-        if (outcome.prob < EPS)
-          continue;
-        if ((int)i == agentDummyInd) {
-          outcome.agentDummyAction = a;
-        }
-        if (!collision) {
-          outcome.obs.positions[i] = pos;
-        }
-        // check if this outcome already exists
-        bool outcomeExists = false;
-        for (unsigned int k = 0; k < newOutcomes.size(); k++) {
-          if ((newOutcomes[k].agentDummyAction == outcome.agentDummyAction) && (newOutcomes[k].obs == outcome.obs)) {
-            newOutcomes[k].prob += outcome.prob;
-            outcomeExists = true;
-            break;
-          }
-        }
-        if (!outcomeExists)
-          newOutcomes.push_back(outcome);
-        std::cout << "    adding outcome: " << newOutcomes.back().prob;
-        for (unsigned int k = 0; k < newOutcomes.back().obs.positions.size(); k++)
-          std::cout << " " << newOutcomes.back().obs.positions[k];
-        std::cout << std::endl;
-      }
-    }
-    std::cout << "setting outcomes" << std::endl;
-    outcomes = newOutcomes;
-  }
-  
-  // sort the resulting actions
-  std::cout << std::endl;
-  std::cout << "result:" << std::endl;
+  obs.uncenterPrey(*geometry);
+  std::vector<PositionOutcome> outcomes;
   outcomesByAction.clear();
   outcomesByAction.resize(Action::NUM_ACTIONS);
   for (unsigned int a = 0; a < Action::NUM_ACTIONS; a++) {
-    std::cout << a << std::endl;
+    // the dummy picks this action, but the noise still applies
+    ActionProbs &dummyProbs = actionProbList[agentDummyInd];
+    dummyProbs = ActionProbs((Action::Type)a);
+    if (actionNoise > 0)
+      dummyProbs.addNoise(actionNoise);
+    exactOutcomes.getOutcomes(obs.positions,actionProbList,outcomes);
+
     for (unsigned int i = 0; i < outcomes.size(); i++) {
-      if (outcomes[i].agentDummyAction == (int)a) {
-        outcomesByAction[a].push_back(outcomes[i]);
-        std::cout << "  " << outcomes[i].prob;
-        for (unsigned k = 0; k < outcomes[i].obs.positions.size(); k++)
-          std::cout << " " << outcomes[i].obs.positions[k];
-        std::cout << std::endl;
-      }
+      WorldStepOutcome outcome;
+      outcome.obs = obs;
+      outcome.obs.positions = outcomes[i].positions;
+      outcome.obs.absPrey = outcomes[i].positions[obs.preyInd];
+      if (centerPrey)
+        outcome.obs.centerPrey(*geometry);
+      outcome.prob = outcomes[i].prob;
+      outcome.agentDummyAction = (Action::Type)a;
+      outcomesByAction[a].push_back(outcome);
     }
   }
 }
 
 double World::getOutcomeProbApprox(Observation prevObs, const Observation &currentObs, std::vector<double> &agentProbs) { //, std::vector<boost::shared_ptr<Agent> > &agents) {
+  return getOutcomeProbApprox(prevObs,currentObs,agentProbs,NULL);
+}
+
+double World::getOutcomeLikelihood(const Observation &prevObs, const Observation &currentObs, int fixedInd, Action::Type fixedAction, std::vector<double> &agentProbs, bool exact) {
+  OutcomeQuery query;
+  query.fixedInd = fixedInd;
+  query.fixedAction = fixedAction;
+  if (exact)
+    return getOutcomeProb(prevObs,currentObs,agentProbs,&query);
+  else
+    return getOutcomeProbApprox(prevObs,currentObs,agentProbs,&query);
+}
+
+double World::getOutcomeProbApprox(Observation prevObs, const Observation &currentObs, std::vector<double> &agentProbs, const OutcomeQuery *query) {
   double modelProb = 1.0;
   ActionProbs actionProbs;
   Point2D requestedPosition;
@@ -227,12 +149,12 @@ double World::getOutcomeProbApprox(Observation prevObs, const Observation &curre
   Observation absCurrentObs(currentObs);
   // if the prey is centered, uncenter it for the absolute positions
   if (centerPrey) {
-    absPrevObs.uncenterPrey(dims);
-    absCurrentObs.uncenterPrey(dims);
+    absPrevObs.uncenterPrey(*geometry);
+    absCurrentObs.uncenterPrey(*geometry);
   }
 
   // if prey was captured last time, we need to handle it differently
-  bool prevCapture = absCurrentObs.didPreyMoveIllegally(dims,absPrevObs.absPrey);
+  bool prevCapture = absCurrentObs.didPreyMoveIllegally(*geometry,absPrevObs.absPrey);
   //std::cout << absPrevObs << std::endl;
   //std::cout << "prev capture: " << std::boolalpha << prevCapture << std::endl;
 
@@ -243,7 +165,7 @@ double World::getOutcomeProbApprox(Observation prevObs, const Observation &curre
       continue;
     //std::cout << "    agent: " << agentInd << std::endl;
 
-    actionProbs = getAgentAction(agentInd,agents[agentInd],prevObs);
+    actionProbs = getOutcomeAction(agentInd,prevObs,query);
     assert(actionProbs.checkTotal());
     //double agentProb = 0.0;
     double &agentProb = agentProbs[agentInd];
@@ -254,7 +176,7 @@ double World::getOutcomeProbApprox(Observation prevObs, const Observation &curre
         continue;
       //std::cout << "      " << Action::MOVES[action] << " " << prob << std::endl;
       // get the requestedPosition
-      requestedPosition = movePosition(dims,absPrevObs.positions[agentInd],(Action::Type)action);
+      requestedPosition = geometry->movePosition(absPrevObs.positions[agentInd],(Action::Type)action);
       //std::cout << "      req: " << absPrevObs.positions[agentInd] << "->" << requestedPosition << std::endl;
       
       // did the agent decide to stay still?
@@ -316,104 +238,38 @@ double World::getProbOfNoCollisionApprox(const Observation &prevObs, const Obser
   return probOfNoCollision;
 }
 
-double World::getOutcomeProb(Observation prevObs,const Observation &currentObs) {
-  assert(false); 
-  // DON'T USE THIS FUNCTION, it's currently buggy, not sure how so, but I don't trust it, drops some probs to 0 that I think it shouldn't
-  double modelProb = 0.0;
-  std::vector<ActionProbs> actionProbs(agents.size());
-  for (unsigned int i = 0; i < agents.size(); i++) {
-    actionProbs[i] = getAgentAction(i,agents[i],prevObs);
-    assert(actionProbs[i].checkTotal());
-  }
-  // get the number of orderings
-  unsigned int numOrderings = 1;
-  for (unsigned int i = 2; i < agents.size(); i++)
-    numOrderings *= i;
-
-  std::vector<unsigned int> actionInds(agents.size(),0);
-  std::vector<Point2D> requestedPositions(agents.size());
-  double prob;
-  bool resultingPositionsMatch;
-  // initial the agent order
-  std::vector<unsigned int> agentOrder(agents.size());
-  for (unsigned int i = 0; i < agents.size(); i++)
-    agentOrder[i] = i;
-
-  do { // loop through the possible actions
-    // set the current positions
-    for (unsigned int i = 0; i < agents.size(); i++)
-      world->setAgentPosition(i,prevObs.positions[i]);
-    // get the requested positions if the action probability is non-zero
-    if (!getRequestedPositionsForActionIndices(actionInds,actionProbs,requestedPositions))
-      continue;
-    //std::cout << "actionInds: ";
-    //for (unsigned int i = 0; i < agents.size(); i++)
-      //std::cout << actionInds[i] << " ";
-    //std::cout << std::endl;
-    do { // loop through the possible agent orderings
-      // set the current positions
-      for (unsigned int i = 0; i < agents.size(); i++)
-        world->setAgentPosition(i,prevObs.positions[i]);
-      //std::cout << "origPositions: ";
-      //for (unsigned int i = 0; i < agents.size(); i++)
-        //std::cout << world->getAgentPosition(i) << " ";
-      //std::cout << std::endl;
-      // handle collisions
-      handleCollisionsOrdered(requestedPositions,agentOrder);
-      // check the resulting positions
-      resultingPositionsMatch = true;
-      //std::cout << "resultingPositions: ";
-      //for (unsigned int i = 0; i < agents.size(); i++)
-        //std::cout << world->getAgentPosition(i) << " ";
-      //std::cout << std::endl;
-      //std::cout << "currentPositions: " << currentObs << std::endl;
-      for (unsigned int i = 0; i < agents.size(); i++) {
-        if (world->getAgentPosition(i) != currentObs.positions[i]) {
-          resultingPositionsMatch = false;
-          break;
-        }
-      }
-      if (!resultingPositionsMatch)
-        continue;
-      //std::cout << "RESULTING POSITIONS MATCH" << std::endl;
-      // increment the outcome probability
-      prob = 1.0;
-      for (unsigned int i = 0; i < agents.size(); i++)
-        prob *= actionProbs[i][(Action::Type)actionInds[i]];
-      modelProb += prob;
-    } while (std::next_permutation(agentOrder.begin(),agentOrder.end()));
-  } while (incrementActionIndices(actionInds));
-  return modelProb / numOrderings;
-}
-
-bool World::incrementActionIndices(std::vector<unsigned int> &actionInds) {
-  for (unsigned int i = 0; i < actionInds.size(); i++) {
-    actionInds[i]++;
-    if (actionInds[i] >= Action::NUM_ACTIONS) {
-      actionInds[i] = 0;
-    } else {
-      return true;
-    }
-  }
-  return false;
+double World::getOutcomeProb(Observation prevObs, const Observation &currentObs, std::vector<double> &agentProbs) {
+  return getOutcomeProb(prevObs,currentObs,agentProbs,NULL);
 }
-  
-bool World::getRequestedPositionsForActionIndices(const std::vector<unsigned int> &actionInds, const std::vector<ActionProbs> &actionProbs, std::vector<Point2D> &requestedPositions) {
+
+double World::getOutcomeProb(Observation prevObs, const Observation &currentObs, std::vector<double> &agentProbs, const OutcomeQuery *query) {
+  stepActionProbs.resize(agents.size());
   for (unsigned int i = 0; i < agents.size(); i++) {
-    if (actionProbs[i][(Action::Type)actionInds[i]] <= 0)
-      return false;
-    requestedPositions[i] = world->getAgentPosition(i,(Action::Type)actionInds[i]);
+    stepActionProbs[i] = getOutcomeAction(i,prevObs,query);
+    assert(stepActionProbs[i].checkTotal());
   }
-  return true;
+
+  Observation absPrevObs(prevObs);
+  Observation absCurrentObs(currentObs);
+  if (centerPrey) {
+    absPrevObs.uncenterPrey(*geometry);
+    absCurrentObs.uncenterPrey(*geometry);
+  }
+  // if the prey was captured and placed again, it could have ended anywhere
+  int unconstrainedInd = -1;
+  if (absCurrentObs.didPreyMoveIllegally(*geometry,absPrevObs.absPrey))
+    unconstrainedInd = absPrevObs.preyInd;
+
+  return exactOutcomes.getProb(absPrevObs.positions,stepActionProbs,absCurrentObs.positions,unconstrainedInd,agentProbs);
 }
 
 void World::handleCollisions(const std::vector<Point2D> &requestedPositions) {
   // ORDERED COLLISION DECISION
-  std::vector<unsigned int> agentOrder(agents.size());
-  rng->randomOrdering(agentOrder);
+  stepAgentOrder.resize(agents.size());
+  rng->randomOrdering(stepAgentOrder);
   //for (unsigned int i = 0; i < agentOrder.size(); i++)
     //agentOrder[i] = i;
-  handleCollisionsOrdered(requestedPositions,agentOrder);
+  handleCollisionsOrdered(requestedPositions,stepAgentOrder);
 }
 
 void World::handleCollisionsOrdered(const std::vector<Point2D> &requestedPositions, const std::vector<unsigned int> &agentOrder) {
@@ -463,6 +319,7 @@ bool World::addAgent(const AgentModel &agentModel, boost::shared_ptr<Agent> agen
     return false;
   }
   agents.push_back(agent);
+  resetCache(); // the cached indices may refer to other agents in the clones
   return true;
 }
 
@@ -470,6 +327,10 @@ boost::shared_ptr<WorldModel> World::getModel() {
   return world;
 }
 
+void World::setRNG(boost::shared_ptr<RNG> rng) {
+  this->rng = rng;
+}
+
 void World::setAgentControllers(const std::vector<boost::shared_ptr<Agent> > newAgents) {
   //std::cout << "START SETTING AGENT CONTROLLERS" << std::endl;
   if (newAgents.size() != agents.size())
@@ -479,6 +340,7 @@ void World::setAgentControllers(const std::vector<boost::shared_ptr<Agent> > new
     agents[i] = newAgents[i];
     //std::cout << typeid(*agents[i]).name() << std::endl;
   }
+  resetCache();
   //std::cout << "STOP  SETTING AGENT CONTROLLERS" << std::endl;
 }
 
@@ -486,6 +348,8 @@ std::string World::generateDescription(unsigned int indentation) {
   std::string s;
   s += indent(indentation) + "World:\n";
   s += indent(indentation+1) + "Action Noise: " + boost::lexical_cast<std::string>(actionNoise) + "\n";
+  if (cacheSize > 0)
+    s += indent(indentation+1) + "Action Cache Size: " + boost::lexical_cast<std::string>(cacheSize) + "\n";
   s += world->generateDescription(indentation+1) + "\n";
   s += indent(indentation+1) + "Agents:\n";
   for (unsigned int i = 0; i < agents.size(); i++)
@@ -499,27 +363,38 @@ void World::printAgents() {
   }
 }
 
-ActionProbs World::getAgentAction(unsigned int ind, boost::shared_ptr<Agent> agent, Observation &obs) {
+ActionProbs World::getAgentAction(unsigned int ind, const boost::shared_ptr<Agent> &agent, Observation &obs) {
   ActionProbs actionProbs;
   obs.myInd = ind;
+  bool cacheable = (actionCache.get() != NULL) && agent->isStepCacheable();
+  if (cacheable && actionCache->get(obs,actionProbs))
+    return actionProbs;
   actionProbs = agent->step(obs);
 
-  if (actionNoise > 0) {
-    double origWeight = 1 - actionNoise;
-    double noiseWeight = 0;
-    for (unsigned int i = 0; i < Action::NUM_NEIGHBORS; i++) {
-      noiseWeight += actionNoise * actionProbs[(Action::Type)i]; 
-      actionProbs[(Action::Type)i] *= origWeight;
-    }
-    noiseWeight /= Action::NUM_ACTIONS;
-    for (unsigned int i = 0; i < Action::NUM_ACTIONS; i++) {
-      actionProbs[(Action::Type)i] += noiseWeight;
-    }
-  }
+  if (actionNoise > 0)
+    actionProbs.addNoise(actionNoise);
 
+  if (cacheable)
+    actionCache->put(obs,actionProbs);
   return actionProbs;
 }
 
+ActionProbs World::getOutcomeAction(unsigned int ind, Observation &obs, const OutcomeQuery *query) {
+  if (query == NULL)
+    return getAgentAction(ind,agents[ind],obs);
+  if ((int)ind == query->fixedInd) {
+    ActionProbs actionProbs(query->fixedAction);
+    if (actionNoise > 0)
+      actionProbs.addNoise(actionNoise);
+    return actionProbs;
+  }
+  if (agents[ind]->isStepCacheable())
+    return getAgentAction(ind,agents[ind],obs);
+  // the step may change the agent, so only a copy takes it
+  boost::shared_ptr<Agent> agent(agents[ind]->clone());
+  return getAgentAction(ind,agent,obs);
+}
+
 boost::shared_ptr<World> World::clone() const {
   boost::shared_ptr<AgentDummy> oldAdhocAgent, newAdhocAgent;
   return clone(oldAdhocAgent,newAdhocAgent);
@@ -532,26 +407,50 @@ boost::shared_ptr<World> World::clone(const boost::shared_ptr<AgentDummy> &oldAd
     if (agents[i].get() == oldAdhocAgent.get())
       newAdhocAgent = boost::static_pointer_cast<AgentDummy>(controller->agents.back());
   }
-  //controller->cachingEnabled = cachingEnabled;
-  //controller->actionCache = actionCache;
-  //controller->uncachedAgentInd = uncachedAgentInd;
+  controller->cacheSize = cacheSize;
+  controller->actionCache = actionCache;
   return controller;
 }
-/*
-void World::setCaching(bool cachingEnabled) {
-  this->cachingEnabled = cachingEnabled;
-  // TODO
+
+void World::rewindAgents(const World &source) {
+  assert(agents.size() == source.agents.size());
+  for (unsigned int i = 0; i < agents.size(); i++) {
+    if (!agents[i]->copyStepState(*(source.agents[i])))
+      agents[i] = boost::shared_ptr<Agent>(source.agents[i]->clone());
+  }
+}
+
+void World::setCaching(unsigned int cacheSize) {
+  this->cacheSize = cacheSize;
+  resetCache();
 }
-*/  
+
+void World::resetCache() {
+  if (cacheSize > 0)
+    actionCache = boost::shared_ptr<ActionCache>(new ActionCache(cacheSize));
+  else
+    actionCache.reset();
+}
+
 void World::learnControllers(const Observation &prevObs, const Observation &currentObs) {
   Observation absPrevObs(prevObs);
   Observation absCurrentObs(currentObs);
-  absPrevObs.uncenterPrey(dims);
-  absCurrentObs.uncenterPrey(dims);
+  absPrevObs.uncenterPrey(*geometry);
+  absCurrentObs.uncenterPrey(*geometry);
 
   for (unsigned int i = 0; i < agents.size(); i++) {
     absPrevObs.myInd = i;
     absCurrentObs.myInd = i;
     agents[i]->learn(absPrevObs,absCurrentObs,i);
+    if ((actionCache.get() != NULL) && agents[i]->learnsOnline())
+      actionCache->invalidateAgent(i);
   }
 }
+
+bool World::canStepAgentsInParallel() const {
+  for (unsigned int i = 0; i < agents.size(); i++) {
+    if (!agents[i]->canStepInParallel())
+      return false;
+  }
+  return true;
+}
@@ -9,7 +9,7 @@ File: World.h
 Author: Samuel Barrett
 Description: the controller for the world
 Created:  2011-08-22
-Modified: 2012-02-02
+Modified: 2013-08-19
 */
 
 #include <boost/shared_ptr.hpp>
@@ -18,7 +18,9 @@ Modified: 2012-02-02
 #include <rl_pursuit/common/Point2D.h>
 #include <rl_pursuit/common/RNG.h>
 #include <rl_pursuit/model/AgentModel.h>
+#include <rl_pursuit/model/ExactOutcomes.h>
 #include <rl_pursuit/model/WorldModel.h>
+#include "ActionCache.h"
 #include "Agent.h"
 #include "AgentDummy.h"
 
@@ -29,21 +31,17 @@ struct WorldStepOutcome {
   double prob;
   Action::Type agentDummyAction;
 };
-/*
-struct ObservationComp {
-  bool operator() (const Observation& lhs, const Observation& rhs) const;
-};
-std::size_t hash_value(const Observation &o);
-*/
 class World {
 public:
   World (boost::shared_ptr<RNG> rng, boost::shared_ptr<WorldModel> world, double actionNoise, bool centerPrey);
   
   void generateObservation(Observation &obs);
+  // the world model's live observation, it changes as the world steps
+  const Observation& getObservation() {return world->getObservation(centerPrey);}
+  int getAgentInd(const boost::shared_ptr<Agent> &agent) const; // -1 if it's not in the world
   void step();
   void step(boost::shared_ptr<std::vector<Action::Type> > actions);
   void step(boost::shared_ptr<std::vector<Action::Type> > actions, std::vector<ActionProbs> &actionProbList);
-  //void setUncachedAgent(boost::shared_ptr<Agent> agent);
   //void step(std::vector<boost::shared_ptr<Agent> > &agents);
   //void step(boost::shared_ptr<std::vector<Action::Type> > actions, std::vector<boost::shared_ptr<Agent> > &agents);
   void randomizePositions();
@@ -51,21 +49,31 @@ public:
   void restartAgents();
   bool addAgent(const AgentModel &agentModel, boost::shared_ptr<Agent> agent, bool ignorePosition=false);
   boost::shared_ptr<WorldModel> getModel();
+  void setRNG(boost::shared_ptr<RNG> rng);
   void setAgentControllers(const std::vector<boost::shared_ptr<Agent> > newAgents);
 
   std::string generateDescription(unsigned int indentation = 0);
-  double getOutcomeProb(Observation prevObs,const Observation &currentObs);
+  // exact, agentProbs gets the probability of each agent's group of interacting agents
+  double getOutcomeProb(Observation prevObs, const Observation &currentObs, std::vector<double> &agentProbs);
   double getOutcomeProbApprox(Observation prevObs,const Observation &currentObs, std::vector<double> &agentProbs);//, std::vector<boost::shared_ptr<Agent> > &agents);
-  void getPossibleOutcomesApprox(std::vector<AgentPtr> &agents, AgentPtr agentDummy, std::vector<std::vector<WorldStepOutcome> > &outcomesByAction);
+  // the same probabilities, but the world and its agents are left unchanged.
+  // The agent at fixedInd takes fixedAction instead of stepping, and agents
+  // whose step isn't cacheable are stepped on a copy
+  double getOutcomeLikelihood(const Observation &prevObs, const Observation &currentObs, int fixedInd, Action::Type fixedAction, std::vector<double> &agentProbs, bool exact);
+  // every outcome of the next step for each action of agentDummy
+  void getPossibleOutcomes(std::vector<AgentPtr> &agents, AgentPtr agentDummy, std::vector<std::vector<WorldStepOutcome> > &outcomesByAction);
   void printAgents();
   
   boost::shared_ptr<World> clone() const;
   virtual boost::shared_ptr<World> clone(const boost::shared_ptr<AgentDummy> &oldAdhocAgent, boost::shared_ptr<AgentDummy> &newAdhocAgent) const;
-  //void setCaching(bool cachingEnabled);
-  //void resetCache() {
-    //actionCache = boost::shared_ptr<ActionCache>(new ActionCache());
-  //}
+  void rewindAgents(const World &source); // source must be the world this was cloned from
+  // caches the action distributions of the agents with isStepCacheable,
+  // shared with the clones made afterwards. 0 disables caching
+  void setCaching(unsigned int cacheSize);
+  void resetCache(); // a new empty cache, no longer shared with the existing clones
+  boost::shared_ptr<ActionCache> getActionCache() {return actionCache;} // NULL without caching
   void learnControllers(const Observation &prevObs, const Observation &currentObs);
+  bool canStepAgentsInParallel() const; // whether clones can step in different threads
 
   void testPredictionAccuracy(boost::shared_ptr<std::vector<Action::Type> > actions);
 
@@ -73,23 +81,34 @@ protected:
   boost::shared_ptr<RNG> rng;
   boost::shared_ptr<WorldModel> world;
   const Point2D dims;
+  boost::shared_ptr<const Geometry> geometry;
   std::vector<boost::shared_ptr<Agent> > agents;
   double actionNoise;
   bool centerPrey;
-  //bool cachingEnabled;
-  //int uncachedAgentInd;
+  unsigned int cacheSize;
+  boost::shared_ptr<ActionCache> actionCache;
+
+  // scratch space for step, kept between calls so stepping doesn't allocate
+  std::vector<Point2D> stepRequestedPositions;
+  std::vector<ActionProbs> stepActionProbs;
+  std::vector<unsigned int> stepAgentOrder;
+  ExactOutcomes exactOutcomes;
 
-  //typedef std::map<Observation,std::vector<ActionProbs>,ObservationComp> ActionCache;
-  //typedef boost::unordered_map<Observation,std::vector<ActionProbs> > ActionCache;
-  //boost::shared_ptr<ActionCache> actionCache;
+  // where the actions for an outcome probability come from, NULL steps the agents
+  struct OutcomeQuery {
+    int fixedInd;
+    Action::Type fixedAction;
+  };
 
 protected:
+  void step(std::vector<Action::Type> *actions, std::vector<ActionProbs> &actionProbList); // actions may be NULL
   void handleCollisions(const std::vector<Point2D> &requestedPositions);
   void handleCollisionsOrdered(const std::vector<Point2D> &requestedPositions, const std::vector<unsigned int> &agentOrder);
 
-  bool incrementActionIndices(std::vector<unsigned int> &actionInds);
-  bool getRequestedPositionsForActionIndices(const std::vector<unsigned int> &actionInds, const std::vector<ActionProbs> &actionProbs, std::vector<Point2D> &requestedPositions);
-  ActionProbs getAgentAction(unsigned int ind, boost::shared_ptr<Agent> agent, Observation &obs);
+  ActionProbs getAgentAction(unsigned int ind, const boost::shared_ptr<Agent> &agent, Observation &obs);
+  ActionProbs getOutcomeAction(unsigned int ind, Observation &obs, const OutcomeQuery *query);
+  double getOutcomeProb(Observation prevObs, const Observation &currentObs, std::vector<double> &agentProbs, const OutcomeQuery *query);
+  double getOutcomeProbApprox(Observation prevObs, const Observation &currentObs, std::vector<double> &agentProbs, const OutcomeQuery *query);
   double getProbOfNoCollisionApprox(const Observation &prevObs, const Observation &currentObs, const Point2D &requestedPosition, unsigned int agentInd);
 
   FRIEND_TEST(WorldTest,Collisions);
@@ -0,0 +1,394 @@
+/*
+File: WorldBatch.cpp
+Author: Samuel Barrett
+Description: steps many independent pursuit worlds in lockstep for the
+  stateless built in behaviors
+Created:  2013-08-17
+Modified: 2013-08-17
+*/
+
+#include "WorldBatch.h"
+#include <algorithm>
+#include <cassert>
+#include <climits>
+#include <cstdlib>
+#include <iostream>
+#include <boost/lexical_cast.hpp>
+#include <rl_pursuit/common/Util.h>
+#include "PredatorProbabilisticDestinations.h"
+
+// The kernels below each work on rows of values, one per world. The rows
+// never overlap, and saying so with __restrict__ is what lets the compiler
+// vectorize the loops that touch many rows at once.
+
+static inline int wrap(int val, int size) {
+  // only for values within one size of the grid
+  val = (val >= size) ? val - size : val;
+  return (val < 0) ? val + size : val;
+}
+
+static inline int getDelta(int delta, int size) {
+  // matches getDifferenceToPoint
+  delta = (2 * delta > size) ? delta - size : delta;
+  return (2 * delta < -size) ? delta + size : delta;
+}
+
+// cell = pos + move
+static void offsetRow(unsigned int count, int width, int height, const Point2D &move, const int *__restrict__ posX, const int *__restrict__ posY, int *__restrict__ cellX, int *__restrict__ cellY) {
+  for (unsigned int world = 0; world < count; world++) {
+    cellX[world] = wrap(posX[world] + move.x,width);
+    cellY[world] = wrap(posY[world] + move.y,height);
+  }
+}
+
+// requested = pos + Action::MOVES[action]
+static void moveRow(unsigned int count, int width, int height, const int *__restrict__ posX, const int *__restrict__ posY, const int *__restrict__ action, int *__restrict__ requestedX, int *__restrict__ requestedY) {
+  for (unsigned int world = 0; world < count; world++) {
+    const Point2D &move = Action::MOVES[action[world]];
+    requestedX[world] = wrap(posX[world] + move.x,width);
+    requestedY[world] = wrap(posY[world] + move.y,height);
+  }
+}
+
+// observed = pos shifted so that the prey is in the center
+static void centerRow(unsigned int count, int width, int height, int centerX, int centerY, const int *__restrict__ preyX, const int *__restrict__ preyY, const int *__restrict__ posX, const int *__restrict__ posY, int *__restrict__ observedX, int *__restrict__ observedY) {
+  for (unsigned int world = 0; world < count; world++) {
+    observedX[world] = wrap(posX[world] + centerX - preyX[world],width);
+    observedY[world] = wrap(posY[world] + centerY - preyY[world],height);
+  }
+}
+
+// collision = the lowest agent index at x,y or -1, positions hold a row per agent
+static void findCollisions(unsigned int count, unsigned int numAgents, const int *__restrict__ positionsX, const int *__restrict__ positionsY, const int *__restrict__ x, const int *__restrict__ y, int *__restrict__ collision) {
+  for (unsigned int world = 0; world < count; world++)
+    collision[world] = -1;
+  // backwards so the lowest index wins
+  for (int i = (int)numAgents - 1; i >= 0; i--) {
+    const int *agentX = &positionsX[i * count];
+    const int *agentY = &positionsY[i * count];
+    for (unsigned int world = 0; world < count; world++)
+      collision[world] = ((agentX[world] == x[world]) & (agentY[world] == y[world])) ? i : collision[world];
+  }
+}
+
+// one step of getGreedyDesiredPosition for the cells beside the prey
+static void updateGreedyDestinations(unsigned int count, int width, int height, int agent, const int *__restrict__ myX, const int *__restrict__ myY, const int *__restrict__ cellX, const int *__restrict__ cellY, const int *__restrict__ collision, int *__restrict__ minDist, int *__restrict__ destX, int *__restrict__ destY, int *__restrict__ adjacent) {
+  for (unsigned int world = 0; world < count; world++) {
+    // every load up front so the selects don't become branches
+    int x = cellX[world];
+    int y = cellY[world];
+    int oldDist = minDist[world];
+    int oldX = destX[world];
+    int oldY = destY[world];
+    int dist = abs(getDelta(myX[world] - x,width)) + abs(getDelta(myY[world] - y,height));
+    int closer = (collision[world] < 0) & (dist < oldDist);
+    minDist[world] = closer ? dist : oldDist;
+    destX[world] = closer ? x : oldX;
+    destY[world] = closer ? y : oldY;
+    adjacent[world] |= (collision[world] == agent);
+  }
+}
+
+// val = flag ? newVal : val
+static void selectRow(unsigned int count, const int *__restrict__ flag, const int *__restrict__ newVal, int *__restrict__ val) {
+  for (unsigned int world = 0; world < count; world++) {
+    int oldVal = val[world];
+    int candidate = newVal[world];
+    val[world] = flag[world] ? candidate : oldVal;
+  }
+}
+
+// dest becomes the difference from pos to dest
+static void differenceRow(unsigned int count, int size, const int *__restrict__ pos, int *__restrict__ dest) {
+  for (unsigned int world = 0; world < count; world++)
+    dest[world] = getDelta(dest[world] - pos[world],size);
+}
+
+// cell = one step from pos in the direction of delta
+static void stepTowardsRow(unsigned int count, int size, const int *__restrict__ pos, const int *__restrict__ delta, int *__restrict__ cell) {
+  for (unsigned int world = 0; world < count; world++)
+    cell[world] = wrap(pos[world] + sgn(delta[world]),size);
+}
+
+// the decision in greedyObstacleAvoid, collision1 is for moving along x and collision2 along y
+static void chooseGreedyActions(unsigned int count, int prey, const int *__restrict__ deltaX, const int *__restrict__ deltaY, const int *__restrict__ collision1, const int *__restrict__ collision2, int *__restrict__ actions) {
+  for (unsigned int world = 0; world < count; world++) {
+    int dx = deltaX[world];
+    int dy = deltaY[world];
+    int blocked1 = (collision1[world] >= 0) & (collision1[world] != prey);
+    int blocked2 = (collision2[world] >= 0) & (collision2[world] != prey);
+    int action1 = (dx > 0) ? Action::RIGHT : ((dx < 0) ? Action::LEFT : Action::NOOP);
+    int action2 = (dy > 0) ? Action::UP : ((dy < 0) ? Action::DOWN : Action::NOOP);
+    // lowest priority first
+    int action = (abs(dx) > abs(dy)) ? action1 : action2;
+    action = (blocked2 & !blocked1 & (dx != 0)) ? action1 : action;
+    action = (blocked1 & !blocked2 & (dy != 0)) ? action2 : action;
+    action = (blocked1 & blocked2) ? (int)Action::RANDOM : action;
+    actions[world] = action;
+  }
+}
+
+WorldBatch::WorldBatch(const Point2D &dims, unsigned int numWorlds, double actionNoise, bool centerPrey, unsigned int randomSeed):
+  dims(dims),
+  geometry(Geometry::get(dims)),
+  center(0.5f * dims),
+  numWorlds(numWorlds),
+  actionNoise(actionNoise),
+  centerPrey(centerPrey),
+  preyInd(-1),
+  cellXs(numWorlds),
+  cellYs(numWorlds),
+  collisions(numWorlds),
+  otherCollisions(numWorlds),
+  destXs(numWorlds),
+  destYs(numWorlds),
+  minDists(numWorlds),
+  flags(numWorlds)
+{
+  for (unsigned int i = 0; i < numWorlds; i++)
+    rngs.push_back(RNG(randomSeed + i));
+}
+
+bool WorldBatch::addAgent(AgentType type, BatchPolicy_t policy) {
+  if (type == PREY) {
+    if (preyInd >= 0) {
+      std::cerr << "WorldBatch::addAgent: failed, only supports a single prey" << std::endl;
+      return false;
+    }
+    preyInd = policies.size();
+  }
+
+  policies.push_back(policy);
+  if (policy == BatchPolicy::PROBABILISTIC_DESTINATIONS) {
+    // its step doesn't use the rng
+    boost::shared_ptr<RNG> rng(new RNG(0));
+    agents.push_back(boost::shared_ptr<Agent>(new PredatorProbabilisticDestinations(rng,dims)));
+  } else {
+    agents.push_back(boost::shared_ptr<Agent>());
+  }
+
+  unsigned int size = policies.size() * numWorlds;
+  xs.resize(size,0);
+  ys.resize(size,0);
+  intendedActions.resize(size,Action::RANDOM);
+  actions.resize(size,Action::NOOP);
+  requestedXs.resize(size,0);
+  requestedYs.resize(size,0);
+  if (centerPrey) {
+    observedXs.resize(size,0);
+    observedYs.resize(size,0);
+  }
+  return true;
+}
+
+void WorldBatch::step() {
+  unsigned int numAgents = policies.size();
+  // the batched behaviors for all of the worlds at once. They see the
+  // positions the way the agents in World do, because the tie breaking in
+  // getDifferenceToPoint depends on where the origin is
+  const int *positionsX = &xs[0];
+  const int *positionsY = &ys[0];
+  if (centerPrey) {
+    setObservedPositions();
+    positionsX = &observedXs[0];
+    positionsY = &observedYs[0];
+  }
+  for (unsigned int i = 0; i < numAgents; i++) {
+    if (policies[i] == BatchPolicy::GREEDY)
+      setGreedyActions(i,positionsX,positionsY);
+  }
+
+  // sampling uses each world's rng in the same order as World::step
+  for (unsigned int world = 0; world < numWorlds; world++)
+    setSampledActions(world);
+
+  for (unsigned int i = 0; i < numAgents; i++) {
+    unsigned int row = i * numWorlds;
+    moveRow(numWorlds,dims.x,dims.y,&xs[row],&ys[row],&actions[row],&requestedXs[row],&requestedYs[row]);
+  }
+
+  for (unsigned int world = 0; world < numWorlds; world++)
+    moveAgents(world);
+}
+
+void WorldBatch::setObservedPositions() {
+  // Observation::centerPrey
+  assert(preyInd >= 0);
+  unsigned int preyRow = preyInd * numWorlds;
+  for (unsigned int i = 0; i < policies.size(); i++) {
+    unsigned int row = i * numWorlds;
+    centerRow(numWorlds,dims.x,dims.y,center.x,center.y,&xs[preyRow],&ys[preyRow],&xs[row],&ys[row],&observedXs[row],&observedYs[row]);
+  }
+}
+
+void WorldBatch::setGreedyActions(unsigned int agent, const int *positionsX, const int *positionsY) {
+  assert(preyInd >= 0);
+  const unsigned int count = numWorlds;
+  const unsigned int numAgents = policies.size();
+  const int *preyX = &positionsX[preyInd * count];
+  const int *preyY = &positionsY[preyInd * count];
+  const int *myX = &positionsX[agent * count];
+  const int *myY = &positionsY[agent * count];
+
+  // getGreedyDesiredPosition: the closest free cell beside the prey, or the
+  // prey if we're already beside it, and the origin if every cell is taken
+  std::fill(destXs.begin(),destXs.end(),0);
+  std::fill(destYs.begin(),destYs.end(),0);
+  std::fill(minDists.begin(),minDists.end(),INT_MAX);
+  std::fill(flags.begin(),flags.end(),0);
+  for (unsigned int i = 0; i < Action::NUM_NEIGHBORS; i++) {
+    offsetRow(count,dims.x,dims.y,Action::MOVES[i],preyX,preyY,&cellXs[0],&cellYs[0]);
+    findCollisions(count,numAgents,positionsX,positionsY,&cellXs[0],&cellYs[0],&collisions[0]);
+    updateGreedyDestinations(count,dims.x,dims.y,agent,myX,myY,&cellXs[0],&cellYs[0],&collisions[0],&minDists[0],&destXs[0],&destYs[0],&flags[0]);
+  }
+  selectRow(count,&flags[0],preyX,&destXs[0]);
+  selectRow(count,&flags[0],preyY,&destYs[0]);
+
+  // greedyObstacleAvoid, checking the cells for moving along each axis
+  differenceRow(count,dims.x,myX,&destXs[0]);
+  differenceRow(count,dims.y,myY,&destYs[0]);
+  stepTowardsRow(count,dims.x,myX,&destXs[0],&cellXs[0]);
+  findCollisions(count,numAgents,positionsX,positionsY,&cellXs[0],myY,&collisions[0]);
+  stepTowardsRow(count,dims.y,myY,&destYs[0],&cellYs[0]);
+  findCollisions(count,numAgents,positionsX,positionsY,myX,&cellYs[0],&otherCollisions[0]);
+  chooseGreedyActions(count,preyInd,&destXs[0],&destYs[0],&collisions[0],&otherCollisions[0],&intendedActions[agent * count]);
+}
+
+void WorldBatch::setSampledActions(unsigned int world) {
+  bool observationReady = false;
+  for (unsigned int i = 0; i < policies.size(); i++) {
+    unsigned int ind = i * numWorlds + world;
+    ActionProbs actionProbs;
+    if (agents[i].get() != NULL) {
+      if (!observationReady) {
+        generateObservation(world,obs);
+        observationReady = true;
+      }
+      obs.myInd = i;
+      actionProbs = agents[i]->step(obs);
+    } else {
+      actionProbs = ActionProbs((Action::Type)intendedActions[ind]);
+    }
+    if (actionNoise > 0)
+      actionProbs.addNoise(actionNoise);
+    actions[ind] = actionProbs.selectAction(rngs[world]);
+  }
+}
+
+void WorldBatch::moveAgents(unsigned int world) {
+  // the same ordered collision handling as World
+  unsigned int numAgents = policies.size();
+  agentOrder.resize(numAgents);
+  rngs[world].randomOrdering(agentOrder);
+  for (unsigned int i = 0; i < numAgents; i++) {
+    unsigned int agent = agentOrder[i];
+    unsigned int ind = agent * numWorlds + world;
+    int x = requestedXs[ind];
+    int y = requestedYs[ind];
+    bool collision = false;
+    for (unsigned int j = 0; j < numAgents; j++) {
+      unsigned int other = j * numWorlds + world;
+      collision |= ((j != agent) && (xs[other] == x) && (ys[other] == y));
+    }
+    if (!collision) {
+      xs[ind] = x;
+      ys[ind] = y;
+    }
+  }
+}
+
+int WorldBatch::getCollision(unsigned int world, int x, int y, int maxInd) const {
+  if ((maxInd < 0) || ((unsigned int)maxInd > policies.size()))
+    maxInd = policies.size();
+  for (int i = 0; i < maxInd; i++) {
+    unsigned int ind = i * numWorlds + world;
+    if ((xs[ind] == x) && (ys[ind] == y))
+      return i;
+  }
+  return -1;
+}
+
+void WorldBatch::randomizePositions() {
+  for (unsigned int world = 0; world < numWorlds; world++)
+    randomizePositions(world);
+}
+
+void WorldBatch::randomizePositions(unsigned int world) {
+  RNG &rng = rngs[world];
+  for (unsigned int i = 0; i < policies.size(); i++) {
+    int x, y;
+    do {
+      x = rng.randomInt(dims.x);
+      y = rng.randomInt(dims.y);
+    } while (getCollision(world,x,y,i) >= 0);
+    setAgentPosition(world,i,Point2D(x,y));
+  }
+}
+
+void WorldBatch::randomizePreyPosition(unsigned int world) {
+  RNG &rng = rngs[world];
+  int x, y;
+  do {
+    x = rng.randomInt(dims.x);
+    y = rng.randomInt(dims.y);
+  } while (getCollision(world,x,y) >= 0); // includes collisions with current location
+  setAgentPosition(world,preyInd,Point2D(x,y));
+}
+
+bool WorldBatch::isPreyCaptured(unsigned int world) const {
+  if (preyInd < 0)
+    return true;
+  Point2D preyPos = getAgentPosition(world,preyInd);
+  for (unsigned int i = 0; i < Action::NUM_NEIGHBORS; i++) {
+    Point2D pos = geometry->movePosition(preyPos,(Action::Type)i);
+    if (getCollision(world,pos.x,pos.y) < 0)
+      return false;
+  }
+  return true;
+}
+
+unsigned int WorldBatch::findCaptures(std::vector<unsigned char> &captured) {
+  captured.assign(numWorlds,1);
+  if (preyInd < 0)
+    return numWorlds;
+  unsigned int preyRow = preyInd * numWorlds;
+  for (unsigned int i = 0; i < Action::NUM_NEIGHBORS; i++) {
+    offsetRow(numWorlds,dims.x,dims.y,Action::MOVES[i],&xs[preyRow],&ys[preyRow],&cellXs[0],&cellYs[0]);
+    findCollisions(numWorlds,policies.size(),&xs[0],&ys[0],&cellXs[0],&cellYs[0],&collisions[0]);
+    for (unsigned int world = 0; world < numWorlds; world++)
+      captured[world] &= (collisions[world] >= 0);
+  }
+  unsigned int numCaptured = 0;
+  for (unsigned int world = 0; world < numWorlds; world++)
+    numCaptured += captured[world];
+  return numCaptured;
+}
+
+void WorldBatch::setAgentPosition(unsigned int world, unsigned int agent, const Point2D &pos) {
+  Point2D wrapped = geometry->movePosition(pos,Action::NOOP);
+  unsigned int ind = agent * numWorlds + world;
+  xs[ind] = wrapped.x;
+  ys[ind] = wrapped.y;
+}
+
+void WorldBatch::generateObservation(unsigned int world, Observation &obs) const {
+  obs.preyInd = preyInd;
+  obs.myInd = 0;
+  obs.positions.clear();
+  for (unsigned int i = 0; i < policies.size(); i++)
+    obs.positions.push_back(getAgentPosition(world,i));
+  assert(preyInd >= 0);
+  obs.absPrey = obs.positions[preyInd];
+  if (centerPrey)
+    obs.centerPrey(*geometry);
+}
+
+std::string WorldBatch::generateDescription(unsigned int indentation) {
+  std::string s;
+  s += indent(indentation) + "WorldBatch " + dims.toString() + " with " + boost::lexical_cast<std::string>(numWorlds) + " worlds:\n";
+  s += indent(indentation+1) + "Action Noise: " + boost::lexical_cast<std::string>(actionNoise) + "\n";
+  s += indent(indentation+1) + "Agents:\n";
+  for (unsigned int i = 0; i < policies.size(); i++)
+    s += indent(indentation+2) + getName(policies[i]) + ((int)i == preyInd ? " (prey)" : "") + "\n";
+  return s;
+}
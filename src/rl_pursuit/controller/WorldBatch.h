@@ -0,0 +1,107 @@
+#ifndef WORLDBATCH_R7PD2XQK
+#define WORLDBATCH_R7PD2XQK
+
+/*
+File: WorldBatch.h
+Author: Samuel Barrett
+Description: steps many independent pursuit worlds in lockstep for the
+  stateless built in behaviors. The positions are stored as structure of
+  arrays, one row of numWorlds values per agent, so the moves, wrapping,
+  greedy destinations and capture checks are plain loops over the worlds
+  that the compiler can vectorize. Each world has its own RNG and uses it in
+  the same order as World, so a world seeded like a World with the same
+  behaviors follows the same trajectory.
+Created:  2013-08-17
+Modified: 2013-08-17
+*/
+
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <rl_pursuit/common/Enum.h>
+#include <rl_pursuit/common/Point2D.h>
+#include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/model/AgentModel.h>
+#include <rl_pursuit/model/Common.h>
+#include <rl_pursuit/model/Geometry.h>
+#include "Agent.h"
+
+ENUM(BatchPolicy,
+  RANDOM, // AgentRandom
+  GREEDY, // PredatorGreedy
+  PROBABILISTIC_DESTINATIONS // PredatorProbabilisticDestinations
+)
+
+class WorldBatch {
+public:
+  // world i is seeded with randomSeed + i
+  WorldBatch(const Point2D &dims, unsigned int numWorlds, double actionNoise, bool centerPrey, unsigned int randomSeed);
+
+  bool addAgent(AgentType type, BatchPolicy_t policy);
+  void step();
+
+  void randomizePositions();
+  void randomizePositions(unsigned int world);
+  void randomizePreyPosition(unsigned int world);
+
+  bool isPreyCaptured(unsigned int world) const;
+  unsigned int findCaptures(std::vector<unsigned char> &captured); // returns the number of worlds with the prey captured
+
+  // positions are wrapped onto the grid
+  void setAgentPosition(unsigned int world, unsigned int agent, const Point2D &pos);
+  inline Point2D getAgentPosition(unsigned int world, unsigned int agent) const {
+    unsigned int ind = agent * numWorlds + world;
+    return Point2D(xs[ind],ys[ind]);
+  }
+  void generateObservation(unsigned int world, Observation &obs) const;
+
+  RNG& getRNG(unsigned int world) {return rngs[world];}
+  inline unsigned int getNumWorlds() const {return numWorlds;}
+  inline unsigned int getNumAgents() const {return policies.size();}
+  inline int getPreyInd() const {return preyInd;}
+  inline Point2D getDims() const {return dims;}
+  std::string generateDescription(unsigned int indentation = 0);
+
+protected:
+  void setObservedPositions();
+  void setGreedyActions(unsigned int agent, const int *positionsX, const int *positionsY);
+  void setSampledActions(unsigned int world);
+  void moveAgents(unsigned int world);
+  int getCollision(unsigned int world, int x, int y, int maxInd = -1) const; // lowest agent index at x,y or -1
+
+protected:
+  const Point2D dims;
+  boost::shared_ptr<const Geometry> geometry;
+  const Point2D center;
+  const unsigned int numWorlds;
+  double actionNoise;
+  bool centerPrey;
+  int preyInd;
+  std::vector<BatchPolicy_t> policies;
+  std::vector<boost::shared_ptr<Agent> > agents; // only for the behaviors that aren't batched
+  std::vector<RNG> rngs;
+
+  // indexed by agent * numWorlds + world
+  std::vector<int> xs;
+  std::vector<int> ys;
+  std::vector<int> intendedActions; // from the batched behaviors, can be Action::RANDOM
+  std::vector<int> actions;
+  std::vector<int> requestedXs;
+  std::vector<int> requestedYs;
+  std::vector<int> observedXs; // relative to the centered prey, when centerPrey
+  std::vector<int> observedYs;
+
+  // scratch rows
+  std::vector<int> cellXs;
+  std::vector<int> cellYs;
+  std::vector<int> collisions;
+  std::vector<int> otherCollisions;
+  std::vector<int> destXs;
+  std::vector<int> destYs;
+  std::vector<int> minDists;
+  std::vector<int> flags;
+  std::vector<unsigned int> agentOrder;
+  Observation obs;
+};
+
+#endif /* end of include guard: WORLDBATCH_R7PD2XQK */
@@ -3,7 +3,7 @@ File: WorldBeliefMDP.cpp
 Author: Samuel Barrett
 Description: mdp wrapper of a world, but with beliefs now
 Created:  2011-10-04
-Modified: 2011-10-04
+Modified: 2013-08-19
 */
 
 #include "WorldBeliefMDP.h"
@@ -25,6 +25,10 @@ void WorldBeliefMDP::setState(const State_t &state) {
 }
 
 State_t WorldBeliefMDP::getState(const Observation &obs) {
+  if (!isStatePacked(obs.positions.size())) {
+    std::cerr << "WorldBeliefMDP::getState: ERROR the beliefs can't be added to a hashed state, too many agents for the grid or incremental states" << std::endl;
+    exit(66);
+  }
   State_t state = WorldMDP::getState(obs);
   //State_t savedState = state;
   stateConverter.convertGeneralStateToBeliefState(state,modelUpdater->getBeliefs());
@@ -11,13 +11,25 @@
 #define OUTPUT(x) ((void) 0)
 #endif
 
+static inline bool samePositions(const PositionList &a, const PositionList &b) {
+  if (a.size() != b.size())
+    return false;
+  for (unsigned int i = 0; i < a.size(); i++) {
+    if (a[i] != b[i])
+      return false;
+  }
+  return true;
+}
+
 WorldMDP::WorldMDP(boost::shared_ptr<RNG> rng, boost::shared_ptr<WorldModel> model, boost::shared_ptr<World> controller, boost::shared_ptr<AgentDummy> adhocAgent, bool usePreySymmetry):
   rng(rng),
   model(model),
   controller(controller),
   adhocAgent(adhocAgent),
   preyPos(0.5f * model->getDims()),
-  usePreySymmetry(usePreySymmetry)
+  usePreySymmetry(usePreySymmetry),
+  rootState(new RootState()),
+  incrementalStates(false)
 {
 }
 
@@ -26,12 +38,27 @@ void WorldMDP::setPreyPos(const Point2D &preyPos) {
   //std::cout << "setPreyPos(" << preyPos << ")" << std::endl;
 }
 
+void WorldMDP::setRNG(boost::shared_ptr<RNG> rng) {
+  this->rng = rng;
+  controller->setRNG(rng);
+}
+
 void WorldMDP::setState(const State_t &state) {
   //std::cout << "worldmdp setState: " << state << std::endl;
   Observation obs;
-  obs.preyInd = 0;
-  obs.positions.resize(STATE_SIZE);
-  getPositionsFromState(state,model->getDims(),obs.positions,preyPos,usePreySymmetry);
+  unsigned int numAgents = model->getNumAgents();
+  if (isStatePacked(numAgents)) {
+    obs.preyInd = 0;
+    obs.positions.resize(numAgents);
+    getPositionsFromState(state,model->getDims(),obs.positions,preyPos,usePreySymmetry);
+  } else {
+    // hashed states can't be unpacked, but the planner only returns to its root
+    if (!rootState->valid || (state != rootState->state)) {
+      std::cerr << "WorldMDP::setState: ERROR can only set a hashed state to the root state from getRootState" << std::endl;
+      exit(64);
+    }
+    obs = rootState->obs;
+  }
   obs.absPrey = this->preyPos;
   //std::cout << "setState(" << state << "): " << this->preyPos << " " << obs << std::endl;
   setState(obs);
@@ -48,11 +75,27 @@ void WorldMDP::setState(const Observation &obs) {
 }
 
 State_t WorldMDP::getState(const Observation &obs) {
+  if (incrementalStates) {
+    State_t state = zobrist->getKey(obs);
+    if (stateKeyCheck.get() != NULL)
+      checkStateKey(state,obs);
+    return state;
+  }
   State_t state = getStateFromObs(model->getDims(),obs,usePreySymmetry);
   //std::cout << "worldmdp getState: " << state << std::endl;
   return state;
 }
 
+State_t WorldMDP::getRootState(const Observation &obs) {
+  State_t state = getState(obs);
+  if (!isStatePacked(obs.positions.size())) {
+    rootState->state = state;
+    rootState->valid = true;
+    rootState->obs = obs;
+  }
+  return state;
+}
+
 void WorldMDP::step(Action::Type adhocAction) {//, std::vector<boost::shared_ptr<Agent> > &agents) {
   adhocAgent->setAction(adhocAction);
   controller->step();//agents);
@@ -75,9 +118,13 @@ void WorldMDP::takeAction(const Action::Type &action, float &reward, State_t &st
     terminal = false;
   }
 
-  Observation obs;
-  controller->generateObservation(obs);
-  state = getState(obs);
+  const Observation &obs = controller->getObservation();
+  if (incrementalStates) {
+    state = model->getStateKey();
+    if (stateKeyCheck.get() != NULL)
+      checkStateKey(state,obs);
+  } else
+    state = getState(obs);
   OUTPUT("post takeAction: " << obs);
   //std::cout << obs << std::endl;
   //for (unsigned int i = 0; i < STATE_SIZE; i++)
@@ -110,21 +157,24 @@ void WorldMDP::loadAgents() {
   setAgents(savedModel);
 }
 */
-double WorldMDP::getOutcomeProb(const Observation &prevObs, Action::Type adhocAction, const Observation &currentObs, std::vector<double> &agentProbs) {
-  adhocAgent->setAction(adhocAction);
-  double probApprox = controller->getOutcomeProbApprox(prevObs,currentObs,agentProbs);
-  //double probExact = controller->getOutcomeProb(prevObs,currentObs);
-  //std::cout << "probs: " << probApprox << " " << probExact << std::endl;
-  return probApprox;
-  //return probExact;
+double WorldMDP::getOutcomeProb(const Observation &prevObs, Action::Type adhocAction, const Observation &currentObs, std::vector<double> &agentProbs, bool exact) {
+  return controller->getOutcomeLikelihood(prevObs,currentObs,controller->getAgentInd(adhocAgent),adhocAction,agentProbs,exact);
 }
 
 boost::shared_ptr<AgentDummy> WorldMDP::getAdhocAgent() {
   return adhocAgent;
 }
 
+void WorldMDP::generateAdhocObservation(Observation &obs) {
+  controller->generateObservation(obs);
+  int ind = controller->getAgentInd(adhocAgent);
+  assert(ind >= 0);
+  obs.myInd = ind;
+}
+
 void WorldMDP::addAgent(const AgentModel &agentModel, boost::shared_ptr<Agent> agent) {
   controller->addAgent(agentModel,agent,true);
+  updateZobristTable(); // for the new agent
 }
 
 void WorldMDP::addAgents(const std::vector<AgentModel> &agentModels, const std::vector<boost::shared_ptr<Agent> > agents) {
@@ -136,6 +186,10 @@ void WorldMDP::addAgents(const std::vector<AgentModel> &agentModels, const std::
 void WorldMDP::learnControllers(const Observation &prevObs, const Observation &currentObs) {
   controller->learnControllers(prevObs,currentObs);
 }
+
+bool WorldMDP::canStepInParallel() const {
+  return controller->canStepAgentsInParallel();
+}
   
 boost::shared_ptr<WorldMDP> WorldMDP::clone() const {
   boost::shared_ptr<AgentDummy> newAdhocAgent;
@@ -147,11 +201,55 @@ boost::shared_ptr<WorldMDP> WorldMDP::clone() const {
   return mdp;
 }
 
+void WorldMDP::rewind(const WorldMDP &source) {
+  preyPos = source.preyPos;
+  controller->rewindAgents(*(source.controller));
+}
+
 void WorldMDP::setAdhocAgent(boost::shared_ptr<AgentDummy> adhocAgent) {
   this->adhocAgent = adhocAgent;
 }
-  
-//void WorldMDP::setCaching(bool cachingEnabled) {
-  //controller->setCaching(cachingEnabled);
-  //controller->setUncachedAgent(adhocAgent);
-//}
+
+void WorldMDP::setIncrementalStates(bool incrementalStates, bool verify) {
+  this->incrementalStates = incrementalStates;
+  if (incrementalStates && verify)
+    stateKeyCheck = boost::shared_ptr<StateKeyCheck>(new StateKeyCheck());
+  else
+    stateKeyCheck.reset();
+  updateZobristTable();
+}
+
+unsigned int WorldMDP::getNumStateKeyCollisions() const {
+  if (stateKeyCheck.get() == NULL)
+    return 0;
+  boost::mutex::scoped_lock lock(stateKeyCheck->mutex);
+  return stateKeyCheck->numCollisions;
+}
+
+bool WorldMDP::isStatePacked(unsigned int numAgents) const {
+  return !incrementalStates && isStatePackedExactly(model->getDims(),numAgents,usePreySymmetry);
+}
+
+void WorldMDP::updateZobristTable() {
+  if (incrementalStates)
+    zobrist = ZobristTable::get(model->getDims(),model->getNumAgents(),usePreySymmetry);
+  else
+    zobrist.reset();
+  model->setZobristTable(zobrist);
+}
+
+void WorldMDP::checkStateKey(State_t state, const Observation &obs) {
+  State_t expected = zobrist->getKey(obs);
+  if (state != expected) {
+    std::cerr << "WorldMDP::checkStateKey: ERROR incremental state key " << state << " doesn't match " << expected << " for " << obs << std::endl;
+    exit(68);
+  }
+  PositionList positions;
+  zobrist->getKeyedPositions(obs,positions);
+  boost::mutex::scoped_lock lock(stateKeyCheck->mutex);
+  FlatHashMap<State_t,PositionList>::iterator it = stateKeyCheck->positions.find(state);
+  if (it == stateKeyCheck->positions.end())
+    stateKeyCheck->positions[state] = positions;
+  else if (!samePositions(it->second,positions))
+    stateKeyCheck->numCollisions++;
+}
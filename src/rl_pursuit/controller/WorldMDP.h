@@ -6,13 +6,15 @@ File: WorldMDP.h
 Author: Samuel Barrett
 Description: an mdp wrapper of a world
 Created:  2011-08-23
-Modified: 2011-08-23
+Modified: 2013-08-19
 */
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
 #include <ostream>
 
 #include <rl_pursuit/planning/Model.h>
+#include <rl_pursuit/common/FlatHashMap.h>
 #include <rl_pursuit/common/RNG.h>
 #include <rl_pursuit/model/WorldModel.h>
 #include <rl_pursuit/controller/World.h>
@@ -26,33 +28,54 @@ public:
   WorldMDP(boost::shared_ptr<RNG> rng, boost::shared_ptr<WorldModel> model, boost::shared_ptr<World> controller, boost::shared_ptr<AgentDummy> adhocAgent, bool usePreySymmetry);
   
   virtual void setPreyPos(const Point2D &preyPos);
+  virtual void setRNG(boost::shared_ptr<RNG> rng);
   virtual void setState(const State_t &state);
   virtual void setState(const Observation &obs);
   virtual State_t getState(const Observation &obs);
+  // the state the planner searches from. When the states are hashed, it's
+  // remembered so setState can return to it
+  State_t getRootState(const Observation &obs);
+  // the states are Zobrist keys of the positions, which the world model
+  // updates as agents move instead of packing every agent after each step.
+  // Like hashed states, they can't be unpacked. With verify, every key is
+  // checked against one computed from scratch, and against the positions it
+  // was first seen with to count the collisions
+  void setIncrementalStates(bool incrementalStates, bool verify = false);
+  unsigned int getNumStateKeyCollisions() const;
 
   virtual void takeAction(const Action::Type &action, float &reward, State_t &state, bool &terminal);
   virtual void step(Action::Type adhocAction); //, std::vector<boost::shared_ptr<Agent> > &agents);
   virtual void learnControllers(const Observation &prevObs, const Observation &currentObs);
+  // whether clones can take actions in different threads at once
+  bool canStepInParallel() const;
   virtual float getRewardRangePerStep();
   virtual std::string generateDescription(unsigned int indentation = 0);
   void setAgents(const std::vector<boost::shared_ptr<Agent> > &agents);
-  double getOutcomeProb(const Observation &prevObs, Action::Type adhocAction, const Observation &currentObs, std::vector<double> &agentProbs);
+  // the likelihood of the observed step under this model, it leaves the mdp and its agents unchanged
+  double getOutcomeProb(const Observation &prevObs, Action::Type adhocAction, const Observation &currentObs, std::vector<double> &agentProbs, bool exact = false);
   boost::shared_ptr<AgentDummy> getAdhocAgent();
+  void generateAdhocObservation(Observation &obs); // what the adhoc agent would see in the current state
   virtual void addAgent(const AgentModel &agentModel, boost::shared_ptr<Agent> agent);
   virtual void addAgents(const std::vector<AgentModel> &agentModels, const std::vector<boost::shared_ptr<Agent> > agents);
   Point2D getDims() const {
     return model->getDims();
   }
+  const Geometry& getGeometry() const {
+    return model->getGeometry();
+  }
   virtual void setBeliefs(boost::shared_ptr<ModelUpdater> ) {
     // do nothing :)
   }
 
-  //virtual void setCaching(bool cachingEnabled);
-  //void resetCache() {
-    //controller->resetCache();
-  //}
+  void setCaching(unsigned int cacheSize) { // the ad hoc agent is never cached
+    controller->setCaching(cacheSize);
+  }
+  boost::shared_ptr<ActionCache> getActionCache() {
+    return controller->getActionCache();
+  }
 
   virtual boost::shared_ptr<WorldMDP> clone() const;
+  virtual void rewind(const WorldMDP &source); // resets a clone of source for reuse, call setState afterwards
   void setAdhocAgent(boost::shared_ptr<AgentDummy> adhocAgent);
 
 protected:
@@ -63,6 +86,28 @@ protected:
 
   Point2D preyPos;
   bool usePreySymmetry;
+
+  struct RootState {
+    RootState(): state(0), valid(false) {}
+    State_t state;
+    bool valid;
+    Observation obs;
+  };
+  boost::shared_ptr<RootState> rootState; // shared with the clones
+
+  bool incrementalStates;
+  boost::shared_ptr<const ZobristTable> zobrist;
+  struct StateKeyCheck {
+    StateKeyCheck(): numCollisions(0) {}
+    boost::mutex mutex;
+    FlatHashMap<State_t,PositionList> positions;
+    unsigned int numCollisions;
+  };
+  boost::shared_ptr<StateKeyCheck> stateKeyCheck; // shared with the clones, only when verifying
+
+  bool isStatePacked(unsigned int numAgents) const;
+  void updateZobristTable();
+  void checkStateKey(State_t state, const Observation &obs);
   
   friend class WorldMDPTest;
   friend class ModelUpdaterBayesTest;
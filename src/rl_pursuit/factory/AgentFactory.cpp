@@ -219,6 +219,7 @@ boost::shared_ptr<Agent> createAgent(boost::shared_ptr<RNG> rng, const Point2D &
       unsigned int depthFactor = plannerOptions.get("depthFactor",0).asUInt();
       plannerOptions["depth"] = depthFactor * (dims.x + dims.y);
     }
+    plannerOptions["numPredators"] = getNumPredators(rootOptions);
 
     double actionNoise = getActionNoise(rootOptions);
     bool centerPrey = getCenterPrey(rootOptions);
@@ -230,14 +231,20 @@ boost::shared_ptr<Agent> createAgent(boost::shared_ptr<RNG> rng, const Point2D &
     // create the value estimator
     boost::shared_ptr<ValueEstimator<State_t,Action::Type> > estimator = createValueEstimator(rng->randomUInt(),Action::NUM_ACTIONS,plannerOptions);
     // create the planner
-    boost::shared_ptr<MCTS<State_t,Action::Type> > mcts = createMCTS(estimator,modelUpdater,plannerOptions);
+    boost::shared_ptr<MCTS<State_t,Action::Type> > mcts = createMCTS(rng,estimator,modelUpdater,plannerOptions);
+    mcts->setStateMapping(createStateMapping(dims,predatorInd,plannerOptions));
     // create the quandry detector
     boost::shared_ptr<QuandryDetector> quandryDetector = createQuandryDetector(dims,plannerOptions);
     
     PredatorMCTS::Params p;
     p.fromJson(options);
 
-    return ptr(new PredatorMCTS(rng,dims,mcts,modelUpdater,quandryDetector,p));
+    boost::shared_ptr<PredatorMCTS> predator(new PredatorMCTS(rng,dims,mcts,modelUpdater,quandryDetector,p));
+    // the planner's profiling counters, one json line per episode
+    std::string profileFilename = rootOptions["save"].get("mctsProfile","").asString();
+    if (profileFilename != "")
+      predator->setProfileOutput(profileFilename,trialNum);
+    return predator;
   } else {
     std::cerr << "createAgent: unknown agent name: " << name << std::endl;
     exit(25);
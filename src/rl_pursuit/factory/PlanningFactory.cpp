@@ -3,7 +3,7 @@ File: PlanningFactory.cpp
 Author: Samuel Barrett
 Description: generates objects for planning
 Created:  2011-08-24
-Modified: 2011-10-02
+Modified: 2013-08-19
 */
 
 #include "PlanningFactory.h"
@@ -14,7 +14,11 @@ Modified: 2011-10-02
 //#include <rl_pursuit/controller/WorldSilverWeightedMDP.h>
 #include <rl_pursuit/controller/ModelUpdaterBayes.h>
 #include <rl_pursuit/controller/ModelUpdaterSilver.h>
+#include <rl_pursuit/controller/PredatorGreedyRolloutPolicy.h>
+#include <rl_pursuit/controller/SymmetricStateMapping.h>
 #include <rl_pursuit/planning/DualUCTEstimator.h>
+#include <rl_pursuit/planning/IdentityStateMapping.h>
+#include <rl_pursuit/planning/ParallelUCTEstimator.h>
 #include "WorldFactory.h"
 #include <rl_pursuit/controller/State.h>
 #include <rl_pursuit/controller/WorldBeliefMDP.h>
@@ -57,6 +61,7 @@ boost::shared_ptr<ModelUpdater> createModelUpdater(boost::shared_ptr<RNG> rng, b
   const Json::Value &models = options["models"];
   std::vector<ModelInfo> modelList;
   std::string currentStudent = options.get("student","UNKNOWN_STUDENT").asString();
+  unsigned int numPredators = getNumPredators(options); // the models must match the real world
 
   for (unsigned int i = 0; i < models.size(); i++) {
     bool modelPerStudent = models[i].get("modelPerStudent",false).asBool();
@@ -67,7 +72,9 @@ boost::shared_ptr<ModelUpdater> createModelUpdater(boost::shared_ptr<RNG> rng, b
     bool useListModels = models[i].get("useModelList",false).asBool();
 
     if (useListModels) {
-      createListModels(rng,mdp,dims,trialNum,replacementInd,currentStudent,models[i],modelList);
+      Json::Value listOptions(models[i]);
+      listOptions["numPredators"] = numPredators;
+      createListModels(rng,mdp,dims,trialNum,replacementInd,currentStudent,listOptions,modelList);
       continue;
     }
 
@@ -106,6 +113,7 @@ boost::shared_ptr<ModelUpdater> createModelUpdater(boost::shared_ptr<RNG> rng, b
           modelStudent += "-" + boost::lexical_cast<std::string>(treeInd);
         reps["$(MODEL_STUDENT)"] = modelStudent;
         jsonReplaceStrings(modelOptions,reps);
+        modelOptions["numPredators"] = numPredators;
         
         createAndAddModel(rng,mdp,dims,trialNum,replacementInd,modelOptions,modelList);
       }
@@ -144,13 +152,17 @@ boost::shared_ptr<ModelUpdater> createModelUpdater(boost::shared_ptr<RNG> rng, b
     boost::shared_ptr<std::ostream> outPrecision(new std::ofstream(modelPrecisionOutput.c_str()));
     ptr->enablePrecisionOutput(outPrecision);
   }
+  // update the models on a pool of threads, 0 updates them one at a time
+  unsigned int modelThreads = options.get("modelThreads",0).asUInt();
+  if (modelThreads > 0)
+    ptr->setNumThreads(modelThreads);
   return ptr;
 }
 
 void createAndAddModel(boost::shared_ptr<RNG> rng, boost::shared_ptr<WorldMDP> mdp, const Point2D &dims, unsigned int trialNum, int replacementInd, const Json::Value &modelOptions, std::vector<ModelInfo> &modelList) {
   double prob = modelOptions.get("prob",1.0).asDouble();
   std::string desc = modelOptions.get("desc","NO DESCRIPTION").asString();
-  //bool caching = modelOptions.get("cache",false).asBool();
+  unsigned int cacheSize = modelOptions.get("cacheSize",0).asUInt(); // 0 disables the action cache
 
   std::vector<AgentModel> agentModels;
   std::vector<AgentPtr> agents;
@@ -160,8 +172,7 @@ void createAndAddModel(boost::shared_ptr<RNG> rng, boost::shared_ptr<WorldMDP> m
   
   createAgentControllersAndModels(rng,dims,trialNum,replacementInd,modelOptions,adhocAgent,agents,agentModels);
   newMDP->addAgents(agentModels,agents);
-  //newMDP->setCaching(caching);
-  //newMDP->resetCache();
+  newMDP->setCaching(cacheSize);
 
   modelList.push_back(ModelInfo(newMDP,desc,prob));
 }
@@ -188,6 +199,7 @@ void createListModels(boost::shared_ptr<RNG> rng, boost::shared_ptr<WorldMDP> md
       std::cerr << "Error reading in model " << modelFile << " at location: " << modelFile << std::endl;
       exit(99);
     }
+    modelOptions["numPredators"] = getNumPredators(options);
     createAndAddModel(rng,mdp,dims,trialNum,replacementInd,modelOptions,modelList);
   }
 }
@@ -255,8 +267,27 @@ boost::shared_ptr<WorldMDP> createWorldMDP(boost::shared_ptr<RNG> rng, const Poi
   std::string updateTypeString = options.get("update","bayesian").asString();
   ModelUpdateType_t updateType = ModelUpdateType::fromName(updateTypeString);
 
+  bool incrementalStates = options.get("incrementalStates",false).asBool(); // Zobrist keys instead of packed states
+  bool verifyStateKeys = options.get("verifyStateKeys",false).asBool();
+
   StateConverter stateConverter = createStateConverter(options);
-  return createWorldMDP(rng,dims,usePreySymmetry,beliefMDP,updateType,stateConverter,actionNoise, centerPrey);
+  boost::shared_ptr<WorldMDP> mdp = createWorldMDP(rng,dims,usePreySymmetry,beliefMDP,updateType,stateConverter,actionNoise, centerPrey);
+  mdp->setIncrementalStates(incrementalStates,verifyStateKeys);
+  return mdp;
+}
+
+boost::shared_ptr<StateMapping<State_t,Action::Type> > createStateMapping(const Point2D &dims, int replacementInd, const Json::Value &options) {
+  bool symmetricStates = options.get("symmetricStates",false).asBool(); // rotations and reflections about the prey
+  bool interchangeableTeammates = options.get("interchangeableTeammates",false).asBool();
+  if (!symmetricStates && !interchangeableTeammates)
+    return boost::shared_ptr<StateMapping<State_t,Action::Type> >(new IdentityStateMapping<State_t,Action::Type>());
+  bool usePreySymmetry = options.get("preySymmetry",true).asBool();
+  if (options.get("incrementalStates",false).asBool()) {
+    std::cerr << "createStateMapping: ERROR, symmetric states need packed states, not incrementalStates" << std::endl;
+    exit(69);
+  }
+  unsigned int numAgents = getNumPredators(options) + 1;
+  return boost::shared_ptr<StateMapping<State_t,Action::Type> >(new SymmetricStateMapping(dims,numAgents,replacementInd + 1,usePreySymmetry,symmetricStates,interchangeableTeammates));
 }
 
 StateConverter createStateConverter(const Json::Value &options) {
@@ -269,31 +300,38 @@ StateConverter createStateConverter(const Json::Value &options) {
 
 ///////////////////////////////////////////////////////////////
 
-boost::shared_ptr<UCTEstimator<State_t,Action::Type> > createUCTEstimator(boost::shared_ptr<RNG> rng, Action::Type numActions, float lambda, float gamma, float rewardBound, float rewardRangePerStep, float initialValue, unsigned int initialStateVisits, unsigned int initialStateActionVisits, float unseenValue, bool theoreticallyCorrectLambda) {
-  return boost::shared_ptr<UCTEstimator<State_t,Action::Type> >(new UCTEstimator<State_t,Action::Type>(rng,numActions,lambda,gamma,rewardBound,rewardRangePerStep,initialValue,initialStateVisits,initialStateActionVisits,unseenValue,theoreticallyCorrectLambda));
+boost::shared_ptr<UCTEstimator<State_t,Action::Type> > createUCTEstimator(boost::shared_ptr<RNG> rng, const UCTEstimator<State_t,Action::Type>::Params &params) {
+  return boost::shared_ptr<UCTEstimator<State_t,Action::Type> >(new UCTEstimator<State_t,Action::Type>(rng,params));
 }
 
-boost::shared_ptr<ValueEstimator<State_t,Action::Type> > createValueEstimator(boost::shared_ptr<RNG> rng, Action::Type numActions, const Json::Value &options) {
-  float lambda = options.get("lambda",0.8).asDouble();
-  float gamma = options.get("gamma",0.95).asDouble();
-  float unseenValue = options.get("unseenValue",9999999).asDouble();
-  float initialValue = options.get("initialValue",0).asDouble();
-  float rewardBound = options.get("rewardBound",-1).asDouble();
-  float rewardRangePerStep = options.get("rewardRangePerStep",-1).asDouble();
+boost::shared_ptr<ValueEstimator<State_t,Action::Type> > createValueEstimator(boost::shared_ptr<RNG> rng, Action::Type /*numActions*/, const Json::Value &options) {
+  UCTEstimator<State_t,Action::Type>::Params uctParams;
+  uctParams.lambda = options.get("lambda",0.8).asDouble();
+  uctParams.gamma = options.get("gamma",0.95).asDouble();
+  uctParams.unseenValue = options.get("unseenValue",9999999).asDouble();
+  uctParams.initialValue = options.get("initialValue",0).asDouble();
+  uctParams.rewardBound = options.get("rewardBound",-1).asDouble();
+  uctParams.rewardRangePerStep = options.get("rewardRangePerStep",-1).asDouble();
 
-  unsigned int initialStateVisits = options.get("initialStateVisits",0).asUInt();
-  unsigned int initialStateActionVisits = options.get("initialStateActionVisits",0).asUInt();
-  bool theoreticallyCorrectLambda = options.get("theoreticallyCorrectLambda",true).asBool();
+  uctParams.initialStateVisits = options.get("initialStateVisits",0).asUInt();
+  uctParams.initialStateActionVisits = options.get("initialStateActionVisits",0).asUInt();
+  uctParams.theoreticallyCorrectLambda = options.get("theoreticallyCorrectLambda",true).asBool();
+  uctParams.trackNextStates = options.get("reuseTree",false).asBool(); // needed to find the subtree to keep
 
   bool dualUCT = options.get("dualUCT",false).asBool();
-  if (dualUCT) {
+  bool sharedTree = options.get("sharedTree",false).asBool();
+  if (sharedTree) {
+    ParallelUCTEstimator<State_t,Action::Type>::Params parallelParams;
+    parallelParams.fromJson(options);
+    return boost::shared_ptr<ValueEstimator<State_t,Action::Type> >(new ParallelUCTEstimator<State_t,Action::Type>(rng,uctParams,parallelParams));
+  } else if (dualUCT) {
     StateConverter stateConverter = createStateConverter(options);
     float b = options.get("dualUCTB",0.5).asDouble();
-    boost::shared_ptr<UCTEstimator<State_t,Action::Type> > mainValueEstimator = createUCTEstimator(rng,numActions,lambda,gamma,rewardBound,rewardRangePerStep,initialValue,initialStateVisits,initialStateActionVisits,unseenValue,theoreticallyCorrectLambda);
-    boost::shared_ptr<UCTEstimator<State_t,Action::Type> > generalValueEstimator = createUCTEstimator(rng,numActions,lambda,gamma,rewardBound,rewardRangePerStep,initialValue,initialStateVisits,initialStateActionVisits,unseenValue,theoreticallyCorrectLambda);
+    boost::shared_ptr<UCTEstimator<State_t,Action::Type> > mainValueEstimator = createUCTEstimator(rng,uctParams);
+    boost::shared_ptr<UCTEstimator<State_t,Action::Type> > generalValueEstimator = createUCTEstimator(rng,uctParams);
     return boost::shared_ptr<ValueEstimator<State_t,Action::Type> >(new DualUCTEstimator<State_t,Action::Type>(rng,mainValueEstimator,generalValueEstimator,b,stateConverter));
   } else {
-    return createUCTEstimator(rng,numActions,lambda,gamma,rewardBound,rewardRangePerStep,initialValue,initialStateVisits,initialStateActionVisits,unseenValue,theoreticallyCorrectLambda);
+    return createUCTEstimator(rng,uctParams);
   }
 }
 
@@ -303,15 +341,47 @@ boost::shared_ptr<ValueEstimator<State_t,Action::Type> > createValueEstimator(un
 
 ///////////////////////////////////////////////////////////////
 
-boost::shared_ptr<MCTS<State_t,Action::Type> > createMCTS(boost::shared_ptr<ValueEstimator<State_t,Action::Type> > valueEstimator,boost::shared_ptr<ModelUpdater> modelUpdater,unsigned int numPlayouts, double maxPlanningTime, unsigned int maxDepth, int pruningMemorySize) {
-  return boost::shared_ptr<MCTS<State_t,Action::Type> >(new MCTS<State_t,Action::Type>(valueEstimator,modelUpdater,numPlayouts,maxPlanningTime,maxDepth,pruningMemorySize));
+boost::shared_ptr<MCTS<State_t,Action::Type> > createMCTS(boost::shared_ptr<ValueEstimator<State_t,Action::Type> > valueEstimator,boost::shared_ptr<ModelUpdater> modelUpdater,unsigned int numPlayouts, double maxPlanningTime, unsigned int maxDepth, int pruningMemorySize, bool reuseTree, bool hardDeadline, bool expandOneNode) {
+  return boost::shared_ptr<MCTS<State_t,Action::Type> >(new MCTS<State_t,Action::Type>(valueEstimator,modelUpdater,numPlayouts,maxPlanningTime,maxDepth,pruningMemorySize,reuseTree,hardDeadline,expandOneNode));
 }
 
-boost::shared_ptr<MCTS<State_t,Action::Type> > createMCTS(boost::shared_ptr<ValueEstimator<State_t,Action::Type> > valueEstimator,boost::shared_ptr<ModelUpdater> modelUpdater,const Json::Value &options) {
+boost::shared_ptr<MCTS<State_t,Action::Type> > createMCTS(boost::shared_ptr<RNG> rng, boost::shared_ptr<ValueEstimator<State_t,Action::Type> > valueEstimator,boost::shared_ptr<ModelUpdater> modelUpdater,const Json::Value &options) {
   unsigned int numPlayouts = options.get("playouts",0).asUInt();
   double maxPlanningTime = options.get("time",0.0).asDouble();
   unsigned int maxDepth = options.get("depth",0).asUInt();
   int pruningMemorySize = options.get("pruningMemory",-1).asInt();
+  bool reuseTree = options.get("reuseTree",false).asBool();
+  bool hardDeadline = options.get("hardDeadline",true).asBool(); // false lets rollouts finish past the time limit
+  bool expandOneNode = options.get("expandOneNode",false).asBool();
+  std::string rolloutPolicy = options.get("rolloutPolicy","").asString();
+  unsigned int numThreads = options.get("numThreads",1).asUInt();
+  if ((numThreads > 1) && !modelUpdater->canSelectModelsInParallel()) {
+    // rather than failing in the middle of the first search
+    std::cerr << "createMCTS: ERROR, numThreads > 1 needs a model updater that can select models from several threads, like bayesian updates, and models whose agents can step in parallel" << std::endl;
+    exit(71);
+  }
 
-  return createMCTS(valueEstimator,modelUpdater,numPlayouts,maxPlanningTime,maxDepth,pruningMemorySize);
+  boost::shared_ptr<MCTS<State_t,Action::Type> > mcts = createMCTS(valueEstimator,modelUpdater,numPlayouts,maxPlanningTime,maxDepth,pruningMemorySize,reuseTree,hardDeadline,expandOneNode);
+  bool sharedTree = options.get("sharedTree",false).asBool();
+  // root parallel workers, each with its own tree and random stream,
+  // or with sharedTree all of them search the main estimator's tree
+  for (unsigned int i = 1; i < numThreads; i++) {
+    boost::shared_ptr<ValueEstimator<State_t,Action::Type> > workerValueEstimator;
+    if (sharedTree)
+      workerValueEstimator = valueEstimator;
+    else
+      workerValueEstimator = createValueEstimator(rng->randomUInt(),Action::NUM_ACTIONS,options);
+    // a stream jumped ahead of this one, so the workers never overlap it or each other
+    mcts->addWorker(workerValueEstimator,boost::shared_ptr<RNG>(new RNG(rng->getStream(i))));
+  }
+  // finishes the rollouts past the expanded node, by default it's uniformly random
+  if (rolloutPolicy == "greedy")
+    mcts->setRolloutPolicy(boost::shared_ptr<RolloutPolicy<State_t,Action::Type> >(new PredatorGreedyRolloutPolicy()),makeRNG(rng->randomUInt()));
+  else if ((rolloutPolicy == "random") || ((rolloutPolicy == "") && expandOneNode))
+    mcts->setRolloutPolicy(boost::shared_ptr<RolloutPolicy<State_t,Action::Type> >(new RandomRolloutPolicy<State_t,Action::Type>()),makeRNG(rng->randomUInt()));
+  else if (rolloutPolicy != "") {
+    std::cerr << "createMCTS: ERROR, unknown rolloutPolicy: " << rolloutPolicy << std::endl;
+    exit(63);
+  }
+  return mcts;
 }
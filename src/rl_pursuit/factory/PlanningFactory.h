@@ -6,7 +6,7 @@ File: PlanningFactory.h
 Author: Samuel Barrett
 Description: generates objects for planning
 Created:  2011-08-24
-Modified: 2011-12-13
+Modified: 2013-08-19
 */
 
 #include <set>
@@ -44,16 +44,20 @@ boost::shared_ptr<WorldMDP> createWorldMDP(boost::shared_ptr<RNG> rng, const Poi
 
 // VALUE ESTIMATORS
 
-boost::shared_ptr<UCTEstimator<State_t,Action::Type> > createUCTEstimator(boost::shared_ptr<RNG> rng, Action::Type numActions, float lambda, float gamma, float rewardBound, float rewardRangePerStep, float initialValue, unsigned int initialStateVisits, unsigned int initalStateActionVisits, float unseenValue, bool theoreticallyCorrectLambda);
+boost::shared_ptr<UCTEstimator<State_t,Action::Type> > createUCTEstimator(boost::shared_ptr<RNG> rng, const UCTEstimator<State_t,Action::Type>::Params &params);
 
 boost::shared_ptr<ValueEstimator<State_t,Action::Type> > createValueEstimator(boost::shared_ptr<RNG> rng, Action::Type numActions, const Json::Value &options);
 
 boost::shared_ptr<ValueEstimator<State_t,Action::Type> > createValueEstimator(unsigned int randomSeed, Action::Type numActions, const Json::Value &options);
 
 // MCTS
-boost::shared_ptr<MCTS<State_t,Action::Type> > createMCTS(boost::shared_ptr<ValueEstimator<State_t,Action::Type> > valueEstimator,boost::shared_ptr<ModelUpdater> modelUpdater,unsigned int numPlayouts, double maxPlanningTime, unsigned int maxDepth, int pruningMemorySize);
+boost::shared_ptr<MCTS<State_t,Action::Type> > createMCTS(boost::shared_ptr<ValueEstimator<State_t,Action::Type> > valueEstimator,boost::shared_ptr<ModelUpdater> modelUpdater,unsigned int numPlayouts, double maxPlanningTime, unsigned int maxDepth, int pruningMemorySize, bool reuseTree, bool hardDeadline, bool expandOneNode);
 
-boost::shared_ptr<MCTS<State_t,Action::Type> > createMCTS(boost::shared_ptr<ValueEstimator<State_t,Action::Type> > valueEstimator,boost::shared_ptr<ModelUpdater> modelUpdater,const Json::Value &options);
+boost::shared_ptr<MCTS<State_t,Action::Type> > createMCTS(boost::shared_ptr<RNG> rng, boost::shared_ptr<ValueEstimator<State_t,Action::Type> > valueEstimator,boost::shared_ptr<ModelUpdater> modelUpdater,const Json::Value &options);
+
+// maps symmetric states to the same state for the planner, replacementInd is
+// the ad hoc agent's index among the predators
+boost::shared_ptr<StateMapping<State_t,Action::Type> > createStateMapping(const Point2D &dims, int replacementInd, const Json::Value &options);
 
 StateConverter createStateConverter(const Json::Value &options);
 
@@ -33,10 +33,9 @@ boost::shared_ptr<World> createWorld(unsigned int randomSeed, boost::shared_ptr<
   return createWorld(rng,model,actionNoise,centerPrey);
 }
 
-void createAgentModels(int replacementInd, std::vector<AgentModel> &agentModels) {
-  int numPredators = 4; // can later change this to an option
+void createAgentModels(int replacementInd, std::vector<AgentModel> &agentModels, unsigned int numPredators) {
   agentModels.push_back(AgentModel(0,0,PREY));
-  for (int predatorInd = 0; predatorInd < numPredators; predatorInd++) {
+  for (int predatorInd = 0; predatorInd < (int)numPredators; predatorInd++) {
     if (predatorInd == replacementInd)
       agentModels.push_back(AgentModel(0,0,ADHOC));
     else
@@ -57,7 +56,7 @@ void createAgentControllersAndModels(boost::shared_ptr<RNG> rng, const Point2D &
   const Json::Value adhocOptions = options["adhocOptions"];
   bool sharePredator = predatorOptions.get("shared",false).asBool();
 
-  createAgentModels(replacementInd,agentModels);
+  createAgentModels(replacementInd,agentModels,getNumPredators(options));
   
   boost::shared_ptr<Agent> agent;
   boost::shared_ptr<Agent> agentPredator;
@@ -134,3 +133,7 @@ double getActionNoise(const Json::Value &options) {
 bool getCenterPrey(const Json::Value &options) {
   return options.get("centerPrey",true).asBool();
 }
+
+unsigned int getNumPredators(const Json::Value &options) {
+  return options.get("numPredators",DEFAULT_NUM_PREDATORS).asUInt();
+}
@@ -15,6 +15,8 @@ Modified: 2011-08-23
 #include <rl_pursuit/controller/World.h>
 #include "AgentFactory.h"
 
+const unsigned int DEFAULT_NUM_PREDATORS = 4;
+
 int getReplacementInd(unsigned int trialNum);
 
 // world models
@@ -26,7 +28,7 @@ boost::shared_ptr<World> createWorld(boost::shared_ptr<RNG> rng, const Point2D &
 boost::shared_ptr<World> createWorld(unsigned int randomSeed, boost::shared_ptr<WorldModel> model, double actionNoise, bool centerPrey);
 
 // just agents
-void createAgentModels(int replacementInd, std::vector<AgentModel> &agentModels);
+void createAgentModels(int replacementInd, std::vector<AgentModel> &agentModels, unsigned int numPredators = DEFAULT_NUM_PREDATORS);
 void createAgentControllersAndModels(boost::shared_ptr<RNG> rng, const Point2D &dims, unsigned int trialNum, int replacementInd, const Json::Value &options, std::vector<boost::shared_ptr<Agent> > &agentControllers, std::vector<AgentModel> &agentModels);
 void createAgentControllersAndModels(boost::shared_ptr<RNG> rng, const Point2D &dims, unsigned int trialNum, int replacementInd, const Json::Value &options, boost::shared_ptr<Agent> adhocAgent, std::vector<boost::shared_ptr<Agent> > &agentControllers, std::vector<AgentModel> &agentModels);
 
@@ -42,5 +44,6 @@ boost::shared_ptr<World> createWorldAgents(unsigned int randomSeed, boost::share
 Point2D getDims(const Json::Value &options);
 double getActionNoise(const Json::Value &options);
 bool getCenterPrey(const Json::Value &options);
+unsigned int getNumPredators(const Json::Value &options);
 
 #endif /* end of include guard: WORLDFACTORY_NNNSUN1M */
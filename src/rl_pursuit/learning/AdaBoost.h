@@ -6,7 +6,7 @@ File: AdaBoost.h
 Author: Samuel Barrett
 Description: AdaBoost algorithm, with support for inheritance
 Created:  2012-01-16
-Modified: 2012-01-16
+Modified: 2013-08-19
 */
 
 #include "Classifier.h"
@@ -26,6 +26,9 @@ public:
   
   virtual void save(const std::string &filename) const;
   virtual bool load(const std::string &filename);
+  bool canClassifyInParallel() const {
+    return Classifier::canClassifyInParallel() && ::canClassifyInParallel(classifiers);
+  }
 
 protected:
   virtual void trainInternal(bool incremental);
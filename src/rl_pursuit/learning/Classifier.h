@@ -6,7 +6,7 @@ File: Classifier.h
 Author: Samuel Barrett
 Description: abstract classifier
 Created:  2011-11-22
-Modified: 2011-12-27
+Modified: 2013-08-19
 */
 
 #include <boost/unordered_map.hpp>
@@ -23,6 +23,10 @@ public:
   virtual ~Classifier() {}
   void train(bool incremental=true);
   void classify(const InstancePtr &instance, Classification &classification);
+  // true if classify only reads the classifier, so several threads can call it at once
+  virtual bool canClassifyInParallel() const {
+    return !caching;
+  }
   virtual void addData(const InstancePtr &instance) = 0;
   virtual void addSourceData(const InstancePtr &instance) {
     addData(instance); // same unless we're doing transfer
@@ -6,7 +6,7 @@ File: Committee.h
 Author: Samuel Barrett
 Description: committee of classifiers
 Created:  2012-08-09
-Modified: 2012-08-09
+Modified: 2013-08-19
 */
 
 #include "Classifier.h"
@@ -28,6 +28,9 @@ public:
   virtual void save(const std::string &filename) const;
   virtual bool load(const std::string &filename);
   virtual void clearData();
+  bool canClassifyInParallel() const {
+    return Classifier::canClassifyInParallel() && ::canClassifyInParallel(classifiers);
+  }
 
 protected:
   virtual void trainInternal(bool incremental);
@@ -3,14 +3,16 @@ File: FeatureExtractor.cpp
 Author: Samuel Barrett
 Description: extracts a set of features of the agents
 Created:  2011-10-28
-Modified: 2011-12-10
+Modified: 2013-08-19
 */
 
 #include "FeatureExtractor.h"
+#include <algorithm>
 #include <boost/lexical_cast.hpp>
 #include <rl_pursuit/factory/AgentFactory.h>
 
 const unsigned int FeatureExtractor::HISTORY_SIZE = 2;
+const unsigned int FeatureExtractor::NUM_PREDATOR_FEATURES = (FeatureType::Pred3_dx - FeatureType::Pred0_dx) / 2 + 1;
 const bool FeatureExtractor::USE_ALL_AGENTS_HISTORY = false;
 
 //#define FEATURE_EXTRACTOR_TIMING
@@ -55,7 +57,8 @@ void FeatureExtractorHistory::reset() {
 }
 
 FeatureExtractor::FeatureExtractor(const Point2D &dims):
-  dims(dims)
+  dims(dims),
+  geometry(Geometry::get(dims))
 {
 }
 
@@ -72,20 +75,26 @@ InstancePtr FeatureExtractor::extract(const Observation &obs, FeatureExtractorHi
   InstancePtr instance(new Instance);
   
   TIC(pos);
-  setFeature(instance,FeatureType::PredInd,obs.myInd - 1);
+  SmallVector<unsigned int,MAX_INLINE_AGENTS> featureInds;
+  getFeatureAgents(obs,featureInds);
+  unsigned int predInd = obs.myInd - 1;
   // positions of agents
-  for (unsigned int i = 0; i < obs.positions.size(); i++) {
-    Point2D diff = getDifferenceToPoint(dims,obs.myPos(),obs.positions[i]);
-    unsigned int key = FeatureType::Prey_dx + 2 * i;
+  for (unsigned int j = 0; j < featureInds.size(); j++) {
+    unsigned int i = featureInds[j];
+    if (i == obs.myInd)
+      predInd = j - 1;
+    Point2D diff = geometry->getDifferenceToPoint(obs.myPos(),obs.positions[i]);
+    unsigned int key = FeatureType::Prey_dx + 2 * j;
     setFeature(instance,key,diff.x);
     setFeature(instance,key+1,diff.y);
   }
+  setFeature(instance,FeatureType::PredInd,predInd);
   TOC(pos);
   // derived features
   TIC(derived);
   bool next2prey = false;
   for (unsigned int a = 0; a < Action::NUM_NEIGHBORS; a++) {
-    Point2D pos = movePosition(dims,obs.myPos(),(Action::Type)a);
+    Point2D pos = geometry->movePosition(obs.myPos(),(Action::Type)a);
     bool occupied = false;
     for (unsigned int i = 0; i < obs.positions.size(); i++) {
       if (i == obs.myInd)
@@ -156,6 +165,36 @@ InstancePtr FeatureExtractor::extract(const Observation &obs, FeatureExtractorHi
   return instance;
 }
 
+struct CloserTeammate {
+  CloserTeammate(const SmallVector<int,MAX_INLINE_AGENTS> &dists): dists(dists) {}
+  bool operator()(unsigned int a, unsigned int b) const {
+    if (dists[a] != dists[b])
+      return dists[a] < dists[b];
+    return a < b;
+  }
+  const SmallVector<int,MAX_INLINE_AGENTS> &dists;
+};
+
+void FeatureExtractor::getFeatureAgents(const Observation &obs, SmallVector<unsigned int,MAX_INLINE_AGENTS> &inds) {
+  inds.clear();
+  for (unsigned int i = 0; i < obs.positions.size(); i++)
+    inds.push_back(i);
+  if (obs.positions.size() <= NUM_PREDATOR_FEATURES + 1)
+    return;
+  // too many predators for the features, so keep this one and its closest
+  // teammates, in index order
+  SmallVector<int,MAX_INLINE_AGENTS> dists(obs.positions.size());
+  for (unsigned int i = 0; i < obs.positions.size(); i++) {
+    if (((int)i == obs.preyInd) || (i == obs.myInd))
+      dists[i] = -1;
+    else
+      dists[i] = geometry->getDistanceToPoint(obs.myPos(),obs.positions[i]);
+  }
+  std::partial_sort(inds.begin(),inds.begin() + NUM_PREDATOR_FEATURES + 1,inds.end(),CloserTeammate(dists));
+  inds.resize(NUM_PREDATOR_FEATURES + 1);
+  std::sort(inds.begin(),inds.end());
+}
+
 void FeatureExtractor::updateHistory(const Observation &obs, FeatureExtractorHistory &history) {
   std::vector<Action::Type> observedActions;
   if (history.initialized) {
@@ -179,11 +218,11 @@ void FeatureExtractor::updateHistory(const Observation &obs, FeatureExtractorHis
 void FeatureExtractor::calcObservedActions(Observation prevObs, Observation obs, std::vector<Action::Type> &actions) {
   actions.resize(prevObs.positions.size());
   TIC(historyuncenter);
-  prevObs.uncenterPrey(dims);
-  obs.uncenterPrey(dims);
+  prevObs.uncenterPrey(*geometry);
+  obs.uncenterPrey(*geometry);
   TOC(historyuncenter);
   //std::cout << prevObs << " " << obs << std::endl << std::flush;
-  bool prevCapture = obs.didPreyMoveIllegally(dims,prevObs.absPrey);
+  bool prevCapture = obs.didPreyMoveIllegally(*geometry,prevObs.absPrey);
   for (unsigned int i = 0; i < prevObs.positions.size(); i++) {
     // skip if the prey was captured last step
     if (prevCapture && ((int)i == obs.preyInd)) {
@@ -191,7 +230,7 @@ void FeatureExtractor::calcObservedActions(Observation prevObs, Observation obs,
       continue;
     }
     TIC(historydiff);
-    Point2D diff = getDifferenceToPoint(dims,prevObs.positions[i],obs.positions[i]);
+    Point2D diff = geometry->getDifferenceToPoint(prevObs.positions[i],obs.positions[i]);
     TOC(historydiff);
     TIC(historyaction);
     //actions.push_back(getAction(diff));
@@ -6,11 +6,12 @@ File: FeatureExtractor.h
 Author: Samuel Barrett
 Description: extracts a set of features of the agents
 Created:  2011-10-28
-Modified: 2011-12-10
+Modified: 2013-08-19
 */
 
 #include <deque>
 #include <rl_pursuit/model/Common.h>
+#include <rl_pursuit/model/Geometry.h>
 #include <rl_pursuit/common/Point2D.h>
 #include "Classifier.h"
 #include <rl_pursuit/controller/Agent.h>
@@ -51,15 +52,20 @@ protected:
     (*instance)[key] = val;
   }
 
+  // the agents that fill the position features, the prey and then predators
+  void getFeatureAgents(const Observation &obs, SmallVector<unsigned int,MAX_INLINE_AGENTS> &inds);
+
 
 protected:
   const Point2D dims;
+  boost::shared_ptr<const Geometry> geometry;
   std::vector<FeatureAgent> featureAgents;
   std::vector<std::string> featureKeys;
   unsigned int keyInd;
 
 public:
   static const unsigned int HISTORY_SIZE;
+  static const unsigned int NUM_PREDATOR_FEATURES; // predators with position features
   static const bool USE_ALL_AGENTS_HISTORY;
 };
 
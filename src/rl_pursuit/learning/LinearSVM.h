@@ -22,6 +22,9 @@ public:
   virtual void save(const std::string &filename) const;
   virtual bool load(const std::string &filename);
   virtual void clearData();
+  bool canClassifyInParallel() const {
+    return false; // the instance is converted into a member buffer
+  }
   virtual LinearSVM* copyWithWeights(const InstanceSet &data);
 
 protected:
@@ -17,6 +17,9 @@ public:
   virtual void save(const std::string &filename) const;
   virtual bool load(const std::string &filename);
   virtual void clearData();
+  bool canClassifyInParallel() const {
+    return false; // the instance is converted into a member buffer
+  }
 
 protected:
   virtual void trainInternal(bool incremental);
@@ -110,3 +110,11 @@ void convertWekaToDT(ClassifierPtr &c) {
     remove(filename.c_str());
   }
 }
+
+bool canClassifyInParallel(const std::vector<SubClassifier> &classifiers) {
+  for (unsigned int i = 0; i < classifiers.size(); i++) {
+    if (!classifiers[i].classifier->canClassifyInParallel())
+      return false;
+  }
+  return true;
+}
@@ -6,7 +6,7 @@ File: SubClassifier.h
 Author: Samuel Barrett
 Description: A sub classifier and some helper functions
 Created:  2012-09-10
-Modified: 2012-09-10
+Modified: 2013-08-19
 */
 
 #include "Classifier.h"
@@ -25,6 +25,7 @@ bool createAndLoadSubClassifiers(std::vector<SubClassifier> &classifiers, const
 bool createAndLoadSubClassifiers(std::vector<SubClassifier> &classifiers, const std::string &filename, const std::vector<Feature> &features, const std::vector<SubClassifierGenerator> &possibleBaseLearners, const std::vector<Json::Value> &possibleBaseLearnerOptions);
 
 bool loadSubClassifiers(std::vector<SubClassifier> &classifiers, const std::string &filename);
+bool canClassifyInParallel(const std::vector<SubClassifier> &classifiers);
 
 void convertWekaToDT(SubClassifier &c);
 void convertWekaToDT(ClassifierPtr &c);
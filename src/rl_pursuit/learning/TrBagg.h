@@ -6,7 +6,7 @@ File: TrBagg.h
 Author: Samuel Barrett
 Description: implementation of the TrBagg algorithm
 Created:  2012-01-18
-Modified: 2012-01-18
+Modified: 2013-08-19
 */
 
 #include "Classifier.h"
@@ -24,6 +24,9 @@ public:
   virtual bool load(const std::string &filename);
   bool partialLoad(const std::string &filename);
   virtual void clearData();
+  bool canClassifyInParallel() const {
+    return Classifier::canClassifyInParallel() && ::canClassifyInParallel(classifiers);
+  }
 
 protected:
   virtual void trainInternal(bool incremental);
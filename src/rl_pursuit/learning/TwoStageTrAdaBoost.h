@@ -6,7 +6,7 @@ File: TwoStageTrAdaBoost.h
 Author: Samuel Barrett
 Description: two stage tradaboost - taken from David Pardoe's thesis
 Created:  2012-01-20
-Modified: 2012-01-20
+Modified: 2013-08-19
 */
 
 #include "SubClassifier.h"
@@ -40,6 +40,9 @@ public:
   void setTrainFinalModel(bool b = true) {
     trainFinalModel = b;
   }
+  bool canClassifyInParallel() const {
+    return Classifier::canClassifyInParallel() && ((model.get() == NULL) || model->canClassifyInParallel());
+  }
 
 protected:
   virtual void trainInternal(bool incremental);
@@ -35,6 +35,9 @@ public:
     model.clearData();
     targetData.clearData();
   }
+  bool canClassifyInParallel() const {
+    return Classifier::canClassifyInParallel() && model.canClassifyInParallel();
+  }
 
 protected:
   virtual void trainInternal(bool incremental);
@@ -6,7 +6,7 @@ File: WekaClassifier.h
 Author: Samuel Barrett
 Description: interfaces with weka and moa
 Created:  2011-12-26
-Modified: 2011-12-26
+Modified: 2013-08-19
 */
 
 #include "Classifier.h"
@@ -24,6 +24,9 @@ public:
   virtual void save(const std::string &filename) const;
   virtual bool load(const std::string &filename);
   virtual void clearData();
+  bool canClassifyInParallel() const {
+    return false; // there is only one connection to the weka process
+  }
 
   void outputDescriptionToFile(const std::string &filename) const;
 
@@ -3,10 +3,11 @@ File: Common.cpp
 Author: Samuel Barrett
 Description: some common info for the pursuit domain
 Created:  2011-08-22
-Modified: 2011-08-30
+Modified: 2013-08-19
 */
 
 #include "Common.h"
+#include "Geometry.h"
 #include <cassert>
 #include <cmath>
 #include <iostream>
@@ -48,8 +49,12 @@ const float& ActionProbs::operator[](Action::Type ind) const {
   return probs[ind];
 }
 
-Action::Type ActionProbs::selectAction(boost::shared_ptr<RNG> rng) {
-  float x = rng->randomFloat();
+Action::Type ActionProbs::selectAction(const boost::shared_ptr<RNG> &rng) {
+  return selectAction(*rng);
+}
+
+Action::Type ActionProbs::selectAction(RNG &rng) {
+  float x = rng.randomFloat();
   float total = 0;
   for (unsigned int i = 0; i < Action::NUM_MOVES; i++) {
     total += probs[i];
@@ -59,6 +64,19 @@ Action::Type ActionProbs::selectAction(boost::shared_ptr<RNG> rng) {
   return (Action::Type)(Action::NUM_MOVES-1);
 }
 
+void ActionProbs::addNoise(double actionNoise) {
+  double origWeight = 1 - actionNoise;
+  double noiseWeight = 0;
+  for (unsigned int i = 0; i < Action::NUM_NEIGHBORS; i++) {
+    noiseWeight += actionNoise * probs[i];
+    probs[i] *= origWeight;
+  }
+  noiseWeight /= Action::NUM_ACTIONS;
+  for (unsigned int i = 0; i < Action::NUM_ACTIONS; i++) {
+    probs[i] += noiseWeight;
+  }
+}
+
 bool ActionProbs::checkTotal() {
   float total = 0;
   for (unsigned int i = 0; i < Action::NUM_MOVES; i++)
@@ -156,6 +174,8 @@ Point2D getDifferenceToPoint(const Point2D &dims, const Point2D &start, const Po
 }
 
 Observation::Observation():
+  preyInd(-1),
+  myInd(0),
   prevPreyCaptured(false)
 {
 }
@@ -203,20 +223,21 @@ bool Observation::operator==(const Observation &other) const {
   return true;
 }
 
-void Observation::centerPrey(const Point2D &dims) {
-  if (positions[preyInd] == 0.5f * dims)
+void Observation::centerPrey(const Geometry &geometry) {
+  Point2D center = 0.5f * geometry.getDims();
+  if (positions[preyInd] == center)
     return;
-  Point2D offset = 0.5f * dims - absPrey;
+  Point2D offset = center - absPrey;
   for (unsigned int i = 0; i < positions.size(); i++)
-    positions[i] = movePosition(dims,positions[i],offset);
+    positions[i] = geometry.movePosition(positions[i],offset);
 }
 
-void Observation::uncenterPrey(const Point2D &dims) {
+void Observation::uncenterPrey(const Geometry &geometry) {
   if (absPrey == preyPos())
     return;
   Point2D offset = absPrey - preyPos();
   for (unsigned int i = 0; i < positions.size(); i++)
-    positions[i] = movePosition(dims,positions[i],offset);
+    positions[i] = geometry.movePosition(positions[i],offset);
 }
 /*
 bool Observation::isPreyCaptured(const Point2D &dims) const {
@@ -231,7 +252,7 @@ bool Observation::isPreyCaptured(const Point2D &dims) const {
 }
 */
   
-bool Observation::didPreyMoveIllegally(const Point2D &dims, const Point2D &prevAbsPrey) {
-  unsigned int dist = getDistanceToPoint(dims,absPrey,prevAbsPrey);
+bool Observation::didPreyMoveIllegally(const Geometry &geometry, const Point2D &prevAbsPrey) {
+  unsigned int dist = geometry.getDistanceToPoint(absPrey,prevAbsPrey);
   return (dist > 1);
 }
@@ -14,6 +14,7 @@ Modified: 2011-08-30
 #include <boost/shared_ptr.hpp>
 #include <rl_pursuit/common/Point2D.h>
 #include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/common/SmallVector.h>
 
 #ifdef __GNUC__
 #define VARIABLE_IS_NOT_USED __attribute__ ((unused))
@@ -46,7 +47,9 @@ public:
   void reset();
   float& operator[](Action::Type ind);
   const float& operator[](Action::Type ind) const;
-  Action::Type selectAction(boost::shared_ptr<RNG> rng);
+  Action::Type selectAction(const boost::shared_ptr<RNG> &rng);
+  Action::Type selectAction(RNG &rng);
+  void addNoise(double actionNoise); // mixes in a uniform distribution over the actions
   bool checkTotal();
   Action::Type maxAction();
   float overlap(const ActionProbs &other) const;
@@ -62,9 +65,16 @@ Point2D movePosition(const Point2D &dims, Point2D pos, const Point2D &move);
 unsigned int getDistanceToPoint(const Point2D &dims, const Point2D &pos1, const Point2D &pos2);
 Point2D getDifferenceToPoint(const Point2D &dims, const Point2D &start, const Point2D &end);
 
+// the positions of this many agents are stored inline, so observations in the
+// simulation don't allocate
+const unsigned int MAX_INLINE_AGENTS = 8;
+typedef SmallVector<Point2D,MAX_INLINE_AGENTS> PositionList;
+
+class Geometry;
+
 struct Observation {
   Observation();
-  std::vector<Point2D> positions;
+  PositionList positions;
   int preyInd;
   unsigned int myInd;
   Point2D absPrey;
@@ -75,10 +85,10 @@ struct Observation {
   int getCollision(const Point2D &pos) const;
   bool operator==(const Observation &other) const;
 
-  void centerPrey(const Point2D &dims);
-  void uncenterPrey(const Point2D &dims);
+  void centerPrey(const Geometry &geometry);
+  void uncenterPrey(const Geometry &geometry);
   //bool isPreyCaptured(const Point2D &dims) const;
-  bool didPreyMoveIllegally(const Point2D &dims, const Point2D &prevAbsPrey);
+  bool didPreyMoveIllegally(const Geometry &geometry, const Point2D &prevAbsPrey);
 };
 
 std::ostream& operator<<(std::ostream &out, const Observation &obs) ;
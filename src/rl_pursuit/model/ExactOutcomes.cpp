@@ -0,0 +1,315 @@
+/*
+File: ExactOutcomes.cpp
+Author: Samuel Barrett
+Description: the exact distribution over the positions after one world step
+Created:  2013-08-18
+Modified: 2013-08-18
+*/
+
+#include "ExactOutcomes.h"
+#include <cassert>
+#include <cstdlib>
+#include <iostream>
+
+ExactOutcomes::ExactOutcomes(const Point2D &dims):
+  geometry(Geometry::get(dims)),
+  layer(64),
+  nextLayer(64)
+{
+}
+
+double ExactOutcomes::getProb(const PositionList &startPositions, const std::vector<ActionProbs> &actionProbs, const PositionList &endPositions, int unconstrainedInd, std::vector<double> &groupProbs) {
+  assert(startPositions.size() == actionProbs.size());
+  assert(endPositions.size() == actionProbs.size());
+  unsigned int numAgents = actionProbs.size();
+  groupProbs.assign(numAgents,0.0);
+  setCandidates(startPositions,actionProbs);
+  removeInconsistentCandidates(startPositions,endPositions,unconstrainedInd);
+  for (unsigned int i = 0; i < numAgents; i++) {
+    if (candidates[i].size() == 0)
+      return 0;
+  }
+  findGroups(startPositions);
+
+  double prob = 1.0;
+  for (unsigned int groupInd = 0; groupInd < groups.size(); groupInd++) {
+    const std::vector<unsigned int> &group = groups[groupInd];
+    double groupProb = 0;
+    do {
+      double combinationProb = setOrdering(group,startPositions);
+      runOrderings(startPositions,&endPositions,unconstrainedInd);
+      // every ordering left matches the end positions
+      for (FlatHashMap<uint64_t,double>::iterator it = layer.begin(); it != layer.end(); ++it)
+        groupProb += combinationProb * it->second;
+    } while (nextCombination(group));
+    for (unsigned int i = 0; i < group.size(); i++)
+      groupProbs[group[i]] = groupProb;
+    prob *= groupProb;
+    if (prob == 0)
+      break;
+  }
+  return prob;
+}
+
+void ExactOutcomes::getOutcomes(const PositionList &startPositions, const std::vector<ActionProbs> &actionProbs, std::vector<PositionOutcome> &outcomes) {
+  assert(startPositions.size() == actionProbs.size());
+  setCandidates(startPositions,actionProbs);
+  findGroups(startPositions);
+
+  outcomes.resize(1);
+  outcomes[0].positions = startPositions;
+  outcomes[0].prob = 1.0;
+  std::map<std::vector<Point2D>,double> groupOutcomes;
+  std::vector<Point2D> positions;
+  for (unsigned int groupInd = 0; groupInd < groups.size(); groupInd++) {
+    const std::vector<unsigned int> &group = groups[groupInd];
+    // the distribution over the positions of this group
+    groupOutcomes.clear();
+    do {
+      double combinationProb = setOrdering(group,startPositions);
+      runOrderings(startPositions,NULL,-1);
+      for (FlatHashMap<uint64_t,double>::iterator it = layer.begin(); it != layer.end(); ++it) {
+        uint32_t moved = (uint32_t)it->first;
+        positions.resize(group.size());
+        for (unsigned int i = 0; i < group.size(); i++)
+          positions[i] = candidates[group[i]][choices[group[i]]].requested;
+        for (unsigned int i = 0; i < ordering.numMoving; i++) {
+          if (!(moved & (1u << i))) {
+            unsigned int agent = ordering.agents[i];
+            for (unsigned int j = 0; j < group.size(); j++) {
+              if (group[j] == agent)
+                positions[j] = startPositions[agent];
+            }
+          }
+        }
+        groupOutcomes[positions] += combinationProb * it->second;
+      }
+    } while (nextCombination(group));
+
+    // combine with the other groups, which never produce the same positions
+    // because they're made up of different agents
+    unsigned int numOutcomes = outcomes.size();
+    std::vector<PositionOutcome> combined;
+    combined.reserve(numOutcomes * groupOutcomes.size());
+    for (unsigned int i = 0; i < numOutcomes; i++) {
+      for (std::map<std::vector<Point2D>,double>::iterator it = groupOutcomes.begin(); it != groupOutcomes.end(); ++it) {
+        combined.push_back(outcomes[i]);
+        PositionOutcome &outcome = combined.back();
+        outcome.prob *= it->second;
+        for (unsigned int j = 0; j < group.size(); j++)
+          outcome.positions[group[j]] = it->first[j];
+      }
+    }
+    outcomes.swap(combined);
+  }
+}
+
+void ExactOutcomes::setCandidates(const PositionList &startPositions, const std::vector<ActionProbs> &actionProbs) {
+  unsigned int numAgents = actionProbs.size();
+  candidates.resize(numAgents);
+  choices.assign(numAgents,0);
+  for (unsigned int i = 0; i < numAgents; i++) {
+    std::vector<Candidate> &agentCandidates = candidates[i];
+    agentCandidates.clear();
+    for (unsigned int a = 0; a < Action::NUM_ACTIONS; a++) {
+      double prob = actionProbs[i][(Action::Type)a];
+      if (prob <= 0)
+        continue;
+      Point2D requested = geometry->movePosition(startPositions[i],(Action::Type)a);
+      // on small grids different moves can reach the same cell
+      bool found = false;
+      for (unsigned int j = 0; j < agentCandidates.size(); j++) {
+        if (agentCandidates[j].requested == requested) {
+          agentCandidates[j].prob += prob;
+          found = true;
+          break;
+        }
+      }
+      if (!found) {
+        Candidate candidate;
+        candidate.requested = requested;
+        candidate.prob = prob;
+        agentCandidates.push_back(candidate);
+      }
+    }
+  }
+}
+
+void ExactOutcomes::removeInconsistentCandidates(const PositionList &startPositions, const PositionList &endPositions, int unconstrainedInd) {
+  unsigned int numAgents = candidates.size();
+  for (unsigned int i = 0; i < numAgents; i++) {
+    if ((int)i == unconstrainedInd)
+      continue;
+    std::vector<Candidate> &agentCandidates = candidates[i];
+    bool stayed = (startPositions[i] == endPositions[i]);
+    unsigned int numKept = 0;
+    for (unsigned int c = 0; c < agentCandidates.size(); c++) {
+      const Point2D &requested = agentCandidates[c].requested;
+      bool keep;
+      if (!stayed) {
+        keep = (requested == endPositions[i]);
+      } else if (requested == startPositions[i]) {
+        keep = true;
+      } else {
+        // it has to have been blocked, by an agent that's on the cell at
+        // some point in the step
+        keep = false;
+        for (unsigned int j = 0; (j < numAgents) && !keep; j++) {
+          if (j == i)
+            continue;
+          if ((int)j == unconstrainedInd) {
+            keep = (requested == startPositions[j]);
+            for (unsigned int k = 0; (k < candidates[j].size()) && !keep; k++)
+              keep = (requested == candidates[j][k].requested);
+          } else {
+            keep = (requested == startPositions[j]) || (requested == endPositions[j]);
+          }
+        }
+      }
+      if (keep)
+        agentCandidates[numKept++] = agentCandidates[c];
+    }
+    agentCandidates.resize(numKept);
+  }
+}
+
+void ExactOutcomes::findGroups(const PositionList &startPositions) {
+  // agents are in the same group if either one's requested cell is a cell
+  // the other can be on during the step
+  unsigned int numAgents = candidates.size();
+  std::vector<unsigned int> groupInds(numAgents);
+  for (unsigned int i = 0; i < numAgents; i++)
+    groupInds[i] = i;
+  for (unsigned int i = 0; i < numAgents; i++) {
+    for (unsigned int j = i + 1; j < numAgents; j++) {
+      bool interact = false;
+      for (unsigned int c = 0; (c < candidates[i].size()) && !interact; c++) {
+        const Point2D &requested = candidates[i][c].requested;
+        if (requested == startPositions[i])
+          continue;
+        interact = (requested == startPositions[j]);
+        for (unsigned int d = 0; (d < candidates[j].size()) && !interact; d++)
+          interact = (requested == candidates[j][d].requested);
+      }
+      for (unsigned int d = 0; (d < candidates[j].size()) && !interact; d++) {
+        const Point2D &requested = candidates[j][d].requested;
+        if (requested != startPositions[j])
+          interact = (requested == startPositions[i]);
+      }
+      if (!interact)
+        continue;
+      // merge the groups
+      unsigned int oldInd = groupInds[j];
+      unsigned int newInd = groupInds[i];
+      for (unsigned int k = 0; k < numAgents; k++) {
+        if (groupInds[k] == oldInd)
+          groupInds[k] = newInd;
+      }
+    }
+  }
+
+  groups.clear();
+  for (unsigned int i = 0; i < numAgents; i++) {
+    if (groupInds[i] != i)
+      continue;
+    groups.push_back(std::vector<unsigned int>());
+    for (unsigned int j = 0; j < numAgents; j++) {
+      if (groupInds[j] == i)
+        groups.back().push_back(j);
+    }
+  }
+}
+
+bool ExactOutcomes::nextCombination(const std::vector<unsigned int> &group) {
+  for (unsigned int i = 0; i < group.size(); i++) {
+    unsigned int agent = group[i];
+    choices[agent]++;
+    if (choices[agent] < candidates[agent].size())
+      return true;
+    choices[agent] = 0;
+  }
+  return false;
+}
+
+double ExactOutcomes::setOrdering(const std::vector<unsigned int> &group, const PositionList &startPositions) {
+  double prob = 1.0;
+  ordering.agents.clear();
+  for (unsigned int i = 0; i < group.size(); i++) {
+    unsigned int agent = group[i];
+    const Candidate &candidate = candidates[agent][choices[agent]];
+    prob *= candidate.prob;
+    if (candidate.requested != startPositions[agent])
+      ordering.agents.push_back(agent);
+  }
+
+  unsigned int numMoving = ordering.agents.size();
+  if (numMoving > MAX_MOVING_AGENTS) {
+    std::cerr << "ExactOutcomes::setOrdering: ERROR: " << numMoving << " interacting agents moving at once, but the limit is " << MAX_MOVING_AGENTS << std::endl;
+    exit(63);
+  }
+  ordering.numMoving = numMoving;
+  ordering.startBlockers.assign(numMoving,0);
+  ordering.requestBlockers.assign(numMoving,0);
+  ordering.staticBlocked.assign(numMoving,false);
+  for (unsigned int i = 0; i < numMoving; i++) {
+    unsigned int agent = ordering.agents[i];
+    const Point2D &requested = candidates[agent][choices[agent]].requested;
+    for (unsigned int j = 0; j < numMoving; j++) {
+      if (j == i)
+        continue;
+      unsigned int other = ordering.agents[j];
+      if (startPositions[other] == requested)
+        ordering.startBlockers[i] |= (1u << j);
+      if (candidates[other][choices[other]].requested == requested)
+        ordering.requestBlockers[i] |= (1u << j);
+    }
+    for (unsigned int j = 0; j < group.size(); j++) {
+      unsigned int other = group[j];
+      if ((other != agent) && (startPositions[other] == requested) && (candidates[other][choices[other]].requested == startPositions[other]))
+        ordering.staticBlocked[i] = true;
+    }
+  }
+  return prob;
+}
+
+void ExactOutcomes::runOrderings(const PositionList &startPositions, const PositionList *endPositions, int unconstrainedInd) {
+  unsigned int numMoving = ordering.numMoving;
+  // for matching the end positions, whether each moving agent has to move
+  uint32_t mustMove = 0;
+  uint32_t constrained = 0;
+  if (endPositions != NULL) {
+    for (unsigned int i = 0; i < numMoving; i++) {
+      unsigned int agent = ordering.agents[i];
+      if ((int)agent == unconstrainedInd)
+        continue;
+      constrained |= (1u << i);
+      if ((*endPositions)[agent] != startPositions[agent])
+        mustMove |= (1u << i);
+    }
+  }
+
+  // each agent that hasn't gone is equally likely to go next
+  layer.clear();
+  layer[0] = 1.0;
+  for (unsigned int numGone = 0; numGone < numMoving; numGone++) {
+    nextLayer.clear();
+    double share = 1.0 / (numMoving - numGone);
+    for (FlatHashMap<uint64_t,double>::iterator it = layer.begin(); it != layer.end(); ++it) {
+      uint32_t gone = (uint32_t)(it->first >> 32);
+      uint32_t moved = (uint32_t)it->first;
+      double prob = it->second * share;
+      for (unsigned int i = 0; i < numMoving; i++) {
+        uint32_t bit = 1u << i;
+        if (gone & bit)
+          continue;
+        // agents that haven't moved are still on their start cells
+        bool blocked = ordering.staticBlocked[i] || (ordering.startBlockers[i] & ~moved) || (ordering.requestBlockers[i] & moved);
+        uint32_t newMoved = blocked ? moved : (moved | bit);
+        if ((constrained & bit) && ((newMoved & bit) != (mustMove & bit)))
+          continue;
+        nextLayer[((uint64_t)(gone | bit) << 32) | newMoved] += prob;
+      }
+    }
+    std::swap(layer,nextLayer);
+  }
+}
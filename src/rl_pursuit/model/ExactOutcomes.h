@@ -0,0 +1,87 @@
+#ifndef EXACTOUTCOMES_W5HM2TQE
+#define EXACTOUTCOMES_W5HM2TQE
+
+/*
+File: ExactOutcomes.h
+Author: Samuel Barrett
+Description: the exact distribution over the positions after one world
+  step, given where the agents start and their action distributions. The
+  world picks an action for each agent, then moves them in a uniformly random
+  order, and an agent only moves if its requested cell is empty at its turn.
+  Rather than enumerating every combination of actions with every ordering:
+    - actions with no probability, or that can't lead to the observed
+      positions, are dropped, and actions requesting the same cell are merged
+    - agents are split into groups that can't affect each other, since the
+      order within a group is still uniform when the groups are independent
+    - agents whose requested cell is their own never need ordering
+    - the orderings of the rest are collapsed into a dynamic program over
+      which agents have gone and which of those moved, so orderings that
+      reach the same situation are only followed once
+Created:  2013-08-18
+Modified: 2013-08-18
+*/
+
+#include <map>
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <rl_pursuit/common/FlatHashMap.h>
+#include "Common.h"
+#include "Geometry.h"
+
+struct PositionOutcome {
+  PositionList positions;
+  double prob;
+};
+
+class ExactOutcomes {
+public:
+  static const unsigned int MAX_MOVING_AGENTS = 32; // that can interact with each other in a single step
+
+  ExactOutcomes(const Point2D &dims);
+
+  // probability of going from startPositions to endPositions. The agent at
+  // unconstrainedInd, if it's >= 0, can end anywhere, for a prey that was
+  // captured and placed again. groupProbs gets the probability of the group
+  // each agent was in, which for an agent that interacts with nobody is just
+  // the probability of its own move
+  double getProb(const PositionList &startPositions, const std::vector<ActionProbs> &actionProbs, const PositionList &endPositions, int unconstrainedInd, std::vector<double> &groupProbs);
+  // every set of positions that can follow startPositions, with its probability
+  void getOutcomes(const PositionList &startPositions, const std::vector<ActionProbs> &actionProbs, std::vector<PositionOutcome> &outcomes);
+
+private:
+  struct Candidate {
+    Point2D requested;
+    double prob;
+  };
+
+  // one combination of actions for the moving agents of a group
+  struct Ordering {
+    unsigned int numMoving;
+    std::vector<unsigned int> agents; // indices of the moving agents
+    std::vector<uint32_t> startBlockers; // moving agents that start on my requested cell
+    std::vector<uint32_t> requestBlockers; // moving agents that request my requested cell
+    std::vector<bool> staticBlocked; // requested cell holds a non-moving agent
+  };
+
+  void setCandidates(const PositionList &startPositions, const std::vector<ActionProbs> &actionProbs);
+  void removeInconsistentCandidates(const PositionList &startPositions, const PositionList &endPositions, int unconstrainedInd);
+  void findGroups(const PositionList &startPositions);
+  bool nextCombination(const std::vector<unsigned int> &group);
+  double setOrdering(const std::vector<unsigned int> &group, const PositionList &startPositions);
+  // fills layer with the final moved sets and their probabilities. With
+  // endPositions, only orderings that match it are followed
+  void runOrderings(const PositionList &startPositions, const PositionList *endPositions, int unconstrainedInd);
+
+private:
+  boost::shared_ptr<const Geometry> geometry;
+  std::vector<std::vector<Candidate> > candidates; // per agent
+  std::vector<unsigned int> choices; // per agent, the current candidate
+  std::vector<std::vector<unsigned int> > groups;
+  Ordering ordering;
+  // states keyed by (agents that have gone) << 32 | (agents that moved)
+  FlatHashMap<uint64_t,double> layer;
+  FlatHashMap<uint64_t,double> nextLayer;
+};
+
+#endif /* end of include guard: EXACTOUTCOMES_W5HM2TQE */
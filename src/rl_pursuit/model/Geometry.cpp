@@ -0,0 +1,56 @@
+/*
+File: Geometry.cpp
+Author: Samuel Barrett
+Description: lookup tables for moving, wrapping, and measuring on the torus
+  of a given size
+Created:  2013-08-18
+Modified: 2013-08-18
+*/
+
+#include "Geometry.h"
+#include <cstdlib>
+#include <map>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+
+Geometry::Geometry(const Point2D &dims):
+  dims(dims),
+  x(dims.x),
+  y(dims.y)
+{
+}
+
+boost::shared_ptr<const Geometry> Geometry::get(const Point2D &dims) {
+  // held weakly, so the tables go away with the last world of that size
+  static boost::mutex mutex;
+  static std::map<Point2D,boost::weak_ptr<const Geometry> > geometries;
+
+  boost::mutex::scoped_lock lock(mutex);
+  boost::weak_ptr<const Geometry> &entry = geometries[dims];
+  boost::shared_ptr<const Geometry> geometry = entry.lock();
+  if (geometry.get() == NULL) {
+    geometry = boost::shared_ptr<const Geometry>(new Geometry(dims));
+    entry = geometry;
+  }
+  return geometry;
+}
+
+Geometry::Axis::Axis(int n):
+  offset(2 * n),
+  size(5 * n),
+  wrap(size),
+  wrapPoint(size),
+  difference(size),
+  distance(size)
+{
+  // the axes are independent, so a square grid gives the values for this one
+  Point2D square(n,n);
+  Point2D origin(0,0);
+  for (unsigned int i = 0; i < size; i++) {
+    Point2D val((int)i - offset,(int)i - offset);
+    wrap[i] = ::movePosition(square,origin,val).x;
+    wrapPoint[i] = ::wrapPoint(square,val).x;
+    difference[i] = ::getDifferenceToPoint(square,origin,val).x;
+    distance[i] = abs(difference[i]);
+  }
+}
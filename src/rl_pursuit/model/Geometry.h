@@ -0,0 +1,87 @@
+#ifndef GEOMETRY_K3XW8NQA
+#define GEOMETRY_K3XW8NQA
+
+/*
+File: Geometry.h
+Author: Samuel Barrett
+Description: lookup tables for moving, wrapping, and measuring on the torus
+  of a given size. The tables are filled from movePosition, wrapPoint, and
+  getDifferenceToPoint in Common.h, so the results are exactly the same,
+  and values outside of the tables fall back to those functions. Use
+  Geometry::get so that every caller with the same dims shares one copy.
+Created:  2013-08-18
+Modified: 2013-08-18
+*/
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <rl_pursuit/common/Point2D.h>
+#include "Common.h"
+
+class Geometry {
+public:
+  Geometry(const Point2D &dims);
+
+  // the shared geometry for these dims, created on the first request
+  static boost::shared_ptr<const Geometry> get(const Point2D &dims);
+
+  inline const Point2D& getDims() const {return dims;}
+
+  inline Point2D wrapPoint(const Point2D &pos) const {
+    if (!x.inTable(pos.x) || !y.inTable(pos.y))
+      return ::wrapPoint(dims,pos);
+    return Point2D(x.wrapPoint[pos.x + x.offset],y.wrapPoint[pos.y + y.offset]);
+  }
+
+  inline Point2D movePosition(const Point2D &pos, Action::Type action) const {
+    return movePosition(pos,Action::MOVES[action]);
+  }
+
+  inline Point2D movePosition(const Point2D &pos, const Point2D &move) const {
+    int resX = pos.x + move.x;
+    int resY = pos.y + move.y;
+    if (!x.inTable(resX) || !y.inTable(resY))
+      return ::movePosition(dims,pos,move);
+    return Point2D(x.wrap[resX + x.offset],y.wrap[resY + y.offset]);
+  }
+
+  inline Point2D getDifferenceToPoint(const Point2D &start, const Point2D &end) const {
+    int dx = end.x - start.x;
+    int dy = end.y - start.y;
+    if (!x.inTable(dx) || !y.inTable(dy))
+      return ::getDifferenceToPoint(dims,start,end);
+    return Point2D(x.difference[dx + x.offset],y.difference[dy + y.offset]);
+  }
+
+  inline unsigned int getDistanceToPoint(const Point2D &pos1, const Point2D &pos2) const {
+    int dx = pos2.x - pos1.x;
+    int dy = pos2.y - pos1.y;
+    if (!x.inTable(dx) || !y.inTable(dy))
+      return ::getDistanceToPoint(dims,pos1,pos2);
+    return x.distance[dx + x.offset] + y.distance[dy + y.offset];
+  }
+
+private:
+  // the tables for one axis of size n, indexed by value + offset for values
+  // in [-2n,3n), which covers a position plus any move or difference of
+  // positions on the grid
+  struct Axis {
+    Axis(int n);
+    inline bool inTable(int val) const {
+      return (unsigned int)(val + offset) < size;
+    }
+
+    int offset;
+    unsigned int size;
+    std::vector<int> wrap; // movePosition
+    std::vector<int> wrapPoint;
+    std::vector<int> difference; // getDifferenceToPoint from 0
+    std::vector<unsigned int> distance; // abs of difference
+  };
+
+  const Point2D dims;
+  Axis x;
+  Axis y;
+};
+
+#endif /* end of include guard: GEOMETRY_K3XW8NQA */
@@ -3,7 +3,7 @@ File: WorldModel.cpp
 Author: Samuel Barrett
 Description: contains the necessary information for a pursuit simulation
 Created:  2011-08-22
-Modified: 2011-11-16
+Modified: 2013-08-19
 */
 
 #include "WorldModel.h"
@@ -20,7 +20,12 @@ using Action::MOVES;
 
 WorldModel::WorldModel(const Point2D &dims): 
   dims(dims),
-  preyInd(-1)
+  geometry(Geometry::get(dims)),
+  preyInd(-1),
+  centeredObsValid(false),
+  stateKey(0),
+  stateKeyValid(false),
+  occupancy(dims.x * dims.y)
 {
 }
 
@@ -50,6 +55,13 @@ bool WorldModel::addAgent(const AgentModel& agent, bool ignorePosition) {
   }
 
   agents.push_back(agent);
+  addToCell(agents.size() - 1);
+  absObs.positions.push_back(agent.pos);
+  absObs.preyInd = preyInd;
+  if (agent.type == PREY)
+    absObs.absPrey = agent.pos;
+  centeredObsValid = false;
+  stateKeyValid = false;
   return true;
 }
 
@@ -67,6 +79,17 @@ bool WorldModel::isPreyCaptured() const {
 int WorldModel::getCollision(const Point2D& pos, int skipInd, int maxInd) const {
   if ((maxInd < 0) || ((unsigned int)maxInd > agents.size()))
     maxInd = agents.size();
+  if (onGrid(pos)) {
+    const Cell &cell = occupancy[getCellInd(pos)];
+    if (cell.numAgents == 0)
+      return -1;
+    if (cell.numAgents == 1) {
+      if ((cell.agent != skipInd) && (cell.agent < maxInd))
+        return cell.agent;
+      return -1;
+    }
+  }
+  // agents are sharing the cell, or the position is off the grid
   for (int i = 0; i < maxInd; i++) {
     if ((i != skipInd) && (pos == agents[i].pos))
       return i;
@@ -74,29 +97,97 @@ int WorldModel::getCollision(const Point2D& pos, int skipInd, int maxInd) const
   return -1;
 }
 
+void WorldModel::addToCell(unsigned int ind) {
+  const Point2D &pos = agents[ind].pos;
+  if (!onGrid(pos))
+    return;
+  Cell &cell = occupancy[getCellInd(pos)];
+  cell.numAgents++;
+  cell.agent = (cell.numAgents == 1) ? (int)ind : -1;
+}
+
+void WorldModel::removeFromCell(unsigned int ind) {
+  const Point2D &pos = agents[ind].pos;
+  if (!onGrid(pos))
+    return;
+  Cell &cell = occupancy[getCellInd(pos)];
+  cell.numAgents--;
+  cell.agent = -1;
+  if (cell.numAgents == 1) {
+    // find the agent that's left, this only happens when agents overlap,
+    // like while the positions are being set up
+    for (unsigned int i = 0; i < agents.size(); i++) {
+      if ((i != ind) && (agents[i].pos == pos)) {
+        cell.agent = i;
+        break;
+      }
+    }
+  }
+}
+
 Point2D WorldModel::getAgentPosition(unsigned int ind, Action::Type action) const {
-  return movePosition(dims,agents[ind].pos,action);
+  return geometry->movePosition(agents[ind].pos,action);
+}
+
+void WorldModel::updateObservation(unsigned int ind) {
+  const Point2D &pos = agents[ind].pos;
+  absObs.positions[ind] = pos;
+  if ((int)ind == preyInd) {
+    // everything moves relative to the prey
+    absObs.absPrey = pos;
+    centeredObsValid = false;
+  } else if (centeredObsValid) {
+    // matches Observation::centerPrey, which leaves the positions alone when the prey is already centered
+    if ((lastCenterPreyOffset.x == 0) && (lastCenterPreyOffset.y == 0))
+      centeredObs.positions[ind] = pos;
+    else
+      centeredObs.positions[ind] = geometry->movePosition(pos,lastCenterPreyOffset);
+  }
+}
+
+const Observation& WorldModel::getObservationView(bool centerPrey) const {
+  assert(preyInd >= 0);
+  if (!centerPrey)
+    return absObs;
+  if (!centeredObsValid) {
+    centeredObs = absObs;
+    centeredObs.centerPrey(*geometry);
+    lastCenterPreyOffset = 0.5f * dims - absObs.absPrey;
+    centeredObsValid = true;
+  }
+  return centeredObs;
+}
+
+Observation& WorldModel::getObservation(bool centerPrey) {
+  return const_cast<Observation&>(getObservationView(centerPrey));
 }
 
 void WorldModel::generateObservation(Observation &obs, bool centerPrey) const {
-  obs.preyInd = preyInd;
+  obs = getObservationView(centerPrey);
   obs.myInd = 0;
-  obs.positions.clear();
-  for (unsigned int i = 0; i < agents.size(); i++)
-    obs.positions.push_back(agents[i].pos);
- 
-  assert(preyInd >= 0);
-  obs.absPrey = agents[preyInd].pos;
-  if (centerPrey)
-    obs.centerPrey(dims);
 }
 
 void WorldModel::setPositionsFromObservation(Observation obs) {
-  obs.uncenterPrey(dims);
+  obs.uncenterPrey(*geometry);
   for (unsigned int i = 0; i < agents.size(); i++)
     setAgentPosition(i,obs.positions[i]);
 }
 
+void WorldModel::setZobristTable(boost::shared_ptr<const ZobristTable> table) {
+  assert((table.get() == NULL) || (table->getNumAgents() >= agents.size()));
+  zobrist = table;
+  stateKeyValid = false;
+}
+
+uint64_t WorldModel::getStateKey() const {
+  assert(zobrist.get() != NULL);
+  if (!stateKeyValid) {
+    stateKey = zobrist->getKey(absObs);
+    stateKeyValid = true;
+  }
+  return stateKey;
+}
+
 std::string WorldModel::generateDescription(unsigned int indentation) {
   std::string s;
   s += indent(indentation) + "WorldModel " + dims.toString();
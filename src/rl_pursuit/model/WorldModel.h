@@ -6,7 +6,7 @@ File: WorldModel.h
 Author: Samuel Barrett
 Description: contains the necessary information for a pursuit simulation
 Created:  2011-08-22
-Modified: 2011-11-16
+Modified: 2013-08-19
 */
 
 #include <vector>
@@ -15,6 +15,8 @@ Modified: 2011-11-16
 #include <rl_pursuit/common/Point2D.h>
 #include "AgentModel.h"
 #include "Common.h"
+#include "Geometry.h"
+#include "ZobristTable.h"
 
 class WorldModel {
 public:
@@ -24,11 +26,26 @@ public:
   int getCollision(const Point2D &pos, int skipInd = -1, int maxInd = -1) const;
   inline unsigned int getNumAgents() const {return agents.size();}
   inline Point2D getDims() const {return dims;}
+  inline const Geometry& getGeometry() const {return *geometry;}
 
-  inline void setAgentPosition(unsigned int ind, const Point2D &pos) {agents[ind].pos = pos;}
+  inline void setAgentPosition(unsigned int ind, const Point2D &pos) {
+    if (zobrist.get() != NULL)
+      updateStateKey(ind,pos);
+    removeFromCell(ind);
+    agents[ind].pos = pos;
+    addToCell(ind);
+    updateObservation(ind);
+  }
   Point2D getAgentPosition(unsigned int ind, Action::Type action = Action::NOOP) const;
   void generateObservation(Observation &obs, bool centerPrey) const;
+  // a view of the current positions that's kept up to date as agents move,
+  // so it isn't regenerated every step. Callers may only change its myInd
+  Observation& getObservation(bool centerPrey);
   void setPositionsFromObservation(Observation obs);
+  // keeps a key of the positions up to date as agents move, the table must
+  // have keys for all of the agents, so set it again after adding agents
+  void setZobristTable(boost::shared_ptr<const ZobristTable> table);
+  uint64_t getStateKey() const;
   std::string generateDescription(unsigned int indentation = 0);
 
   virtual boost::shared_ptr<WorldModel> clone() const {
@@ -40,9 +57,54 @@ public:
 
 protected:
   const Point2D dims;
+  boost::shared_ptr<const Geometry> geometry;
   std::vector<AgentModel> agents;
   int preyInd;
-  Point2D lastCenterPreyOffset;
+  mutable Point2D lastCenterPreyOffset; // of centeredObs
+
+  // the live observations, the prey centered one is only rebuilt when the
+  // prey moves and it's asked for
+  Observation absObs;
+  mutable Observation centeredObs;
+  mutable bool centeredObsValid;
+
+  // the key is rebuilt when the prey moves and it's asked for, since all of
+  // the relative positions change
+  boost::shared_ptr<const ZobristTable> zobrist;
+  mutable uint64_t stateKey;
+  mutable bool stateKeyValid;
+
+  // which agents are on each grid cell, kept up to date by setAgentPosition,
+  // so collisions are found without scanning all of the agents
+  struct Cell {
+    Cell(): numAgents(0), agent(-1) {}
+    unsigned int numAgents;
+    int agent; // only set when there's exactly one agent on the cell
+  };
+  std::vector<Cell> occupancy;
+
+  inline bool onGrid(const Point2D &pos) const {
+    return (pos.x >= 0) && (pos.x < dims.x) && (pos.y >= 0) && (pos.y < dims.y);
+  }
+  inline unsigned int getCellInd(const Point2D &pos) const {
+    return pos.y * dims.x + pos.x;
+  }
+  void addToCell(unsigned int ind);
+  void removeFromCell(unsigned int ind);
+  void updateObservation(unsigned int ind);
+  inline void updateStateKey(unsigned int ind, const Point2D &pos) { // before ind moves to pos
+    if (!stateKeyValid)
+      return;
+    if ((int)ind == preyInd) {
+      stateKeyValid = false;
+      return;
+    }
+    Point2D preyPos(0,0); // without a prey, relative to the corner
+    if (preyInd >= 0)
+      preyPos = agents[preyInd].pos;
+    stateKey ^= zobrist->getAgentKey(ind,agents[ind].pos,preyPos) ^ zobrist->getAgentKey(ind,pos,preyPos);
+  }
+  const Observation& getObservationView(bool centerPrey) const;
 };
 
 #endif /* end of include guard: WORLDMODEL_OIVQAWRT */
@@ -0,0 +1,78 @@
+/*
+File: ZobristTable.cpp
+Author: Samuel Barrett
+Description: a random key for every agent on every cell
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include "ZobristTable.h"
+#include <cassert>
+#include <map>
+#include <utility>
+#include <boost/thread/mutex.hpp>
+#include <boost/weak_ptr.hpp>
+#include <rl_pursuit/common/RNG.h>
+
+const uint32_t ZOBRIST_SEED = 0x5A0B1257;
+
+ZobristTable::ZobristTable(const Point2D &dims, unsigned int numAgents, bool usePreySymmetry):
+  dims(dims),
+  numCells(dims.x * dims.y),
+  numAgents(numAgents),
+  usePreySymmetry(usePreySymmetry),
+  keys(numAgents * numCells)
+{
+  // filled agent by agent from one stream, so adding agents doesn't change
+  // the keys of the others
+  RNG rng(ZOBRIST_SEED);
+  std::vector<uint32_t> vals(2 * keys.size());
+  if (vals.size() > 0)
+    rng.randomUInts(&(vals[0]),vals.size());
+  for (unsigned int i = 0; i < keys.size(); i++)
+    keys[i] = ((uint64_t)vals[2 * i] << 32) | vals[2 * i + 1];
+}
+
+boost::shared_ptr<const ZobristTable> ZobristTable::get(const Point2D &dims, unsigned int numAgents, bool usePreySymmetry) {
+  // held weakly, so the tables go away with the last world that uses them
+  typedef std::pair<Point2D,std::pair<unsigned int,bool> > Settings;
+  static boost::mutex mutex;
+  static std::map<Settings,boost::weak_ptr<const ZobristTable> > tables;
+
+  boost::mutex::scoped_lock lock(mutex);
+  boost::weak_ptr<const ZobristTable> &entry = tables[Settings(dims,std::make_pair(numAgents,usePreySymmetry))];
+  boost::shared_ptr<const ZobristTable> table = entry.lock();
+  if (table.get() == NULL) {
+    table = boost::shared_ptr<const ZobristTable>(new ZobristTable(dims,numAgents,usePreySymmetry));
+    entry = table;
+  }
+  return table;
+}
+
+uint64_t ZobristTable::getKey(const Observation &obs) const {
+  assert(obs.positions.size() <= numAgents);
+  uint64_t key = 0;
+  Point2D preyPos(0,0); // without a prey, relative to the corner
+  if (obs.preyInd >= 0) {
+    key = getPreyKey(obs.preyInd,obs.absPrey);
+    preyPos = obs.positions[obs.preyInd];
+  }
+  for (unsigned int i = 0; i < obs.positions.size(); i++) {
+    if ((int)i != obs.preyInd)
+      key ^= getAgentKey(i,obs.positions[i],preyPos);
+  }
+  return key;
+}
+
+void ZobristTable::getKeyedPositions(const Observation &obs, PositionList &positions) const {
+  positions.resize(obs.positions.size());
+  Point2D preyPos(0,0);
+  if (obs.preyInd >= 0)
+    preyPos = obs.positions[obs.preyInd];
+  for (unsigned int i = 0; i < obs.positions.size(); i++) {
+    if ((int)i == obs.preyInd)
+      positions[i] = usePreySymmetry ? Point2D(0,0) : obs.absPrey;
+    else
+      positions[i] = movePosition(dims,obs.positions[i],Point2D(0,0) - preyPos);
+  }
+}
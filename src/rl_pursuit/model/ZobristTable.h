@@ -0,0 +1,62 @@
+#ifndef ZOBRISTTABLE_R7TM2KXE
+#define ZOBRISTTABLE_R7TM2KXE
+
+/*
+File: ZobristTable.h
+Author: Samuel Barrett
+Description: a random key for every agent on every cell, the key of the
+  positions is the xor of the agents' keys, so it's updated in constant time
+  when an agent moves. The agents are keyed by their positions relative to
+  the prey, and the prey by its absolute position unless the states use the
+  prey symmetry. An agent's keys are the same for any number of agents. Use
+  ZobristTable::get so that every caller with the same settings shares one
+  copy.
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <rl_pursuit/common/Point2D.h>
+#include "Common.h"
+
+class ZobristTable {
+public:
+  ZobristTable(const Point2D &dims, unsigned int numAgents, bool usePreySymmetry);
+
+  // the shared table for these settings, created on the first request
+  static boost::shared_ptr<const ZobristTable> get(const Point2D &dims, unsigned int numAgents, bool usePreySymmetry);
+
+  inline unsigned int getNumAgents() const {return numAgents;}
+
+  inline uint64_t getAgentKey(unsigned int ind, const Point2D &pos, const Point2D &preyPos) const {
+    int x = pos.x - preyPos.x;
+    int y = pos.y - preyPos.y;
+    if (x < 0)
+      x += dims.x;
+    if (y < 0)
+      y += dims.y;
+    return keys[ind * numCells + y * dims.x + x];
+  }
+
+  inline uint64_t getPreyKey(unsigned int preyInd, const Point2D &preyPos) const {
+    if (usePreySymmetry)
+      return 0;
+    return keys[preyInd * numCells + preyPos.y * dims.x + preyPos.x];
+  }
+
+  // from scratch, the prey centered and uncentered observations have the same key
+  uint64_t getKey(const Observation &obs) const;
+  // the positions that the key is of, to check for collisions
+  void getKeyedPositions(const Observation &obs, PositionList &positions) const;
+
+private:
+  const Point2D dims;
+  const unsigned int numCells;
+  const unsigned int numAgents;
+  const bool usePreySymmetry;
+  std::vector<uint64_t> keys; // by agent then cell
+};
+
+#endif /* end of include guard: ZOBRISTTABLE_R7TM2KXE */
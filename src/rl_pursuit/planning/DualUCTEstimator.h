@@ -6,7 +6,7 @@ File: DualUCTEstimator.h
 Author: Samuel Barrett
 Description: combines 2 value estimators
 Created:  2011-10-01
-Modified: 2011-12-13
+Modified: 2013-08-19
 */
 
 #include <boost/shared_ptr.hpp>
@@ -29,6 +29,7 @@ public:
   Action selectAction(const State &state, bool useBounds);
   float calcActionValue(const State &state, const Action &action, bool useBounds);
   void pruneOldVisits(int memorySize);
+  void reroot(const State &state);
 
 private:
   boost::shared_ptr<RNG> rng;
@@ -162,4 +163,12 @@ void DualUCTEstimator<State,Action>::pruneOldVisits(int memorySize) {
   generalValueEstimator->pruneOldVisits(memorySize);
 }
 
+template<class State, class Action>
+void DualUCTEstimator<State,Action>::reroot(const State &state) {
+  // the general tree is over the general states, so it's rerooted at the state's general version
+  State generalState = stateConverter.convertBeliefStateToGeneralState(state);
+  mainValueEstimator->reroot(state);
+  generalValueEstimator->reroot(generalState);
+}
+
 #endif /* end of include guard: DUALUCTESTIMATOR_F3MKQ7CG */
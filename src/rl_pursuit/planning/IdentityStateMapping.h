@@ -3,16 +3,18 @@
 
 #include "StateMapping.h"
 
-template<class State>
-class IdentityStateMapping: public StateMapping<State> {
+template<class State, class Action>
+class IdentityStateMapping: public StateMapping<State,Action> {
 public:
+  typedef typename StateMapping<State,Action>::Transform Transform;
+
   IdentityStateMapping () {}
   virtual ~IdentityStateMapping() {}
 
-  virtual void map(State &/*state*/) {
+  virtual Transform map(State &/*state*/) {
     // do nothing
+    return StateMapping<State,Action>::IDENTITY;
   }
 };
 
 #endif /* end of include guard: IDENTITYSTATEMAPPING_H_AIOSELMN */
-
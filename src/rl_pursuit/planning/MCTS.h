@@ -6,21 +6,27 @@ File: MCTS.h
 Author: Samuel Barrett
 Description: a monte-carlo tree search
 Created:  2011-08-23
-Modified: 2011-12-13
+Modified: 2013-08-19
 */
 
 #include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/bind.hpp>
 #include <iostream>
 #include <sstream>
+#include <vector>
+#include <utility>
 #include "Model.h"
 #include "ValueEstimator.h"
 #include "ModelUpdater.h"
 #include "StateMapping.h"
+#include "RolloutPolicy.h"
+#include "MCTSProfile.h"
 #include <rl_pursuit/common/Util.h>
+#include <rl_pursuit/common/Deadline.h>
 #include <rl_pursuit/common/Params.h>
 
 //#define MCTS_DEBUG
-//#define MCTS_TIMINGS
 
 #ifdef MCTS_DEBUG
 #define MCTS_OUTPUT(x) std::cout << x << std::endl
@@ -28,33 +34,6 @@ Modified: 2011-12-13
 #define MCTS_OUTPUT(x) ((void) 0)
 #endif
 
-#ifdef MCTS_TIMINGS
-#include <rl_pursuit/common/Enum.h>
-#define MCTS_TIC(_) tic(MCTS_Timer::_)
-#define MCTS_TOC(_) toc(MCTS_Timer::_)
-#define MCTS_PRINT_TIMINGS() for(int i = 0; i < MCTS_Timer::NUM; i++) { \
-  std::cout << getName((MCTS_Timer_t)i) << ": " << getTimer(i) << std::endl; \
-}
-#define MCTS_RESET_TIMINGS() for(int i = 0; i < MCTS_Timer::NUM; i++) { \
-  resetTimer(i); \
-}
-ENUM(MCTS_Timer,
-  TOTAL,
-  SELECT_MODEL,
-  SET_MODEL,
-  START_ROLLOUT,
-  SELECT_PLANNING_ACTION,
-  TAKE_ACTION,
-  VISIT,
-  FINISH_ROLLOUT
-)
-#else
-#define MCTS_TIC(_) (void)(0);
-#define MCTS_TOC(_) (void)(0);
-#define MCTS_PRINT_TIMINGS() (void)(0);
-#define MCTS_RESET_TIMINGS() (void)(0);
-#endif
-
 template<class State, class Action>
 class MCTS {
 public:
@@ -62,17 +41,37 @@ public:
   typedef typename ValueEstimator<State,Action>::Ptr ValuePtr;
   typedef typename ModelUpdater<State,Action>::Ptr ModelUpdaterPtr;
   typedef typename Model<State,Action>::Ptr ModelPtr;
-  typedef typename StateMapping<State>::Ptr StateMappingPtr;
+  typedef typename StateMapping<State,Action>::Ptr StateMappingPtr;
+  typedef typename StateMapping<State,Action>::Transform Transform;
+  typedef typename RolloutPolicy<State,Action>::Ptr RolloutPolicyPtr;
 
 #define PARAMS(_) \
   _(float,maxPlanningTime,maxPlanningTime,-1) \
   _(unsigned int,maxPlayouts,maxPlayouts,0) \
   _(unsigned int,maxDepth,maxDepth,0) \
-  _(int,pruningMemorySize,pruningMemorySize,-1)
+  _(int,pruningMemorySize,pruningMemorySize,-1) \
+  _(bool,reuseTree,reuseTree,false) \
+  _(bool,hardDeadline,hardDeadline,true) \
+  _(bool,expandOneNode,expandOneNode,false) \
+  _(float,deadlineCheckPeriod,deadlineCheckPeriod,0.0001)
 
   Params_STRUCT(PARAMS)
 #undef PARAMS
 
+  // what the last search actually did
+  struct SearchReport {
+    SearchReport():
+      playouts(0),
+      terminations(0),
+      planningTime(0),
+      hitDeadline(false)
+    {}
+    unsigned int playouts;
+    unsigned int terminations;
+    double planningTime;
+    bool hitDeadline;
+  };
+
   MCTS (ValuePtr valueEstimator, ModelUpdaterPtr modelUpdater, StateMappingPtr stateMapping, const Params &p);
   virtual ~MCTS () {}
 
@@ -80,20 +79,78 @@ public:
   Action selectWorldAction(const State &state);
   void restart();
   std::string generateDescription(unsigned int indentation = 0);
-  void pruneOldVisits() {
-    valueEstimator->pruneOldVisits(p.pruningMemorySize);
+  // call with the observed state before searching from it, with reuseTree
+  // the subtree below it is kept instead of pruning by pruningMemorySize
+  void pruneOldVisits(const State &state);
+  // root parallelization, each worker searches its own tree in its own thread,
+  // so the model updater's updateSimulationAction must be safe to call concurrently.
+  // The worker selects its models with its index, in the order they're added
+  void addWorker(ValuePtr workerValueEstimator, boost::shared_ptr<RNG> workerRNG);
+  // with expandOneNode, finishes the rollouts past the tree, the main thread
+  // draws from rng and the workers from their own rngs. By default, or with a
+  // NULL policy, the actions are uniformly random
+  void setRolloutPolicy(RolloutPolicyPtr policy, boost::shared_ptr<RNG> rng);
+  // the estimator only sees mapped states, and its actions are mapped back
+  // before they're taken, so symmetric states can share their statistics
+  void setStateMapping(StateMappingPtr mapping) {
+    stateMapping = mapping;
+  }
+  unsigned int getNumThreads() const {
+    return workers.size() + 1;
+  }
+  const SearchReport& getLastSearch() const {
+    return lastSearch;
+  }
+  // the counters of all the threads summed over the searches since the last reset
+  const MCTSProfile& getProfile() const {
+    return totalProfile;
+  }
+  void resetProfile() {
+    totalProfile.reset();
   }
 
 private:
+  struct Worker {
+    Worker(unsigned int ind, ValuePtr valueEstimator, boost::shared_ptr<RNG> rng):
+      ind(ind),
+      valueEstimator(valueEstimator),
+      rng(rng),
+      maxPlayouts(0),
+      playouts(0),
+      terminations(0)
+    {
+    }
+    unsigned int ind;
+    ValuePtr valueEstimator;
+    boost::shared_ptr<RNG> rng;
+    unsigned int maxPlayouts;
+    unsigned int playouts;
+    unsigned int terminations;
+    Deadline deadline;
+    MCTSProfile profile;
+  };
+
   void checkInternals();
-  bool rollout(const State &startState);
+  unsigned int runPlayouts(ValuePtr estimator, boost::shared_ptr<RNG> rng, unsigned int workerInd, const State &startState, unsigned int maxPlayouts, unsigned int &termination_count, Deadline &deadline, MCTSProfile &profile);
+  unsigned int searchParallel(const State &startState, unsigned int &termination_count);
+  void runWorker(Worker *worker, const State &startState);
+  void removeMergedStats();
+  bool rollout(ValuePtr estimator, boost::shared_ptr<RNG> rng, unsigned int workerInd, const State &startState, Deadline &deadline, MCTSProfile &profile);
 
 private:
   ValuePtr valueEstimator;
   ModelUpdaterPtr modelUpdater;
   StateMappingPtr stateMapping;
   bool valid;
-  double endPlanningTime;
+  Deadline deadline;
+  SearchReport lastSearch;
+  MCTSProfile mainProfile; // for the calling thread's share of the search
+  MCTSProfile totalProfile;
+  std::vector<Worker> workers;
+  // worker root stats added to the main estimator for the next selectWorldAction
+  std::vector<std::pair<State,std::vector<ActionStats<Action> > > > mergedStats;
+  RolloutPolicyPtr rolloutPolicy;
+  boost::shared_ptr<RNG> rolloutRNG;
 
   Params p;
 };
@@ -105,43 +162,154 @@ MCTS<State,Action>::MCTS (ValuePtr valueEstimator, ModelUpdaterPtr modelUpdater,
   valueEstimator(valueEstimator),
   modelUpdater(modelUpdater),
   stateMapping(stateMapping),
+  deadline(p.deadlineCheckPeriod),
+  rolloutPolicy(new RandomRolloutPolicy<State,Action>()),
+  rolloutRNG(new RNG(0)), // setRolloutPolicy gives it a seeded one
   p(p)
 {
   checkInternals();
 }
 
+template<class State, class Action>
+void MCTS<State,Action>::addWorker(ValuePtr workerValueEstimator, boost::shared_ptr<RNG> workerRNG) {
+  workers.push_back(Worker(workers.size(),workerValueEstimator,workerRNG));
+  modelUpdater->setNumSearchWorkers(workers.size());
+}
+
+template<class State, class Action>
+void MCTS<State,Action>::setRolloutPolicy(RolloutPolicyPtr policy, boost::shared_ptr<RNG> rng) {
+  if (policy.get() == NULL)
+    rolloutPolicy = RolloutPolicyPtr(new RandomRolloutPolicy<State,Action>());
+  else
+    rolloutPolicy = policy;
+  rolloutRNG = rng;
+}
+
 template<class State, class Action>
 unsigned int MCTS<State,Action>::search(const State &startState, unsigned int& termination_count) {
-  endPlanningTime = getTime() + p.maxPlanningTime;
-  unsigned int playout;
-  MCTS_RESET_TIMINGS();
-  MCTS_TIC(TOTAL);
+  removeMergedStats();
+  deadline.start(p.maxPlanningTime);
+  unsigned int playouts;
+  mainProfile.reset();
+  for (unsigned int i = 0; i < workers.size(); i++)
+    workers[i].profile.reset();
 
   termination_count = 0;
-  for (playout = 0; (p.maxPlayouts == 0) || (playout < p.maxPlayouts); playout++) {
+  if (workers.size() == 0)
+    playouts = runPlayouts(valueEstimator,boost::shared_ptr<RNG>(),0,startState,p.maxPlayouts,termination_count,deadline,mainProfile);
+  else
+    playouts = searchParallel(startState,termination_count);
+  lastSearch.playouts = playouts;
+  lastSearch.terminations = termination_count;
+  lastSearch.planningTime = deadline.elapsed();
+  lastSearch.hitDeadline = deadline.hasPassed();
+  for (unsigned int i = 0; i < workers.size(); i++)
+    lastSearch.hitDeadline = lastSearch.hitDeadline || workers[i].deadline.hasPassed();
+
+  totalProfile.add(mainProfile);
+  for (unsigned int i = 0; i < workers.size(); i++)
+    totalProfile.add(workers[i].profile);
+  totalProfile.addSearch(lastSearch.planningTime,valueEstimator->getNumNodes());
+  return playouts;
+}
+
+template<class State, class Action>
+unsigned int MCTS<State,Action>::runPlayouts(ValuePtr estimator, boost::shared_ptr<RNG> rng, unsigned int workerInd, const State &startState, unsigned int maxPlayouts, unsigned int &termination_count, Deadline &deadline, MCTSProfile &profile) {
+  unsigned int playout;
+  for (playout = 0; (p.maxPlayouts == 0) || (playout < maxPlayouts); playout++) {
     MCTS_OUTPUT("-----------------------------------");
     MCTS_OUTPUT("ROLLOUT: " << playout);
-    if ((p.maxPlanningTime > 0) && (getTime() > endPlanningTime))
+    if (deadline.expired())
       break;
-    bool terminal = rollout(startState);
+    bool terminal = rollout(estimator,rng,workerInd,startState,deadline,profile);
     if (terminal) ++termination_count;
     MCTS_OUTPUT("-----------------------------------");
   }
-  MCTS_TOC(TOTAL);
-  MCTS_PRINT_TIMINGS();
   return playout;
 }
 
+template<class State, class Action>
+unsigned int MCTS<State,Action>::searchParallel(const State &startState, unsigned int &termination_count) {
+  // root parallelization: every worker builds a fresh tree from startState,
+  // and the root statistics are merged into the main estimator afterwards,
+  // only until the world action is selected.
+  // Workers given the main estimator (e.g. a ParallelUCTEstimator) share its
+  // tree instead, so they are neither restarted nor merged.
+  unsigned int numThreads = getNumThreads();
+  boost::thread_group threads;
+  for (unsigned int i = 0; i < workers.size(); i++) {
+    Worker &worker = workers[i];
+    if (worker.valueEstimator != valueEstimator)
+      worker.valueEstimator->restart();
+    worker.playouts = 0;
+    worker.terminations = 0;
+    worker.deadline = deadline; // same end time, but the steps are counted per thread
+    // split the playouts, the main thread takes its share as thread 0
+    worker.maxPlayouts = p.maxPlayouts / numThreads + (i + 1 < p.maxPlayouts % numThreads ? 1 : 0);
+    if ((p.maxPlayouts > 0) && (worker.maxPlayouts == 0))
+      continue;
+    threads.create_thread(boost::bind(&MCTS<State,Action>::runWorker,this,&worker,boost::cref(startState)));
+  }
+  unsigned int mainMaxPlayouts = p.maxPlayouts / numThreads + (0 < p.maxPlayouts % numThreads ? 1 : 0);
+  unsigned int playouts = runPlayouts(valueEstimator,boost::shared_ptr<RNG>(),0,startState,mainMaxPlayouts,termination_count,deadline,mainProfile);
+  threads.join_all();
+
+  State mappedState(startState);
+  stateMapping->map(mappedState); // discretize state
+  for (unsigned int i = 0; i < workers.size(); i++) {
+    if (workers[i].valueEstimator != valueEstimator) {
+      mergedStats.push_back(std::make_pair(mappedState,std::vector<ActionStats<Action> >()));
+      workers[i].valueEstimator->getActionStats(mappedState,mergedStats.back().second);
+      valueEstimator->addActionStats(mappedState,mergedStats.back().second);
+    }
+    playouts += workers[i].playouts;
+    termination_count += workers[i].terminations;
+  }
+  return playouts;
+}
+
+template<class State, class Action>
+void MCTS<State,Action>::runWorker(Worker *worker, const State &startState) {
+  worker->playouts = runPlayouts(worker->valueEstimator,worker->rng,worker->ind,startState,worker->maxPlayouts,worker->terminations,worker->deadline,worker->profile);
+}
+
 template<class State, class Action>
 Action MCTS<State,Action>::selectWorldAction(const State &state) {
   State mappedState(state);
-  stateMapping->map(mappedState); // discretize state
-  return valueEstimator->selectWorldAction(mappedState);
+  Transform transform = stateMapping->map(mappedState); // discretize state
+  Action action = valueEstimator->selectWorldAction(mappedState);
+  // the workers' visits weren't made in the main tree, so they'd only inflate the later searches
+  removeMergedStats();
+  return stateMapping->unmapAction(action,transform);
+}
+
+template<class State, class Action>
+void MCTS<State,Action>::removeMergedStats() {
+  // in the reverse order to undo the running averages exactly
+  for (int i = (int)mergedStats.size() - 1; i >= 0; i--)
+    valueEstimator->removeActionStats(mergedStats[i].first,mergedStats[i].second);
+  mergedStats.clear();
 }
 
 template<class State, class Action>
 void MCTS<State,Action>::restart() {
+  mergedStats.clear();
   valueEstimator->restart();
+  for (unsigned int i = 0; i < workers.size(); i++) {
+    if (workers[i].valueEstimator != valueEstimator)
+      workers[i].valueEstimator->restart();
+  }
+}
+
+template<class State, class Action>
+void MCTS<State,Action>::pruneOldVisits(const State &state) {
+  removeMergedStats();
+  if (p.reuseTree) {
+    State mappedState(state);
+    stateMapping->map(mappedState); // discretize state
+    valueEstimator->reroot(mappedState);
+  } else
+    valueEstimator->pruneOldVisits(p.pruningMemorySize);
 }
 
 template<class State, class Action>
@@ -151,9 +319,17 @@ std::string MCTS<State,Action>::generateDescription(unsigned int indentation) {
   std::string prefix2 = indent(indentation + 1);
   ss << prefix  << "MCTS" << std::endl;
   ss << prefix2 << "num playouts: " << p.maxPlayouts << "\n";
-  ss << prefix2 << "max planning time: " << p.maxPlanningTime << "\n";
+  ss << prefix2 << "max planning time: " << p.maxPlanningTime << (p.hardDeadline ? " (hard)" : " (soft)") << "\n";
   ss << prefix2 << "max depth: " << p.maxDepth << "\n";
-  ss << prefix2 << "pruning memory size: " << p.pruningMemorySize << "\n";
+  if (p.expandOneNode) {
+    ss << prefix2 << "expanding one node per rollout" << "\n";
+    ss << rolloutPolicy->generateDescription(indentation+2) << "\n";
+  }
+  if (p.reuseTree)
+    ss << prefix2 << "reusing subtree" << "\n";
+  else
+    ss << prefix2 << "pruning memory size: " << p.pruningMemorySize << "\n";
+  ss << prefix2 << "num threads: " << getNumThreads() << "\n";
   ss << prefix2 << "ValueEstimator:\n";
   ss << valueEstimator->generateDescription(indentation+2) << "\n";
   //ss << prefix << "Model:\n";
@@ -172,52 +348,89 @@ void MCTS<State,Action>::checkInternals() {
     std::cerr << "Must stop planning at some point, either specify maxPlayouts or maxPlanningTime" << std::endl;
     valid = false;
   }
+  if (p.expandOneNode && !p.hardDeadline && (p.maxDepth == 0))
+    std::cerr << "MCTS: WARNING, default policy rollouts only stop at terminal states without a maxDepth or hard deadline" << std::endl;
 }
 
 template<class State, class Action>
-bool MCTS<State,Action>::rollout(const State &startState) {
+bool MCTS<State,Action>::rollout(ValuePtr estimator, boost::shared_ptr<RNG> rng, unsigned int workerInd, const State &startState, Deadline &deadline, MCTSProfile &profile) {
   MCTS_OUTPUT("------------START ROLLOUT--------------");
-  MCTS_TIC(SELECT_MODEL);
-  ModelPtr model = modelUpdater->selectModel(startState);
-  MCTS_TOC(SELECT_MODEL);
+  profile.start(MCTSPhase::SELECT_MODEL);
+  ModelPtr model;
+  if (rng.get() == NULL)
+    model = modelUpdater->selectModel(startState);
+  else
+    model = modelUpdater->selectModel(startState,rng,workerInd); // worker thread, needs its own copy
+  profile.stop(MCTSPhase::SELECT_MODEL);
+  if (model.get() == NULL) {
+    std::cerr << "MCTS: ERROR, model updater can't provide independent models for parallel search" << std::endl;
+    exit(61);
+  }
   State state(startState);
   State newState;
   Action action;
+  Action mappedAction;
+  Transform transform;
   float reward;
   bool terminal = false;
   int depth_count;
-  MCTS_TIC(SET_MODEL);
-  valueEstimator->setModel(model);
-  MCTS_TOC(SET_MODEL);
-  MCTS_TIC(START_ROLLOUT);
-  valueEstimator->startRollout();
-  MCTS_TOC(START_ROLLOUT);
+  bool inTree = true; // once a node is expanded, the default policy takes over
+  unsigned int numSteps = 0;
+  unsigned int numTreeSteps = 0;
+  RNG *policyRNG = (rng.get() == NULL) ? rolloutRNG.get() : rng.get();
+  profile.start(MCTSPhase::SET_MODEL);
+  estimator->setModel(model);
+  profile.stop(MCTSPhase::SET_MODEL);
+  profile.start(MCTSPhase::START_ROLLOUT);
+  estimator->startRollout();
+  profile.stop(MCTSPhase::START_ROLLOUT);
   
-  stateMapping->map(state); // discretize state
+  transform = stateMapping->map(state); // discretize state
 
   for (unsigned int depth = 0; (depth < p.maxDepth) || (p.maxDepth == 0); depth+=depth_count) {
     MCTS_OUTPUT("MCTS State: " << state << " " << "DEPTH: " << depth);
-    if (terminal || ((p.maxPlanningTime > 0) && (getTime() > endPlanningTime)))
+    // a soft deadline lets the rollout finish, it's only checked between playouts
+    if (terminal || (p.hardDeadline && deadline.expired()))
       break;
-    MCTS_TIC(SELECT_PLANNING_ACTION);
-    action = valueEstimator->selectPlanningAction(state);
+    numSteps++;
+    if (!inTree) {
+      profile.start(MCTSPhase::DEFAULT_POLICY);
+      // not the estimator's choice, the state may still have stats from
+      // earlier rollouts, and those are only for selecting inside the tree
+      action = rolloutPolicy->selectAction(model,state,*policyRNG);
+      model->takeAction(action,reward,newState,terminal,depth_count);
+      modelUpdater->updateSimulationAction(action,newState);
+      estimator->visitDefaultPolicy(state,reward);
+      profile.stop(MCTSPhase::DEFAULT_POLICY);
+      state = newState;
+      transform = stateMapping->map(state); // discretize state
+      continue;
+    }
+    if (p.expandOneNode && !estimator->isInTree(state))
+      inTree = false; // this state is the new node
+    numTreeSteps++;
+    profile.start(MCTSPhase::SELECT_PLANNING_ACTION);
+    // the estimator's actions are in the mapped state, the model's in the original
+    mappedAction = estimator->selectPlanningAction(state);
+    action = stateMapping->unmapAction(mappedAction,transform);
     MCTS_OUTPUT("ACTION: " << action);
-    MCTS_TOC(SELECT_PLANNING_ACTION);
+    profile.stop(MCTSPhase::SELECT_PLANNING_ACTION);
     //std::cout << action << std::endl;
-    MCTS_TIC(TAKE_ACTION);
+    profile.start(MCTSPhase::TAKE_ACTION);
     model->takeAction(action,reward,newState,terminal, depth_count);
-    MCTS_TOC(TAKE_ACTION);
+    profile.stop(MCTSPhase::TAKE_ACTION);
     modelUpdater->updateSimulationAction(action,newState);
-    MCTS_TIC(VISIT);
-    valueEstimator->visit(state,action,reward);
-    MCTS_TOC(VISIT);
+    profile.start(MCTSPhase::VISIT);
+    estimator->visit(state,mappedAction,reward);
+    profile.stop(MCTSPhase::VISIT);
     state = newState;
-    stateMapping->map(state); // discretize state
+    transform = stateMapping->map(state); // discretize state
   }
 
-  MCTS_TIC(FINISH_ROLLOUT);
-  valueEstimator->finishRollout(state,terminal);
-  MCTS_TOC(FINISH_ROLLOUT);
+  profile.start(MCTSPhase::FINISH_ROLLOUT);
+  estimator->finishRollout(state,terminal);
+  profile.stop(MCTSPhase::FINISH_ROLLOUT);
+  profile.addRollout(numSteps,numTreeSteps);
   MCTS_OUTPUT("------------STOP  ROLLOUT--------------");
   return terminal;
 }
@@ -0,0 +1,157 @@
+#ifndef MCTSPROFILE_F2K9WD7R
+#define MCTSPROFILE_F2K9WD7R
+
+/*
+File: MCTSProfile.h
+Author: Samuel Barrett
+Description: always on profiling counters for MCTS. Each search thread
+  fills its own profile, so counting never takes a lock, and MCTS adds them
+  together after every search. The phases are timed with the cycle counter
+  where there is one and the monotonic clock otherwise.
+Created:  2013-08-16
+Modified: 2013-08-16
+*/
+
+#include <vector>
+#include <time.h>
+#include <boost/cstdint.hpp>
+#include <rl_pursuit/common/Enum.h>
+#include <rl_pursuit/json/json.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+ENUM(MCTSPhase,
+  SELECT_MODEL,
+  SET_MODEL,
+  START_ROLLOUT,
+  SELECT_PLANNING_ACTION,
+  TAKE_ACTION,
+  VISIT,
+  DEFAULT_POLICY,
+  FINISH_ROLLOUT
+)
+
+inline uint64_t readCycleCounter() {
+#if defined(__i386__) || defined(__x86_64__)
+  return __rdtsc();
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC,&ts);
+  return ts.tv_sec * 1000000000ull + ts.tv_nsec;
+#endif
+}
+
+class MCTSProfile {
+public:
+  static const unsigned int NUM_DEPTH_BINS = 64; // the last bin also holds everything deeper
+
+  MCTSProfile() {
+    reset();
+  }
+
+  void reset() {
+    for (unsigned int i = 0; i < MCTSPhase::NUM; i++) {
+      cycles[i] = 0;
+      calls[i] = 0;
+    }
+    phaseStart = 0;
+    rolloutDepths.assign(NUM_DEPTH_BINS,0);
+    treeDepths.assign(NUM_DEPTH_BINS,0);
+    searches = 0;
+    playouts = 0;
+    searchTime = 0;
+    numNodes = 0;
+    maxNodes = 0;
+  }
+
+  // phases don't nest
+  inline void start(MCTSPhase_t /*phase*/) {
+    phaseStart = readCycleCounter();
+  }
+
+  inline void stop(MCTSPhase_t phase) {
+    cycles[phase] += readCycleCounter() - phaseStart;
+    calls[phase]++;
+  }
+
+  // depth is the number of steps simulated, treeDepth the ones that used the tree
+  void addRollout(unsigned int depth, unsigned int treeDepth) {
+    rolloutDepths[min(depth,NUM_DEPTH_BINS - 1)]++;
+    treeDepths[min(treeDepth,NUM_DEPTH_BINS - 1)]++;
+    playouts++;
+  }
+
+  void addSearch(double time, size_t nodes) {
+    searches++;
+    searchTime += time;
+    numNodes = nodes;
+    if (nodes > maxNodes)
+      maxNodes = nodes;
+  }
+
+  // adds the counts of a profile from another thread of the same search
+  void add(const MCTSProfile &other) {
+    for (unsigned int i = 0; i < MCTSPhase::NUM; i++) {
+      cycles[i] += other.cycles[i];
+      calls[i] += other.calls[i];
+    }
+    for (unsigned int i = 0; i < NUM_DEPTH_BINS; i++) {
+      rolloutDepths[i] += other.rolloutDepths[i];
+      treeDepths[i] += other.treeDepths[i];
+    }
+    playouts += other.playouts;
+  }
+
+  unsigned int getNumPlayouts() const {
+    return playouts;
+  }
+
+  Json::Value toJson() const {
+    Json::Value val;
+    for (unsigned int i = 0; i < MCTSPhase::NUM; i++) {
+      Json::Value &phase = val["phases"][getName((MCTSPhase_t)i)];
+      phase["cycles"] = (double)cycles[i]; // our json doesn't have 64 bit ints
+      phase["calls"] = (double)calls[i];
+    }
+    val["searches"] = searches;
+    val["playouts"] = playouts;
+    val["searchTime"] = searchTime;
+    val["playoutsPerSecond"] = (searchTime > 0) ? playouts / searchTime : 0.0;
+    val["nodes"] = (double)numNodes;
+    val["maxNodes"] = (double)maxNodes;
+    val["rolloutDepths"] = histogramToJson(rolloutDepths);
+    val["treeDepths"] = histogramToJson(treeDepths);
+    return val;
+  }
+
+private:
+  static unsigned int min(unsigned int x, unsigned int y) {
+    return (x < y) ? x : y;
+  }
+
+  // trailing empty bins are left out
+  static Json::Value histogramToJson(const std::vector<unsigned int> &bins) {
+    Json::Value val(Json::arrayValue);
+    unsigned int end = bins.size();
+    while ((end > 0) && (bins[end - 1] == 0))
+      end--;
+    for (unsigned int i = 0; i < end; i++)
+      val.append(bins[i]);
+    return val;
+  }
+
+  uint64_t cycles[MCTSPhase::NUM];
+  uint64_t calls[MCTSPhase::NUM];
+  uint64_t phaseStart;
+  std::vector<unsigned int> rolloutDepths;
+  std::vector<unsigned int> treeDepths;
+  unsigned int searches;
+  unsigned int playouts;
+  double searchTime;
+  size_t numNodes;
+  size_t maxNodes;
+};
+
+#endif /* end of include guard: MCTSPROFILE_F2K9WD7R */
@@ -11,6 +11,7 @@ Modified: 2013-08-08
 
 #include <string>
 #include <boost/shared_ptr.hpp>
+#include <rl_pursuit/common/RNG.h>
 
 template<class State, class Action>
 class Model {
@@ -24,6 +25,7 @@ public:
   virtual void takeAction(const Action &action, float &reward, State &state, bool &terminal, int &depth_count) = 0;
   virtual void getFirstAction(const State &state, Action &action) = 0;
   virtual bool getNextAction(const State &state, Action &action) = 0; // returns true if there is a next action, else false
+  virtual void setRNG(boost::shared_ptr<RNG> /*rng*/) {} // models with stochastic transitions should draw from rng afterwards
 
   virtual std::string generateDescription(unsigned int indentation = 0) = 0;
 };
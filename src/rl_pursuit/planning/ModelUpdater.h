@@ -5,11 +5,12 @@
 File:     ModelUpdater.h
 Author:   Samuel Barrett
 Created:  2013-08-08
-Modified: 2013-08-08
+Modified: 2013-08-19
 Description: abstract class for a model updater - selects a model for the MCTS rollouts
 */
 
 #include <boost/shared_ptr.hpp>
+#include <rl_pursuit/common/RNG.h>
 #include "Model.h"
 
 template<class State, class Action>
@@ -21,6 +22,16 @@ public:
   virtual ~ModelUpdater() {}
 
   virtual boost::shared_ptr<Model<State,Action> > selectModel(const State &state) = 0;
+  // selects an independent copy of a model that samples from rng for search
+  // worker workerInd, without modifying anything other workers use, so it can
+  // be called from several search threads at once. Updaters that can't
+  // provide independent copies return NULL.
+  virtual boost::shared_ptr<Model<State,Action> > selectModel(const State &/*state*/, boost::shared_ptr<RNG> /*rng*/, unsigned int /*workerInd*/) {
+    return boost::shared_ptr<Model<State,Action> >();
+  }
+  // the worker indices passed to selectModel will be below numWorkers
+  virtual void setNumSearchWorkers(unsigned int /*numWorkers*/) {
+  }
   virtual void updateSimulationAction(const Action &action, const State &state) = 0;
   virtual void updateRealWorldAction(const State &prevState, const Action &lastAction, const State &currentState) = 0;
 };
@@ -47,7 +47,7 @@ public:
   void updateSimulationAction(const Action &action, const State &state);
 
 protected:
-  unsigned int selectModelInd(const State &state);
+  unsigned int selectModelInd(const State &state, RNG &rng);
   void getNewModelProbs(const State &prevState, Action lastAction, const State &currentState, std::vector<double> &newModelProbs);
   double calculateModelProb(unsigned int modelInd, const State &prevState, Action lastAction, const State &currentState);
   bool allProbsTooLow(const std::vector<double> &newModelProbs);
@@ -131,9 +131,9 @@ void ModelUpdaterBayes<State,Action>::updateSimulationAction(const Action &, con
 }
 
 template<class State, class Action>
-unsigned int ModelUpdaterBayes<State,Action>::selectModelInd(const State_t &) {
+unsigned int ModelUpdaterBayes<State,Action>::selectModelInd(const State &, RNG &rng) {
   // sample the current probs
-  float val = rng->randomFloat();
+  float val = rng.randomFloat();
   double total = 0;
   unsigned int selectedInd;
   for (selectedInd = 0; selectedInd < models.size() - 1; selectedInd++) { // -1 because if it's not in the first n - 1, it's in the last and it makes the later processing easier
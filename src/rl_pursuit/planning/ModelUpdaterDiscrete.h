@@ -5,7 +5,7 @@
 File:     ModelUpdaterDiscrete.h
 Author:   Samuel Barrett
 Created:  2013-08-08
-Modified: 2013-08-08
+Modified: 2013-08-19
 Description: abstract class for updating a set of discrete models
 */
 
@@ -37,6 +37,7 @@ public:
   void set(const ModelUpdaterDiscrete &other);
   virtual void learnControllers(const State &prevState, const State &currentState);
   boost::shared_ptr<Model<State,Action> > selectModel(const State &state);
+  boost::shared_ptr<Model<State,Action> > selectModel(const State &state, boost::shared_ptr<RNG> rng, unsigned int workerInd);
   std::string generateDescription(unsigned int indentation = 0);
   //std::vector<double> getBeliefs();
   void updateControllerInformation(const State &state);
@@ -46,7 +47,7 @@ public:
   void output(std::ostream &out);
 
 protected:
-  virtual unsigned int selectModelInd(const State &state) = 0;
+  virtual unsigned int selectModelInd(const State &state, RNG &rng) = 0;
   void removeModel(unsigned int ind);
   virtual std::string generateSpecificDescription() = 0;
 
@@ -96,7 +97,7 @@ void ModelUpdaterDiscrete<State,Action>::learnControllers(const State &prevState
 
 template<class State, class Action>
 boost::shared_ptr<Model<State,Action> > ModelUpdaterDiscrete<State,Action>::selectModel(const State &state) {
-  unsigned int ind = selectModelInd(state);
+  unsigned int ind = selectModelInd(state,*rng);
   //boost::shared_ptr<WorldMDP> mdp(new WorldMDP(*(models[ind].mdp)));
   boost::shared_ptr<Model<State,Action> > mdp = models[ind].mdp->clone();
   mdp->setState(state);
@@ -106,6 +107,18 @@ boost::shared_ptr<Model<State,Action> > ModelUpdaterDiscrete<State,Action>::sele
   //mdp->setAgents(models[ind]);
 }
 
+template<class State, class Action>
+boost::shared_ptr<Model<State,Action> > ModelUpdaterDiscrete<State,Action>::selectModel(const State &state, boost::shared_ptr<RNG> rng, unsigned int /*workerInd*/) {
+  // only reads the models, the sampling and the copy's randomness both come
+  // from rng. Like the planning thread's models, the copies aren't pooled
+  unsigned int ind = selectModelInd(state,*rng);
+  boost::shared_ptr<Model<State,Action> > mdp = models[ind].mdp->clone();
+  mdp->setRNG(rng);
+  mdp->setState(state);
+  MODELUPDATER_OUTPUT("Select Model: " << ind << " " << models[ind].description);
+  return mdp;
+}
+
 template<class State, class Action>
 void ModelUpdaterDiscrete<State,Action>::normalizeModelProbs() {
   double total = 0;
@@ -0,0 +1,95 @@
+#ifndef NEXTSTATESTATS_B3X8KR5M
+#define NEXTSTATESTATS_B3X8KR5M
+
+/*
+File: NextStateStats.h
+Author: Samuel Barrett
+Description: the next states seen after a state-action in the UCTEstimator,
+  with their visit counts and mean values in one contiguous record list.
+  The visit weighted sum of the values is kept as they're updated, so the
+  importance sampling estimate doesn't need a pass over the successors.
+  Records that are hit move towards the front, so the lookup for common
+  successors stays short.
+Created:  2013-08-15
+Modified: 2013-08-15
+*/
+
+#include <rl_pursuit/common/SmallVector.h>
+
+template<class State>
+class NextStateStats {
+public:
+  struct Record {
+    Record(const State &state = State()):
+      state(state),
+      visits(0),
+      val(0)
+    {}
+    State state;
+    unsigned int visits;
+    float val;
+  };
+  typedef SmallVector<Record,2> Records;
+  typedef typename Records::const_iterator const_iterator;
+  typedef const_iterator iterator; // the records only change through update
+
+  NextStateStats():
+    totalVisits(0),
+    weightedSum(0)
+  {}
+
+  // only counts the visit, the value isn't tracked
+  void addVisit(const State &state) {
+    find(state).visits++;
+    totalVisits++;
+  }
+
+  // averages newQ into the value for state and returns the visit weighted
+  // value over all of the next states
+  float update(const State &state, float newQ) {
+    Record &record = find(state);
+    record.visits++;
+    record.val += (newQ - record.val) / record.visits;
+    totalVisits++;
+    // visits * val grows by exactly newQ with the running mean
+    weightedSum += newQ;
+    return value();
+  }
+
+  float value() const {
+    if (totalVisits == 0)
+      return 0;
+    return weightedSum / totalVisits;
+  }
+
+  unsigned int getTotalVisits() const {
+    return totalVisits;
+  }
+
+  size_t size() const { return records.size(); }
+  const_iterator begin() const { return records.begin(); }
+  const_iterator end() const { return records.end(); }
+
+private:
+  Record& find(const State &state) {
+    for (unsigned int i = 0; i < records.size(); i++) {
+      if (records[i].state == state) {
+        if (i == 0)
+          return records[0];
+        // transpose with the previous record
+        Record temp = records[i - 1];
+        records[i - 1] = records[i];
+        records[i] = temp;
+        return records[i - 1];
+      }
+    }
+    records.push_back(Record(state));
+    return records[records.size() - 1];
+  }
+
+  Records records;
+  unsigned int totalVisits;
+  double weightedSum;
+};
+
+#endif /* end of include guard: NEXTSTATESTATS_B3X8KR5M */
@@ -0,0 +1,461 @@
+#ifndef PARALLELUCTESTIMATOR_H_Q3VKD8RE
+#define PARALLELUCTESTIMATOR_H_Q3VKD8RE
+
+/*
+File:     ParallelUCTEstimator.h
+Author:   Samuel Barrett
+Created:  2013-08-12
+Modified: 2013-08-19
+Description: a UCT estimator with a single tree shared by several search threads.
+  The nodes are split into lock-striped shards, the rollout history is kept per
+  thread, and virtual losses on in-progress rollouts spread the threads over
+  different branches. restart and pruneOldVisits must not run during a search.
+*/
+
+#include <algorithm>
+#include <map>
+#include <set>
+#include <vector>
+#include <boost/functional/hash.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "UCTEstimator.h"
+
+template<class State, class Action>
+class ParallelUCTEstimator: public UCTEstimator<State,Action> {
+public:
+  typedef boost::shared_ptr<ParallelUCTEstimator<State,Action> > Ptr;
+  typedef UCTEstimator<State,Action> Base;
+  typedef typename Base::StateInfo StateInfo;
+  typedef typename Base::StateActionInfo StateActionInfo;
+  typedef typename Base::HistoryStep HistoryStep;
+  typedef typename std::map<State,StateInfo>::iterator StateIter;
+  typedef typename Base::StateActionIter StateActionIter;
+
+#define PARAMS(_) \
+  _(float,virtualLoss,virtualLoss,1) \
+  _(float,virtualLossValue,virtualLossValue,0) \
+  _(unsigned int,numLocks,numLocks,64)
+
+  Params_STRUCT(PARAMS)
+#undef PARAMS
+
+  ParallelUCTEstimator(boost::shared_ptr<RNG> rng, const typename Base::Params &uctParams, const Params &p);
+
+  virtual Action selectWorldAction(const State &state);
+  virtual Action selectPlanningAction(const State &state);
+  virtual void startRollout();
+  virtual void finishRollout(const State &state, bool terminal);
+  virtual void visit(const State &state, const Action &action, float reward);
+  virtual bool isInTree(const State &state);
+  virtual size_t getNumNodes();
+  virtual void visitDefaultPolicy(const State &state, float reward);
+  virtual void restart();
+  virtual void setModel(boost::shared_ptr<Model<State,Action> > nmodel);
+  virtual std::string generateDescription(unsigned int indentation = 0);
+  void pruneOldVisits(int memorySize);
+  void reroot(const State &state);
+  virtual void getActionStats(const State &state, std::vector<ActionStats<Action> > &stats);
+  virtual void addActionStats(const State &state, const std::vector<ActionStats<Action> > &stats);
+  virtual void removeActionStats(const State &state, const std::vector<ActionStats<Action> > &stats);
+
+protected:
+  struct Shard {
+    boost::mutex mutex;
+    std::map<State,StateInfo> stateInfos; // not a flat table, other threads hold pointers into it
+  };
+
+  struct ThreadInfo {
+    ThreadInfo(uint32_t seed):
+      rng(new RNG(seed))
+    {
+    }
+    boost::shared_ptr<RNG> rng;
+    boost::shared_ptr<Model<State,Action> > model;
+    std::vector<HistoryStep> history;
+    std::map<StateActionInfo*,unsigned int> rolloutVisits;
+    typename Base::DefaultPolicyTail tail;
+  };
+
+  Shard& getShard(const State &state);
+  ThreadInfo& getThreadInfo();
+  StateInfo* findStateInfo(Shard &shard, const State &state); // shard must be locked
+  // the virtual visits without the calling thread's own, its shard must be locked
+  unsigned int getOtherVirtualVisits(StateActionInfo *stateActionInfo);
+  Action selectAction(const State &state, bool useBounds);
+  virtual float maxValueForState(const State &state, StateInfo *stateInfo);
+  virtual float calcActionValue(StateActionInfo *stateActionInfo, StateInfo *stateInfo, bool useBounds);
+
+protected:
+  Params parallelParams;
+  std::vector<boost::shared_ptr<Shard> > shards;
+  boost::thread_specific_ptr<ThreadInfo> threadInfo;
+  boost::mutex rngMutex;
+};
+
+////////////////////////////////////////////////////////////////////////////
+
+template<class State, class Action>
+ParallelUCTEstimator<State,Action>::ParallelUCTEstimator(boost::shared_ptr<RNG> rng, const typename Base::Params &uctParams, const Params &p):
+  UCTEstimator<State,Action>(rng,uctParams),
+  parallelParams(p)
+{
+  if (parallelParams.numLocks == 0)
+    parallelParams.numLocks = 1;
+  for (unsigned int i = 0; i < parallelParams.numLocks; i++)
+    shards.push_back(boost::shared_ptr<Shard>(new Shard()));
+}
+
+template<class State, class Action>
+typename ParallelUCTEstimator<State,Action>::Shard& ParallelUCTEstimator<State,Action>::getShard(const State &state) {
+  return *(shards[boost::hash<State>()(state) % shards.size()]);
+}
+
+template<class State, class Action>
+typename ParallelUCTEstimator<State,Action>::ThreadInfo& ParallelUCTEstimator<State,Action>::getThreadInfo() {
+  ThreadInfo *info = threadInfo.get();
+  if (info == NULL) {
+    // each thread gets its own random stream for breaking ties
+    boost::mutex::scoped_lock lock(rngMutex);
+    info = new ThreadInfo(this->rng->randomUInt());
+    threadInfo.reset(info);
+  }
+  return *info;
+}
+
+template<class State, class Action>
+typename ParallelUCTEstimator<State,Action>::StateInfo* ParallelUCTEstimator<State,Action>::findStateInfo(Shard &shard, const State &state) {
+  StateIter it = shard.stateInfos.find(state);
+  if (it == shard.stateInfos.end())
+    return NULL;
+  return &(it->second);
+}
+
+template<class State, class Action>
+unsigned int ParallelUCTEstimator<State,Action>::getOtherVirtualVisits(StateActionInfo *stateActionInfo) {
+  // a rollout that loops back through an action shouldn't be put off by itself
+  ThreadInfo &info = getThreadInfo();
+  typename std::map<StateActionInfo*,unsigned int>::iterator it = info.rolloutVisits.find(stateActionInfo);
+  if (it == info.rolloutVisits.end())
+    return stateActionInfo->virtualVisits;
+  return stateActionInfo->virtualVisits - it->second;
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::setModel(boost::shared_ptr<Model<State,Action> > nmodel) {
+  getThreadInfo().model = nmodel;
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::startRollout() {
+  ThreadInfo &info = getThreadInfo();
+  info.history.clear();
+  info.rolloutVisits.clear();
+  info.tail = typename Base::DefaultPolicyTail();
+}
+
+template<class State, class Action>
+bool ParallelUCTEstimator<State,Action>::isInTree(const State &state) {
+  Shard &shard = getShard(state);
+  boost::mutex::scoped_lock lock(shard.mutex);
+  return findStateInfo(shard,state) != NULL;
+}
+
+template<class State, class Action>
+size_t ParallelUCTEstimator<State,Action>::getNumNodes() {
+  size_t numNodes = 0;
+  for (unsigned int i = 0; i < shards.size(); i++) {
+    boost::mutex::scoped_lock lock(shards[i]->mutex);
+    numNodes += shards[i]->stateInfos.size();
+  }
+  return numNodes;
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::visitDefaultPolicy(const State &state, float reward) {
+  getThreadInfo().tail.add(state,reward,this->p.gamma);
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::visit(const State &state, const Action &action, float reward) {
+  ThreadInfo &info = getThreadInfo();
+  Shard &shard = getShard(state);
+  boost::mutex::scoped_lock lock(shard.mutex);
+
+  StateIter it = shard.stateInfos.find(state);
+  if (it == shard.stateInfos.end())
+    it = shard.stateInfos.insert(std::pair<State,StateInfo>(state,StateInfo(this->p.initialStateVisits))).first;
+  StateInfo *stateInfo = &(it->second);
+
+  StateActionIter ita = stateInfo->actionInfos.find(action);
+  if (ita == stateInfo->actionInfos.end())
+    ita = stateInfo->actionInfos.insert(std::pair<Action,StateActionInfo>(action,StateActionInfo(this->p.initialStateActionVisits,this->p.initialValue))).first;
+  StateActionInfo *stateActionInfo = &(ita->second);
+
+  stateActionInfo->virtualVisits++;
+  info.rolloutVisits[stateActionInfo]++;
+  info.history.push_back(HistoryStep(state,action,reward,stateActionInfo,stateInfo));
+}
+
+template<class State, class Action>
+Action ParallelUCTEstimator<State,Action>::selectAction(const State &state, bool useBounds) {
+  ThreadInfo &info = getThreadInfo();
+  Shard &shard = getShard(state);
+  boost::mutex::scoped_lock lock(shard.mutex);
+  StateInfo *stateInfo = findStateInfo(shard,state);
+
+  std::vector<Action> maxActions;
+  float maxVal = -Base::BIGNUM;
+  float val;
+  Action a;
+  bool actionValid = true;
+  for (info.model->getFirstAction(state,a); actionValid; actionValid = info.model->getNextAction(state,a)) {
+    StateActionInfo *stateActionInfo = NULL;
+    if (stateInfo != NULL) {
+      StateActionIter ita = stateInfo->actionInfos.find(a);
+      if (ita != stateInfo->actionInfos.end()) {
+        stateActionInfo = &(ita->second);
+        // actions that are only being tried by other threads still carry their virtual loss
+        if ((stateActionInfo->visits == 0) && (!useBounds || (getOtherVirtualVisits(stateActionInfo) == 0)))
+          stateActionInfo = NULL;
+      }
+    }
+    val = calcActionValue(stateActionInfo,stateInfo,useBounds);
+    if (fabs(val - maxVal) < Base::EPS)
+      maxActions.push_back(a);
+    else if (val > maxVal) {
+      maxVal = val;
+      maxActions.clear();
+      maxActions.push_back(a);
+    }
+  }
+  return maxActions[info.rng->randomInt(maxActions.size())];
+}
+
+template<class State, class Action>
+Action ParallelUCTEstimator<State,Action>::selectWorldAction(const State &state) {
+  return selectAction(state,false);
+}
+
+template<class State, class Action>
+Action ParallelUCTEstimator<State,Action>::selectPlanningAction(const State &state) {
+  return selectAction(state,true);
+}
+
+template<class State, class Action>
+float ParallelUCTEstimator<State,Action>::calcActionValue(StateActionInfo *stateActionInfo, StateInfo *stateInfo, bool useBounds) {
+  unsigned int otherVirtualVisits = (useBounds && (stateActionInfo != NULL)) ? getOtherVirtualVisits(stateActionInfo) : 0;
+  if (otherVirtualVisits == 0)
+    return Base::calcActionValue(stateActionInfo,stateInfo,useBounds);
+  // count the other threads' rollouts in progress as losses
+  float loss = parallelParams.virtualLoss * otherVirtualVisits;
+  float na = stateActionInfo->visits + loss;
+  float n = max(1.0f,stateInfo->stateVisits + loss);
+  if (na <= 0)
+    return this->p.unseenValue;
+  float val = (stateActionInfo->visits * stateActionInfo->val + loss * parallelParams.virtualLossValue) / na;
+  return val + this->p.rewardBound * sqrt(log(n) / na);
+}
+
+template<class State, class Action>
+float ParallelUCTEstimator<State,Action>::maxValueForState(const State &state, StateInfo *stateInfo) {
+  // the caller holds the lock for the state's shard
+  if (stateInfo == NULL)
+    return this->p.initialValue;
+
+  ThreadInfo &info = getThreadInfo();
+  float maxVal = -Base::BIGNUM;
+  Action a;
+  bool actionValid = true;
+  int totalVisits = 0;
+  for (info.model->getFirstAction(state,a); actionValid; actionValid = info.model->getNextAction(state,a)) {
+    StateActionIter ita = stateInfo->actionInfos.find(a);
+    StateActionInfo* stateActionInfo = NULL;
+    if (ita != stateInfo->actionInfos.end()) {
+      stateActionInfo = &(ita->second);
+      totalVisits += stateActionInfo->visits;
+      if (stateActionInfo->visits == 0)
+        stateActionInfo = NULL;
+    }
+    float val = Base::calcActionValue(stateActionInfo,stateInfo,false);
+    if (val > maxVal)
+      maxVal = val;
+  }
+  if (totalVisits == 0)
+    return this->p.initialValue;
+  return maxVal;
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::finishRollout(const State &state, bool terminal) {
+  ThreadInfo &info = getThreadInfo();
+  float futureVal;
+  float newQ;
+
+  if (terminal)
+    futureVal = 0;
+  else {
+    Shard &shard = getShard(state);
+    boost::mutex::scoped_lock lock(shard.mutex);
+    futureVal = maxValueForState(state,findStateInfo(shard,state));
+  }
+  futureVal = info.tail.value + info.tail.discount * futureVal;
+
+  State next_state = (info.tail.steps > 0) ? info.tail.firstState : state;
+  for (int i = (int)info.history.size() - 1; i >= 0; i--) {
+    HistoryStep &step = info.history[i];
+    newQ = step.reward + this->p.gamma * futureVal;
+    {
+      Shard &shard = getShard(step.state);
+      boost::mutex::scoped_lock lock(shard.mutex);
+      unsigned int &rolloutVisits = info.rolloutVisits[step.stateActionInfo];
+      if (rolloutVisits == 1)
+        newQ = this->updateStateAction(step.state,step.action,next_state,step.stateActionInfo,step.stateInfo,newQ);
+      rolloutVisits--;
+      step.stateActionInfo->virtualVisits--;
+    }
+    futureVal = newQ;
+    next_state = step.state;
+  }
+  info.history.clear();
+  info.rolloutVisits.clear();
+  info.tail = typename Base::DefaultPolicyTail();
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::restart() {
+  for (unsigned int i = 0; i < shards.size(); i++) {
+    boost::mutex::scoped_lock lock(shards[i]->mutex);
+    shards[i]->stateInfos.clear();
+  }
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::pruneOldVisits(int memorySize) {
+  // 1 keeps the most recent, 0 keeps none, <0 means no pruning
+  this->numPruneCalls++;
+  if (memorySize < 0)
+    return;
+  for (unsigned int i = 0; i < shards.size(); i++) {
+    boost::mutex::scoped_lock lock(shards[i]->mutex);
+    std::map<State,StateInfo> &stateInfos = shards[i]->stateInfos;
+    StateIter it = stateInfos.begin();
+    while (it != stateInfos.end()) {
+      if (it->second.lastVisit < this->numPruneCalls - memorySize)
+        stateInfos.erase(it++);
+      else
+        ++it;
+    }
+  }
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::reroot(const State &state) {
+  this->numPruneCalls++;
+  std::set<State> reachable;
+  std::vector<State> open(1,state);
+  while (open.size() > 0) {
+    State s = open.back();
+    open.pop_back();
+    if (reachable.count(s) > 0)
+      continue;
+    Shard &shard = getShard(s);
+    boost::mutex::scoped_lock lock(shard.mutex);
+    StateInfo *stateInfo = findStateInfo(shard,s);
+    if (stateInfo == NULL)
+      continue;
+    reachable.insert(s);
+    for (StateActionIter ita = stateInfo->actionInfos.begin(); ita != stateInfo->actionInfos.end(); ++ita) {
+      BOOST_FOREACH(const typename NextStateStats<State>::Record &record, ita->second.next_states)
+        open.push_back(record.state);
+    }
+  }
+
+  for (unsigned int i = 0; i < shards.size(); i++) {
+    boost::mutex::scoped_lock lock(shards[i]->mutex);
+    std::map<State,StateInfo> &stateInfos = shards[i]->stateInfos;
+    StateIter it = stateInfos.begin();
+    while (it != stateInfos.end()) {
+      if (reachable.count(it->first) == 0)
+        stateInfos.erase(it++);
+      else
+        ++it;
+    }
+  }
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::getActionStats(const State &state, std::vector<ActionStats<Action> > &stats) {
+  stats.clear();
+  Shard &shard = getShard(state);
+  boost::mutex::scoped_lock lock(shard.mutex);
+  StateInfo *stateInfo = findStateInfo(shard,state);
+  if (stateInfo == NULL)
+    return;
+  for (StateActionIter ita = stateInfo->actionInfos.begin(); ita != stateInfo->actionInfos.end(); ++ita) {
+    if (ita->second.visits > 0)
+      stats.push_back(ActionStats<Action>(ita->first,ita->second.visits,ita->second.val));
+  }
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::addActionStats(const State &state, const std::vector<ActionStats<Action> > &stats) {
+  if (stats.size() == 0)
+    return;
+  Shard &shard = getShard(state);
+  boost::mutex::scoped_lock lock(shard.mutex);
+  StateIter it = shard.stateInfos.find(state);
+  if (it == shard.stateInfos.end())
+    it = shard.stateInfos.insert(std::pair<State,StateInfo>(state,StateInfo(this->p.initialStateVisits))).first;
+  StateInfo *stateInfo = &(it->second);
+  stateInfo->lastVisit = this->numPruneCalls;
+
+  for (unsigned int i = 0; i < stats.size(); i++) {
+    if (stats[i].visits == 0)
+      continue;
+    StateActionIter ita = stateInfo->actionInfos.find(stats[i].action);
+    if (ita == stateInfo->actionInfos.end())
+      ita = stateInfo->actionInfos.insert(std::pair<Action,StateActionInfo>(stats[i].action,StateActionInfo(this->p.initialStateActionVisits,this->p.initialValue))).first;
+    StateActionInfo *stateActionInfo = &(ita->second);
+    unsigned int visits = stateActionInfo->visits + stats[i].visits;
+    stateActionInfo->val = (stateActionInfo->visits * stateActionInfo->val + stats[i].visits * stats[i].val) / visits;
+    stateActionInfo->visits = visits;
+    stateInfo->stateVisits += stats[i].visits;
+  }
+}
+
+template<class State, class Action>
+void ParallelUCTEstimator<State,Action>::removeActionStats(const State &state, const std::vector<ActionStats<Action> > &stats) {
+  Shard &shard = getShard(state);
+  boost::mutex::scoped_lock lock(shard.mutex);
+  StateInfo *stateInfo = findStateInfo(shard,state);
+  if (stateInfo == NULL)
+    return;
+  for (unsigned int i = 0; i < stats.size(); i++) {
+    StateActionIter ita = stateInfo->actionInfos.find(stats[i].action);
+    if (ita == stateInfo->actionInfos.end())
+      continue;
+    StateActionInfo *stateActionInfo = &(ita->second);
+    unsigned int removed = std::min(stats[i].visits,stateActionInfo->visits);
+    unsigned int visits = stateActionInfo->visits - removed;
+    if (visits == 0)
+      stateActionInfo->val = this->p.initialValue;
+    else
+      stateActionInfo->val = (stateActionInfo->visits * stateActionInfo->val - removed * stats[i].val) / visits;
+    stateActionInfo->visits = visits;
+    stateInfo->stateVisits -= std::min(removed,stateInfo->stateVisits);
+  }
+}
+
+template<class State, class Action>
+std::string ParallelUCTEstimator<State,Action>::generateDescription(unsigned int indentation) {
+  std::stringstream ss;
+  ss << Base::generateDescription(indentation) << "\n";
+  std::string prefix = indent(indentation+1);
+  ss << prefix << "shared tree, locks: " << shards.size() << "\n";
+  ss << prefix << "virtualLoss: " << parallelParams.virtualLoss << " of " << parallelParams.virtualLossValue;
+  return ss.str();
+}
+
+#endif /* end of include guard: PARALLELUCTESTIMATOR_H_Q3VKD8RE */
@@ -0,0 +1,56 @@
+#ifndef ROLLOUTPOLICY_T6J2MW9C
+#define ROLLOUTPOLICY_T6J2MW9C
+
+/*
+File: RolloutPolicy.h
+Author: Samuel Barrett
+Description: the default policy that finishes a rollout once MCTS has left
+  the tree, when it's expanding a single node per rollout. The rng is the one
+  for the searching thread.
+Created:  2013-08-16
+Modified: 2013-08-16
+*/
+
+#include <string>
+#include <boost/shared_ptr.hpp>
+#include "Model.h"
+#include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/common/Util.h>
+
+template<class State, class Action>
+class RolloutPolicy {
+public:
+  typedef boost::shared_ptr<RolloutPolicy<State,Action> > Ptr;
+  typedef typename Model<State,Action>::Ptr ModelPtr;
+
+  virtual ~RolloutPolicy() {}
+  // model is already in state
+  virtual Action selectAction(ModelPtr model, const State &state, RNG &rng) = 0;
+  virtual std::string generateDescription(unsigned int indentation = 0) = 0;
+};
+
+template<class State, class Action>
+class RandomRolloutPolicy: public RolloutPolicy<State,Action> {
+public:
+  typedef typename Model<State,Action>::Ptr ModelPtr;
+
+  Action selectAction(ModelPtr model, const State &state, RNG &rng) {
+    // count the actions, then walk to the chosen one, so nothing is allocated
+    Action a;
+    int numActions = 1;
+    model->getFirstAction(state,a);
+    while (model->getNextAction(state,a))
+      numActions++;
+    int ind = rng.randomInt(numActions);
+    model->getFirstAction(state,a);
+    for (int i = 0; i < ind; i++)
+      model->getNextAction(state,a);
+    return a;
+  }
+
+  std::string generateDescription(unsigned int indentation = 0) {
+    return indent(indentation) + "RandomRolloutPolicy";
+  }
+};
+
+#endif /* end of include guard: ROLLOUTPOLICY_T6J2MW9C */
@@ -3,16 +3,27 @@
 
 #include <boost/shared_ptr.hpp>
 
-template<class State>
+template<class State, class Action>
 class StateMapping {
 public:
-  typedef boost::shared_ptr<StateMapping<State> > Ptr;
+  typedef boost::shared_ptr<StateMapping<State,Action> > Ptr;
+  // how map moved the state, mappings between symmetric states need it
+  // to move the actions along with the state
+  typedef unsigned int Transform;
+  enum {IDENTITY = 0};
 
   StateMapping() {}
   virtual ~StateMapping() {}
 
-  virtual void map(State &state) = 0;
+  virtual Transform map(State &state) = 0;
+  // an action in the original state to the same action in the mapped state
+  virtual Action mapAction(const Action &action, Transform /*transform*/) {
+    return action;
+  }
+  // an action in the mapped state back to the original state
+  virtual Action unmapAction(const Action &action, Transform /*transform*/) {
+    return action;
+  }
 };
 
 #endif /* end of include guard: STATEMAPPING_H_WATHCNZF */
-
@@ -6,7 +6,7 @@ File: UCTEstimator.h
 Author: Samuel Barrett
 Description: a value estimator based on UCT
 Created:  2011-08-23
-Modified: 2013-08-08
+Modified: 2013-08-19
 */
 
 #include <iostream>
@@ -14,15 +14,18 @@ Modified: 2013-08-08
 #include <string>
 #include <sstream>
 #include <utility>
+#include <algorithm>
 #include <cmath>
 #include <boost/foreach.hpp>
-#include <boost/range/adaptor/map.hpp>
 #include <boost/shared_ptr.hpp>
 
 #include "ValueEstimator.h"
 #include "Model.h"
+#include "UCTNodeTable.h"
+#include "NextStateStats.h"
 #include <rl_pursuit/common/RNG.h>
 #include <rl_pursuit/common/DefaultMap.h>
+#include <rl_pursuit/common/GenerationalArena.h>
 #include <rl_pursuit/common/Util.h>
 #include <rl_pursuit/common/Params.h>
 
@@ -39,32 +42,67 @@ public:
   typedef std::pair<State,Action> StateAction;
   
   struct StateActionInfo {
-    StateActionInfo(unsigned int visits, float val):
+    StateActionInfo(unsigned int visits = 0, float val = 0):
       visits(visits),
       val(val),
-      rolloutVisits(0)
+      rolloutVisits(0),
+      virtualVisits(0)
     {
     }
     unsigned int visits;
     float val;
     unsigned int rolloutVisits;
-    std::map<State,unsigned int> next_state_visits;
-    std::map<State,float> next_state_val;
+    unsigned int virtualVisits; // rollout visits in progress in every thread, see ParallelUCTEstimator
+    NextStateStats<State> next_states; // with useImportanceSampling or trackNextStates
   };
 
   struct StateInfo {
-    StateInfo(unsigned int stateVisits):
+    StateInfo(unsigned int stateVisits = 0):
       stateVisits(stateVisits),
       lastVisit(-1)
     {
     }
-    std::map<Action,StateActionInfo> actionInfos;
+    typedef typename UCTActionTable<Action,StateActionInfo>::type ActionTable;
+    ActionTable actionInfos;
     unsigned int stateVisits;
     int lastVisit;
   };
   
-  typedef typename std::map<State,StateInfo>::iterator StateIter;
-  typedef typename std::map<Action,StateActionInfo>::iterator StateActionIter;
+  // the nodes live in an arena by generation, the index only points at them,
+  // so the pointers in the history stay valid when the index grows
+  struct NodeRef {
+    NodeRef(StateInfo *info = NULL, unsigned int generation = 0):
+      info(info),
+      generation(generation)
+    {
+    }
+    StateInfo *info;
+    unsigned int generation;
+  };
+
+  typedef typename UCTStateTable<State,NodeRef>::type StateIndex;
+  typedef typename StateIndex::iterator IndexIter;
+  typedef typename StateInfo::ActionTable::iterator StateActionIter;
+
+  // the end of a rollout that the default policy played out past the tree
+  struct DefaultPolicyTail {
+    DefaultPolicyTail():
+      steps(0),
+      value(0),
+      discount(1)
+    {}
+    void add(const State &state, float reward, float gamma) {
+      if (steps == 0)
+        firstState = state;
+      value += discount * reward;
+      discount *= gamma;
+      steps++;
+    }
+    unsigned int steps;
+    float value; // discounted return of the tail
+    float discount; // gamma^steps
+    State firstState;
+  };
 
   struct HistoryStep {
     HistoryStep(const State &state, const Action &action, float reward, StateActionInfo *stateActionInfo, StateInfo *stateInfo):
@@ -92,7 +130,8 @@ public:
   _(unsigned int,initialStateActionVisits,initialStateActionVisits,0) \
   _(float,unseenValue,unseenValue,999999) \
   _(bool,theoreticallyCorrectLambda,theoreticallyCorrectLambda,false) \
-  _(bool,useImportanceSampling,useImportanceSampling,false)
+  _(bool,useImportanceSampling,useImportanceSampling,false) \
+  _(bool,trackNextStates,trackNextStates,false)
 
   Params_STRUCT(PARAMS);
 #undef PARAMS
@@ -104,14 +143,26 @@ public:
   virtual void startRollout();
   virtual void finishRollout(const State &state,bool terminal);
   virtual void visit(const State &state, const Action &action, float reward);
+  virtual bool isInTree(const State &state);
+  virtual size_t getNumNodes() {
+    return nodes.size();
+  }
+  virtual void visitDefaultPolicy(const State &state, float reward);
   virtual void restart();
   virtual std::string generateDescription(unsigned int indentation = 0);
   void pruneOldVisits(int memorySize); // 0 keeps none, -1 prunes nothing
+  void reroot(const State &state); // needs useImportanceSampling or trackNextStates
+  virtual void getActionStats(const State &state, std::vector<ActionStats<Action> > &stats);
+  virtual void addActionStats(const State &state, const std::vector<ActionStats<Action> > &stats);
+  virtual void removeActionStats(const State &state, const std::vector<ActionStats<Action> > &stats);
 
 protected:
   virtual float maxValueForState(const State &state, StateInfo *stateInfo);
   virtual float calcActionValue(StateActionInfo *stateActionInfo, StateInfo *stateInfo, bool useBounds);
   void checkInternals();
+  StateInfo* findStateInfo(const State &state);
+  StateInfo* getStateInfo(const State &state);
+  void purgeStateIndex();
   virtual Action selectAction(const State &state, bool useBounds);
   float updateStateAction(const State &state, const Action &action, const State &next_state, StateActionInfo *stateActionInfo, StateInfo *stateInfo, float newQ);
   void printValues(const State &state);
@@ -121,7 +172,8 @@ protected:
   Params p;
   bool valid;
 
-  std::map<State,StateInfo> stateInfos;
+  StateIndex stateIndex;
+  GenerationalArena<StateInfo> nodes;
 
   //DefaultMap<StateAction,float> values;
   //DefaultMap<State,unsigned int> stateVisits;
@@ -131,6 +183,7 @@ protected:
   
   //DefaultMap<StateAction,unsigned int> rolloutVisitCounts;
   std::vector<HistoryStep> history;
+  DefaultPolicyTail tail;
 public:
   static const float EPS;
   static const float BIGNUM;
@@ -195,20 +248,13 @@ void UCTEstimator<State,Action>::checkInternals() {
 template<class State, class Action>
 void UCTEstimator<State,Action>::startRollout() {
   history.clear();
+  tail = DefaultPolicyTail();
   //rolloutVisitCounts.clear();
 }
 
 template<class State, class Action>
 void UCTEstimator<State,Action>::visit(const State &state, const Action &action, float reward) {
-  StateIter it = stateInfos.find(state);
-  if (it == stateInfos.end()) {
-    std::pair<StateIter,bool> res;
-    res = stateInfos.insert(std::pair<State,StateInfo>(state,StateInfo(p.initialStateVisits)));
-    it = res.first;
-    //std::cout << "INSERTED STATE" << std::endl;
-    //std::cout << "  VIS: " << stateInfos.find(state)->second.stateVisits << std::endl;
-  }
-  StateInfo *stateInfo = &(it->second);
+  StateInfo *stateInfo = getStateInfo(state);
 
   StateActionIter ita = stateInfo->actionInfos.find(action);
   if (ita == stateInfo->actionInfos.end()) {
@@ -223,11 +269,54 @@ void UCTEstimator<State,Action>::visit(const State &state, const Action &action,
   history.push_back(HistoryStep(state,action,reward,stateActionInfo,stateInfo));
 }
 
+template<class State, class Action>
+bool UCTEstimator<State,Action>::isInTree(const State &state) {
+  return findStateInfo(state) != NULL;
+}
+
+template<class State, class Action>
+void UCTEstimator<State,Action>::visitDefaultPolicy(const State &state, float reward) {
+  tail.add(state,reward,p.gamma);
+}
+
+template<class State, class Action>
+typename UCTEstimator<State,Action>::StateInfo* UCTEstimator<State,Action>::findStateInfo(const State &state) {
+  IndexIter it = stateIndex.find(state);
+  if ((it == stateIndex.end()) || !nodes.isLive(it->second.generation))
+    return NULL;
+  return it->second.info;
+}
+
+template<class State, class Action>
+typename UCTEstimator<State,Action>::StateInfo* UCTEstimator<State,Action>::getStateInfo(const State &state) {
+  // finds or creates the node, copying it into the current generation so it survives the next prune
+  std::pair<IndexIter,bool> res = stateIndex.insert(std::pair<State,NodeRef>(state,NodeRef()));
+  NodeRef &ref = res.first->second;
+  if (!res.second && (ref.generation == nodes.generation()))
+    return ref.info;
+  if (!res.second && nodes.isLive(ref.generation))
+    ref.info = nodes.allocate(*ref.info);
+  else
+    ref.info = nodes.allocate(StateInfo(p.initialStateVisits));
+  ref.generation = nodes.generation();
+  return ref.info;
+}
+
+template<class State, class Action>
+void UCTEstimator<State,Action>::purgeStateIndex() {
+  IndexIter it = stateIndex.begin();
+  while (it != stateIndex.end()) {
+    if (!nodes.isLive(it->second.generation))
+      stateIndex.erase(it++);
+    else
+      ++it;
+  }
+}
+
 template<class State, class Action>
 Action UCTEstimator<State,Action>::selectAction(const State &state, bool useBounds) {
-  StateIter it = stateInfos.find(state);
-  if (it == stateInfos.end() ||
-      it->second.stateVisits == 0) {
+  StateInfo *stateInfo = findStateInfo(state);
+  if ((stateInfo == NULL) || (stateInfo->stateVisits == 0)) {
     //std::cout << "selectAction: NULL" << std::endl;
     // select randomly
     std::vector<Action> maxActions;
@@ -239,7 +328,6 @@ Action UCTEstimator<State,Action>::selectAction(const State &state, bool useBoun
     return maxActions[rng->randomInt(maxActions.size())];
   }
 
-  StateInfo *stateInfo = &(it->second);
   std::vector<Action> maxActions;
   float maxVal = -BIGNUM;
   float val;
@@ -304,7 +392,8 @@ Action UCTEstimator<State,Action>::selectPlanningAction(const State &state) {
 
 template<class State, class Action>
 void UCTEstimator<State,Action>::restart() {
-  stateInfos.clear();
+  stateIndex.clear();
+  nodes.clear();
 }
 
 template<class State, class Action>
@@ -357,37 +446,18 @@ float UCTEstimator<State,Action>::updateStateAction(const State &state, const Ac
     stateActionInfo->visits++;
     float learnRate = 1.0 / (stateActionInfo->visits);
     stateActionInfo->val += learnRate * (newQ - stateActionInfo->val);
+    if (p.trackNextStates)
+      stateActionInfo->next_states.addVisit(next_state);
     
     if (!p.theoreticallyCorrectLambda)
       retVal = p.lambda * newQ + (1.0 - p.lambda) * maxValueForState(state,stateInfo);
     //std::cout << " --> " << values[key] << std::endl;
     
   } else {
-    if (stateActionInfo->next_state_visits.find(next_state) ==
-        stateActionInfo->next_state_visits.end()) {
-      stateActionInfo->next_state_visits[next_state] = 0;
-      stateActionInfo->next_state_val[next_state] = 0.0f;
-    }
     stateActionInfo->visits++;
-    stateActionInfo->next_state_visits[next_state]++;
-    float learnRate = 1.0 / (stateActionInfo->next_state_visits[next_state]);
-    stateActionInfo->next_state_val[next_state] += 
-      learnRate * (newQ - stateActionInfo->next_state_val[next_state]);
-    //stateActionInfo->next_state_val[next_state] = newQ;
-
-    float probability_sum = 0;
-    float value_sum = 0;
-    BOOST_FOREACH(const State& next_state, 
-        stateActionInfo->next_state_val | boost::adaptors::map_keys) {
-      //float probability = this->model->getTransitionProbability(state, action, next_state);
-      float probability = 
-        ((float) stateActionInfo->next_state_visits[next_state]) /
-        ((float) stateActionInfo->visits);
-      probability_sum += probability;
-      value_sum += probability * stateActionInfo->next_state_val[next_state];
-    }
-
-    float value = value_sum / probability_sum;
+    // the next states are weighted by their empirical probabilities
+    //float probability = this->model->getTransitionProbability(state, action, next_state);
+    float value = stateActionInfo->next_states.update(next_state,newQ);
     if (p.theoreticallyCorrectLambda)
       retVal = p.lambda * value + (1.0 - p.lambda) * maxValueForState(state,stateInfo);
 
@@ -404,17 +474,16 @@ void UCTEstimator<State,Action>::finishRollout(const State &state, bool terminal
   float futureVal;
   float newQ;
 
-  StateIter it = stateInfos.find(state);
-  StateInfo *stateInfo = &(it->second);
-  if (it == stateInfos.end())
-    stateInfo = NULL;
+  StateInfo *stateInfo = findStateInfo(state);
 
   if (terminal)
     futureVal = 0;
   else
     futureVal = maxValueForState(state,stateInfo);
+  // the default policy's steps only contribute their rewards
+  futureVal = tail.value + tail.discount * futureVal;
 
-  State next_state = state;
+  State next_state = (tail.steps > 0) ? tail.firstState : state;
   for (int i = (int)history.size() - 1; i >= 0; i--) {
     StateAction key(history[i].state,history[i].action);
     newQ = history[i].reward +  p.gamma * futureVal;
@@ -475,24 +544,103 @@ void UCTEstimator<State,Action>::pruneOldVisits(int memorySize) {
     return;
   }
 
-  typename std::map<State,StateInfo>::iterator it = stateInfos.begin();
-  while (it != stateInfos.end()) {
-    if (it->second.lastVisit < numPruneCalls - memorySize) { //always true if memorySize is 0 because numPruneCalls is incremented above
-      stateInfos.erase(it++); // NOTE: the ++ must be like this because the we erase the copy, after incrementing the original
-    } else {
-      ++it;
+  // nodes visited since the last call are in the current generation, drop
+  // the generations older than memorySize in bulk
+  nodes.startGeneration();
+  if (nodes.generation() >= (unsigned int)memorySize)
+    nodes.releaseBefore(nodes.generation() - memorySize);
+  // the index entries of released nodes are ignored, only sweep them out once they dominate
+  if (stateIndex.size() > 2 * nodes.size() + 1024)
+    purgeStateIndex();
+}
+  
+template<class State, class Action>
+void UCTEstimator<State,Action>::reroot(const State &state) {
+  numPruneCalls++;
+  // copy the nodes reachable from state into a new generation and drop the rest
+  nodes.startGeneration();
+  std::vector<State> open(1,state);
+  while (open.size() > 0) {
+    IndexIter it = stateIndex.find(open.back());
+    open.pop_back();
+    if ((it == stateIndex.end()) || !nodes.isLive(it->second.generation) || (it->second.generation == nodes.generation()))
+      continue; // unknown or already copied
+    NodeRef &ref = it->second;
+    ref.info = nodes.allocate(*ref.info);
+    ref.generation = nodes.generation();
+    for (StateActionIter ita = ref.info->actionInfos.begin(); ita != ref.info->actionInfos.end(); ++ita) {
+      BOOST_FOREACH(const typename NextStateStats<State>::Record &record, ita->second.next_states)
+        open.push_back(record.state);
     }
   }
+  nodes.releaseBefore(nodes.generation());
+  if (stateIndex.size() > 2 * nodes.size() + 1024)
+    purgeStateIndex();
 }
-  
+
+template<class State, class Action>
+void UCTEstimator<State,Action>::getActionStats(const State &state, std::vector<ActionStats<Action> > &stats) {
+  stats.clear();
+  StateInfo *stateInfo = findStateInfo(state);
+  if (stateInfo == NULL)
+    return;
+  for (StateActionIter ita = stateInfo->actionInfos.begin(); ita != stateInfo->actionInfos.end(); ++ita) {
+    if (ita->second.visits > 0)
+      stats.push_back(ActionStats<Action>(ita->first,ita->second.visits,ita->second.val));
+  }
+}
+
+template<class State, class Action>
+void UCTEstimator<State,Action>::addActionStats(const State &state, const std::vector<ActionStats<Action> > &stats) {
+  if (stats.size() == 0)
+    return;
+  StateInfo *stateInfo = getStateInfo(state);
+  stateInfo->lastVisit = numPruneCalls;
+
+  for (unsigned int i = 0; i < stats.size(); i++) {
+    if (stats[i].visits == 0)
+      continue;
+    StateActionIter ita = stateInfo->actionInfos.find(stats[i].action);
+    if (ita == stateInfo->actionInfos.end())
+      ita = stateInfo->actionInfos.insert(std::pair<Action,StateActionInfo>(stats[i].action,StateActionInfo(p.initialStateActionVisits,p.initialValue))).first;
+    StateActionInfo *stateActionInfo = &(ita->second);
+    // visit weighted average of the two estimates
+    unsigned int visits = stateActionInfo->visits + stats[i].visits;
+    stateActionInfo->val = (stateActionInfo->visits * stateActionInfo->val + stats[i].visits * stats[i].val) / visits;
+    stateActionInfo->visits = visits;
+    stateInfo->stateVisits += stats[i].visits;
+  }
+}
+
+template<class State, class Action>
+void UCTEstimator<State,Action>::removeActionStats(const State &state, const std::vector<ActionStats<Action> > &stats) {
+  StateInfo *stateInfo = findStateInfo(state);
+  if (stateInfo == NULL)
+    return;
+  for (unsigned int i = 0; i < stats.size(); i++) {
+    StateActionIter ita = stateInfo->actionInfos.find(stats[i].action);
+    if (ita == stateInfo->actionInfos.end())
+      continue;
+    StateActionInfo *stateActionInfo = &(ita->second);
+    // inverse of the visit weighted average in addActionStats
+    unsigned int removed = std::min(stats[i].visits,stateActionInfo->visits);
+    unsigned int visits = stateActionInfo->visits - removed;
+    if (visits == 0)
+      stateActionInfo->val = p.initialValue;
+    else
+      stateActionInfo->val = (stateActionInfo->visits * stateActionInfo->val - removed * stats[i].val) / visits;
+    stateActionInfo->visits = visits;
+    stateInfo->stateVisits -= std::min(removed,stateInfo->stateVisits);
+  }
+}
+
 template<class State, class Action>
 void UCTEstimator<State,Action>::printValues(const State &state) {
-  StateIter it = stateInfos.find(state);
-  if (it == stateInfos.end()) {
+  StateInfo *stateInfo = findStateInfo(state);
+  if (stateInfo == NULL) {
     UCT_OUTPUT("No values to print");
     return;
   }
-  StateInfo *stateInfo = &(it->second);
   Action a;
   bool actionValid = true;
   std::stringstream ss;
@@ -507,19 +655,12 @@ void UCTEstimator<State,Action>::printValues(const State &state) {
     if (stateActionInfo != NULL)
       numVisits = stateActionInfo->visits;
     ss << "  " << count << ":" << a << ": " << calcActionValue(stateActionInfo,stateInfo,false) << "(" << numVisits << ")" << std::endl;
-    typedef std::pair<State, unsigned int> StateUIPair;
-    if (p.useImportanceSampling) {
+    if (p.useImportanceSampling && (stateActionInfo != NULL)) {
       ss << "-";
       std::stringstream ss2;
-      unsigned int total_visits = 0;
-      float experential_value = 0.0f;
-      BOOST_FOREACH(const StateUIPair &v, stateActionInfo->next_state_visits) {
-        ss2 << stateActionInfo->next_state_val[v.first] << "/" << v.second << ",";
-        total_visits += v.second;
-        experential_value += stateActionInfo->next_state_val[v.first] * v.second;
-      }
-      experential_value /= total_visits;
-      ss << "(" << experential_value << "/" << total_visits << ")-(" <<
+      BOOST_FOREACH(const typename NextStateStats<State>::Record &record, stateActionInfo->next_states)
+        ss2 << record.val << "/" << record.visits << ",";
+      ss << "(" << stateActionInfo->next_states.value() << "/" << stateActionInfo->next_states.getTotalVisits() << ")-(" <<
         ss2.str() << ")";
     }
     ++count;
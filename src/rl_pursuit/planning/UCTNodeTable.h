@@ -0,0 +1,52 @@
+#ifndef UCTNODETABLE_P6C1ZN3F
+#define UCTNODETABLE_P6C1ZN3F
+
+/*
+File: UCTNodeTable.h
+Author: Samuel Barrett
+Description: picks the containers the UCTEstimator indexes its nodes with.
+  Integral states get a FlatHashMap instead of a std::map, and actions for
+  which NumDenseActions is specialized keep their stats inline in a DenseMap.
+  Everything else falls back to std::map. The state table is only an index,
+  its values point at nodes in the estimator's arena, so a lookup is one probe
+  and then one pointer to the node with its action stats. The nodes can't be
+  stored in the table itself, the rollout history keeps pointers to them and
+  the table moves its entries when it grows.
+Created:  2013-08-13
+Modified: 2013-08-19
+*/
+
+#include <map>
+#include <boost/type_traits/is_integral.hpp>
+#include <boost/utility/enable_if.hpp>
+#include <rl_pursuit/common/FlatHashMap.h>
+#include <rl_pursuit/common/DenseMap.h>
+
+// specialize with value = number of actions for action types that are
+// dense enums starting at 0, like Action::Type in controller/State.h
+template<class Action>
+struct NumDenseActions {
+  static const unsigned int value = 0;
+};
+
+template<class State, class T, class Enable = void>
+struct UCTStateTable {
+  typedef std::map<State,T> type;
+};
+
+template<class State, class T>
+struct UCTStateTable<State,T,typename boost::enable_if<boost::is_integral<State> >::type> {
+  typedef FlatHashMap<State,T> type;
+};
+
+template<class Action, class T, class Enable = void>
+struct UCTActionTable {
+  typedef std::map<Action,T> type;
+};
+
+template<class Action, class T>
+struct UCTActionTable<Action,T,typename boost::enable_if_c<(NumDenseActions<Action>::value > 0)>::type> {
+  typedef DenseMap<Action,T,NumDenseActions<Action>::value> type;
+};
+
+#endif /* end of include guard: UCTNODETABLE_P6C1ZN3F */
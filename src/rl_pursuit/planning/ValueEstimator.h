@@ -6,13 +6,27 @@ File: ValueEstimator.h
 Author: Samuel Barrett
 Description: an abstract value estimator used for planning
 Created:  2011-08-23
-Modified: 2013-08-08
+Modified: 2013-08-19
 */
 
 #include <string>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include "Model.h"
 
+template<class Action>
+struct ActionStats {
+  ActionStats(const Action &action, unsigned int visits, float val):
+    action(action),
+    visits(visits),
+    val(val)
+  {
+  }
+  Action action;
+  unsigned int visits;
+  float val;
+};
+
 template<class State, class Action>
 class ValueEstimator {
 public:
@@ -28,6 +42,30 @@ public:
   virtual void restart() = 0;
   virtual std::string generateDescription(unsigned int indentation = 0) = 0;
   virtual void pruneOldVisits(int memorySize) = 0; // 1 keeps the most recent, 0 keeps none, <0 means no pruning
+  // keeps only the part of the tree reachable from state, by default everything is kept
+  virtual void reroot(const State &/*state*/) {}
+
+  // used by MCTS to expand a single node per rollout, estimators without a
+  // tree say everything is in it, so the whole rollout is visited as usual
+  virtual bool isInTree(const State &/*state*/) {
+    return true;
+  }
+  // a step past the tree taken by the default policy, only its reward is backed up
+  virtual void visitDefaultPolicy(const State &/*state*/, float /*reward*/) {}
+  // for profiling, 0 if the estimator doesn't keep nodes
+  virtual size_t getNumNodes() {
+    return 0;
+  }
+
+  // used to combine the results of independent searches (root parallel MCTS)
+  virtual void getActionStats(const State &/*state*/, std::vector<ActionStats<Action> > &stats) {
+    stats.clear();
+  }
+  virtual void addActionStats(const State &/*state*/, const std::vector<ActionStats<Action> > &/*stats*/) {
+  }
+  // undoes addActionStats with the same stats, up to rounding
+  virtual void removeActionStats(const State &/*state*/, const std::vector<ActionStats<Action> > &/*stats*/) {
+  }
 
   virtual void setModel(boost::shared_ptr<Model<State,Action> > nmodel) {
     model = nmodel;
@@ -14,6 +14,7 @@ Created:  2013-07-23
 #include <cmath>
 
 #include "PredictiveModel.h"
+#include "StateMapping.h"
 #include "VIEstimator.h"
 
 #ifdef VI_DEBUG
@@ -36,6 +37,11 @@ public:
   void loadPolicy(const std::string& file);
   void savePolicy(const std::string& file);
   Action getBestAction(const State& state) const;
+  // only the states that map to themselves are solved, and the others
+  // take their values and actions from the states they map to
+  void setStateMapping(typename StateMapping<State, Action>::Ptr state_mapping) {
+    state_mapping_ = state_mapping;
+  }
 
   virtual std::string generateDescription(unsigned int indentation = 0) {
     return std::string("stub");
@@ -45,6 +51,7 @@ private:
 
   boost::shared_ptr<PredictiveModel<State, Action> > model_;
   boost::shared_ptr<VIEstimator<State, Action> > value_estimator_;
+  typename StateMapping<State, Action>::Ptr state_mapping_;
 
   float gamma_;
   float epsilon_;
@@ -80,6 +87,14 @@ void ValueIteration<State,Action>::computePolicy() {
     for (typename std::vector<State>::const_iterator s = states.begin();
         s != states.end(); ++s) {
       const State& state = *s;
+      typename StateMapping<State, Action>::Transform transform =
+        StateMapping<State, Action>::IDENTITY;
+      if (state_mapping_.get() != NULL) {
+        State mapped_state(state);
+        transform = state_mapping_->map(mapped_state);
+        if (mapped_state != state)
+          continue; // shares the values of mapped_state
+      }
       if (model_->isTerminalState(state)) {
         value_estimator_->updateValue(state, 0);
         continue; // nothing to do here, carry on
@@ -99,6 +114,8 @@ void ValueIteration<State,Action>::computePolicy() {
         for (size_t ns_counter = 0; ns_counter < next_states.size(); 
             ++ns_counter) {
           State& ns = next_states[ns_counter];
+          if (state_mapping_.get() != NULL)
+            state_mapping_->map(ns);
           float& reward = rewards[ns_counter];
           float& probability =  probabilities[ns_counter];
           float ns_value = value_estimator_->getValue(ns);
@@ -115,6 +132,8 @@ void ValueIteration<State,Action>::computePolicy() {
       float value_change = fabs(value_estimator_->getValue(state) - value);
       max_value_change = std::max(max_value_change, value_change);
       value_estimator_->updateValue(state, value);
+      if (state_mapping_.get() != NULL)
+        best_action = state_mapping_->mapAction(best_action, transform);
       value_estimator_->setBestAction(state, best_action);
       /* VI_OUTPUT("  State #" << state << " value is " << value); */
     }
@@ -143,7 +162,13 @@ Action ValueIteration<State,Action>::getBestAction(const State& state) const {
   if (!policy_available_) {
     throw std::runtime_error("VI::getBestAction(): No policy available. Please call computePolicy() or loadPolicy() first.");
   }
-  return value_estimator_->getBestAction(state);
+  if (state_mapping_.get() == NULL)
+    return value_estimator_->getBestAction(state);
+  State mapped_state(state);
+  typename StateMapping<State, Action>::Transform transform =
+    state_mapping_->map(mapped_state);
+  return state_mapping_->unmapAction(
+      value_estimator_->getBestAction(mapped_state), transform);
 }
 
 #endif /* end of include guard: VALUEITERATION_CJEV4VVJ */
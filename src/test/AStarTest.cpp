@@ -6,7 +6,7 @@
 int main(int argc, const char *argv[])
 {
   AStar astar(Point2D(5,5));
-  std::vector<Point2D> obstacles;
+  PositionList obstacles;
   Point2D start(0,0);
   Point2D current;
   Point2D goal(3,3);
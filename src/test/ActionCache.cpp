@@ -0,0 +1,156 @@
+/*
+File: ActionCache.cpp
+Author: Samuel Barrett
+Description: tests the shared cache of agent action distributions
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/controller/ActionCache.h>
+#include <rl_pursuit/controller/PredatorGreedy.h>
+#include <rl_pursuit/controller/PredatorTeammateAware.h>
+#include <rl_pursuit/controller/World.h>
+#include <rl_pursuit/factory/WorldFactory.h>
+#include "AgentDummyTest.h"
+
+class ActionCacheTest: public ::testing::Test {
+public:
+  ActionCacheTest():
+    cache(2)
+  {
+    for (unsigned int i = 0; i < 3; i++) {
+      obs[i].positions.push_back(Point2D(i,0));
+      obs[i].positions.push_back(Point2D(2,2));
+      obs[i].preyInd = 0;
+      obs[i].myInd = 1;
+      obs[i].absPrey = obs[i].positions[0];
+      probs[i] = ActionProbs((Action::Type)i);
+    }
+  }
+
+  void expectHit(unsigned int i) {
+    ActionProbs res;
+    ASSERT_TRUE(cache.get(obs[i],res));
+    for (unsigned int a = 0; a < Action::NUM_ACTIONS; a++)
+      EXPECT_EQ(probs[i][(Action::Type)a],res[(Action::Type)a]);
+  }
+
+  void expectMiss(unsigned int i) {
+    ActionProbs res;
+    EXPECT_FALSE(cache.get(obs[i],res));
+  }
+
+protected:
+  ActionCache cache;
+  Observation obs[3];
+  ActionProbs probs[3];
+};
+
+TEST_F(ActionCacheTest,HitsAndMisses) {
+  expectMiss(0);
+  cache.put(obs[0],probs[0]);
+  expectHit(0);
+  expectMiss(1);
+  // a different agent with the same positions
+  obs[0].myInd = 0;
+  expectMiss(0);
+
+  ActionCache::Stats stats = cache.getStats();
+  EXPECT_EQ(1u,stats.hits);
+  EXPECT_EQ(3u,stats.misses);
+  EXPECT_DOUBLE_EQ(0.25,stats.getHitRate());
+}
+
+TEST_F(ActionCacheTest,LeastRecentlyUsedEviction) {
+  cache.put(obs[0],probs[0]);
+  cache.put(obs[1],probs[1]);
+  expectHit(0); // 1 is now the least recently used
+  cache.put(obs[2],probs[2]);
+  EXPECT_EQ(2u,cache.size());
+  EXPECT_EQ(1u,cache.getStats().evictions);
+  expectHit(0);
+  expectMiss(1);
+  expectHit(2);
+}
+
+TEST_F(ActionCacheTest,InvalidateAgent) {
+  cache.put(obs[0],probs[0]);
+  cache.invalidateAgent(2);
+  expectHit(0);
+  cache.invalidateAgent(1);
+  expectMiss(0);
+  cache.put(obs[0],probs[0]);
+  expectHit(0);
+  EXPECT_EQ(1u,cache.size());
+}
+
+class WorldActionCacheTest: public ::testing::Test {
+public:
+  WorldActionCacheTest():
+    dims(5,5)
+  {
+  }
+
+  boost::shared_ptr<World> createTestWorld(unsigned int seed, unsigned int cacheSize, boost::shared_ptr<AgentDummyTest> &dummy) {
+    boost::shared_ptr<RNG> rng(new RNG(seed));
+    boost::shared_ptr<World> world = createWorld(rng,createWorldModel(dims),0.1,true);
+    dummy = boost::shared_ptr<AgentDummyTest>(new AgentDummyTest(rng,dims));
+    world->addAgent(AgentModel(0,0,PREY),dummy);
+    world->addAgent(AgentModel(2,2,PREDATOR),AgentPtr(new PredatorGreedy(rng,dims)));
+    world->addAgent(AgentModel(4,1,PREDATOR),AgentPtr(new PredatorTeammateAware(rng,dims)));
+    world->addAgent(AgentModel(1,4,PREDATOR),AgentPtr(new PredatorGreedy(rng,dims)));
+    world->addAgent(AgentModel(3,3,PREDATOR),AgentPtr(new PredatorTeammateAware(rng,dims)));
+    world->setCaching(cacheSize);
+    return world;
+  }
+
+protected:
+  Point2D dims;
+};
+
+TEST_F(WorldActionCacheTest,SameTrajectories) {
+  boost::shared_ptr<AgentDummyTest> dummy, cachedDummy;
+  boost::shared_ptr<World> world = createTestWorld(3,0,dummy);
+  boost::shared_ptr<World> cachedWorld = createTestWorld(3,64,cachedDummy);
+  EXPECT_TRUE(world->getActionCache().get() == NULL);
+  ASSERT_TRUE(cachedWorld->getActionCache().get() != NULL);
+
+  Observation obs, cachedObs;
+  for (unsigned int i = 0; i < 500; i++) {
+    Action::Type action = (Action::Type)(i % Action::NUM_ACTIONS);
+    dummy->setAction(ActionProbs(action));
+    cachedDummy->setAction(ActionProbs(action));
+    world->step();
+    cachedWorld->step();
+    world->generateObservation(obs);
+    cachedWorld->generateObservation(cachedObs);
+    ASSERT_EQ(obs,cachedObs);
+  }
+  ActionCache::Stats stats = cachedWorld->getActionCache()->getStats();
+  EXPECT_EQ(4u * 500u,stats.hits + stats.misses); // the dummy is never cached
+  EXPECT_GT(stats.hits,0u);
+}
+
+TEST_F(WorldActionCacheTest,SharedWithClones) {
+  boost::shared_ptr<AgentDummyTest> dummy;
+  boost::shared_ptr<World> world = createTestWorld(3,64,dummy);
+  boost::shared_ptr<World> copy = world->clone();
+  EXPECT_EQ(world->getActionCache(),copy->getActionCache());
+
+  world->step();
+  uint64_t misses = world->getActionCache()->getStats().misses;
+  // the clone asks about the same observation
+  copy->step();
+  ActionCache::Stats stats = world->getActionCache()->getStats();
+  EXPECT_EQ(misses,stats.misses);
+  EXPECT_EQ(4u,stats.hits);
+
+  // new agents get a cache of their own
+  std::vector<AgentPtr> agents(5,AgentPtr(new PredatorGreedy(boost::shared_ptr<RNG>(new RNG(0)),dims)));
+  copy->setAgentControllers(agents);
+  EXPECT_NE(world->getActionCache(),copy->getActionCache());
+}
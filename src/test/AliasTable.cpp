@@ -0,0 +1,57 @@
+/*
+File: AliasTable.cpp
+Author: Samuel Barrett
+Description: tests sampling with the alias method
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <vector>
+#include <rl_pursuit/common/AliasTable.h>
+
+static void expectFrequencies(const std::vector<double> &probs, const AliasTable &table, RNG &rng) {
+  double total = 0;
+  for (unsigned int i = 0; i < probs.size(); i++)
+    total += probs[i];
+  ASSERT_EQ(probs.size(),table.size());
+  unsigned int numSamples = 200000;
+  std::vector<unsigned int> counts(probs.size(),0);
+  for (unsigned int i = 0; i < numSamples; i++)
+    counts[table.sample(rng)]++;
+  for (unsigned int i = 0; i < probs.size(); i++) {
+    if (probs[i] == 0)
+      EXPECT_EQ(0u,counts[i]);
+    else
+      EXPECT_NEAR(probs[i] / total,counts[i] / (double)numSamples,0.005);
+  }
+}
+
+TEST(AliasTableTest,Frequencies) {
+  RNG rng(0);
+  AliasTable table;
+  std::vector<double> probs;
+  probs.push_back(3);
+  table.build(probs);
+  for (unsigned int i = 0; i < 100; i++)
+    EXPECT_EQ(0u,table.sample(rng));
+
+  // not normalized, with an impossible entry
+  probs.push_back(0.5);
+  probs.push_back(0);
+  probs.push_back(1.5);
+  probs.push_back(0.01);
+  table.build(probs);
+  expectFrequencies(probs,table,rng);
+
+  // rebuilding with fewer entries
+  probs.clear();
+  for (unsigned int i = 0; i < 40; i++)
+    probs.push_back(1.0 / (i + 1));
+  table.build(probs);
+  expectFrequencies(probs,table,rng);
+  probs.resize(7);
+  probs[3] = 0;
+  table.build(probs);
+  expectFrequencies(probs,table,rng);
+}
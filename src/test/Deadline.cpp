@@ -0,0 +1,44 @@
+/*
+File: Deadline.cpp
+Author: Samuel Barrett
+Description: tests the Deadline class
+Created:  2013-08-15
+Modified: 2013-08-19
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <rl_pursuit/common/Deadline.h>
+
+TEST(TestDeadline,Inactive) {
+  Deadline deadline;
+  deadline.start(0);
+  for (int i = 0; i < 10000; i++)
+    EXPECT_FALSE(deadline.expired());
+  EXPECT_FALSE(deadline.hasPassed());
+  EXPECT_EQ(0u,deadline.getNumClockReads());
+}
+
+TEST(TestDeadline,Expires) {
+  Deadline deadline(0.001);
+  deadline.start(0.02);
+  unsigned int steps = 0;
+  while (!deadline.expired())
+    steps++;
+  EXPECT_TRUE(deadline.hasPassed());
+  EXPECT_TRUE(deadline.expired());
+  // only the ordering, how late it notices depends on the machine's load
+  EXPECT_GE(deadline.elapsed(),0.02);
+  // cheap steps shouldn't read the clock every time
+  EXPECT_LT(10 * deadline.getNumClockReads(),steps);
+}
+
+TEST(TestDeadline,CopiesShareEnd) {
+  Deadline deadline;
+  deadline.start(0.01);
+  Deadline copy(deadline);
+  while (!copy.expired()) {}
+  EXPECT_FALSE(deadline.hasPassed());
+  EXPECT_GE(deadline.elapsed(),0.01);
+  while (!deadline.expired()) {}
+  EXPECT_TRUE(deadline.hasPassed());
+}
@@ -0,0 +1,176 @@
+/*
+File: ExactOutcomes.cpp
+Author: Samuel Barrett
+Description: tests the exact step outcomes against enumerating every
+  combination of actions with every ordering of the agents
+Created:  2013-08-18
+Modified: 2013-08-18
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <vector>
+#include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/model/ExactOutcomes.h>
+
+typedef std::map<std::vector<Point2D>,double> OutcomeMap;
+
+// what World::step does, for every action and ordering
+void enumerateOutcomes(const Point2D &dims, const PositionList &start, const std::vector<ActionProbs> &actionProbs, OutcomeMap &outcomes) {
+  unsigned int numAgents = start.size();
+  unsigned int numOrderings = 1;
+  for (unsigned int i = 2; i <= numAgents; i++)
+    numOrderings *= i;
+  std::vector<unsigned int> actions(numAgents,0);
+  std::vector<Point2D> requested(numAgents);
+  std::vector<unsigned int> order(numAgents);
+  std::vector<Point2D> positions(numAgents);
+  outcomes.clear();
+  while (true) {
+    double prob = 1.0;
+    for (unsigned int i = 0; i < numAgents; i++) {
+      prob *= actionProbs[i][(Action::Type)actions[i]];
+      requested[i] = movePosition(dims,start[i],(Action::Type)actions[i]);
+    }
+    if (prob > 0) {
+      for (unsigned int i = 0; i < numAgents; i++)
+        order[i] = i;
+      do {
+        for (unsigned int i = 0; i < numAgents; i++)
+          positions[i] = start[i];
+        for (unsigned int i = 0; i < numAgents; i++) {
+          unsigned int agent = order[i];
+          bool collision = false;
+          for (unsigned int j = 0; j < numAgents; j++)
+            collision |= ((j != agent) && (positions[j] == requested[agent]));
+          if (!collision)
+            positions[agent] = requested[agent];
+        }
+        outcomes[positions] += prob / numOrderings;
+      } while (std::next_permutation(order.begin(),order.end()));
+    }
+    // next combination of actions
+    unsigned int i;
+    for (i = 0; i < numAgents; i++) {
+      actions[i]++;
+      if (actions[i] < Action::NUM_ACTIONS)
+        break;
+      actions[i] = 0;
+    }
+    if (i == numAgents)
+      break;
+  }
+}
+
+void randomScenario(RNG &rng, const Point2D &dims, unsigned int numAgents, PositionList &start, std::vector<ActionProbs> &actionProbs) {
+  start.clear();
+  while (start.size() < numAgents) {
+    Point2D pos(rng.randomInt(dims.x),rng.randomInt(dims.y));
+    bool taken = false;
+    for (unsigned int i = 0; i < start.size(); i++)
+      taken |= (start[i] == pos);
+    if (!taken)
+      start.push_back(pos);
+  }
+  actionProbs.resize(numAgents);
+  for (unsigned int i = 0; i < numAgents; i++) {
+    // some actions are left out entirely
+    float total = 0;
+    for (unsigned int a = 0; a < Action::NUM_ACTIONS; a++) {
+      float weight = (rng.randomFloat() < 0.3) ? 0 : rng.randomFloat();
+      actionProbs[i][(Action::Type)a] = weight;
+      total += weight;
+    }
+    if (total == 0) {
+      actionProbs[i] = ActionProbs(Action::NOOP);
+      continue;
+    }
+    for (unsigned int a = 0; a < Action::NUM_ACTIONS; a++)
+      actionProbs[i][(Action::Type)a] /= total;
+  }
+}
+
+void compareWithEnumeration(const Point2D &dims, unsigned int numAgents, unsigned int numScenarios) {
+  RNG rng(dims.x * 100 + dims.y * 10 + numAgents);
+  ExactOutcomes exact(dims);
+  PositionList start;
+  std::vector<ActionProbs> actionProbs;
+  OutcomeMap expected;
+  std::vector<PositionOutcome> outcomes;
+  std::vector<double> groupProbs;
+  for (unsigned int scenario = 0; scenario < numScenarios; scenario++) {
+    randomScenario(rng,dims,numAgents,start,actionProbs);
+    enumerateOutcomes(dims,start,actionProbs,expected);
+
+    exact.getOutcomes(start,actionProbs,outcomes);
+    OutcomeMap found;
+    double total = 0;
+    for (unsigned int i = 0; i < outcomes.size(); i++) {
+      std::vector<Point2D> positions(outcomes[i].positions.begin(),outcomes[i].positions.end());
+      found[positions] += outcomes[i].prob;
+      total += outcomes[i].prob;
+    }
+    EXPECT_NEAR(1.0,total,1e-5);
+    ASSERT_EQ(expected.size(),found.size());
+    for (OutcomeMap::iterator it = expected.begin(); it != expected.end(); ++it) {
+      EXPECT_NEAR(it->second,found[it->first],1e-6);
+      PositionList end;
+      for (unsigned int i = 0; i < numAgents; i++)
+        end.push_back(it->first[i]);
+      EXPECT_NEAR(it->second,exact.getProb(start,actionProbs,end,-1,groupProbs),1e-6);
+
+      // any end position for agent 0, like a prey that was placed again
+      double unconstrainedProb = 0;
+      for (OutcomeMap::iterator other = expected.begin(); other != expected.end(); ++other) {
+        if (std::equal(it->first.begin() + 1,it->first.end(),other->first.begin() + 1))
+          unconstrainedProb += other->second;
+      }
+      end[0] = Point2D(-5,-5);
+      EXPECT_NEAR(unconstrainedProb,exact.getProb(start,actionProbs,end,0,groupProbs),1e-6);
+    }
+
+    // an agent that jumps can't happen
+    PositionList end(start);
+    end[numAgents - 1] = movePosition(dims,start[numAgents - 1],Point2D(2,2));
+    if (expected.find(std::vector<Point2D>(end.begin(),end.end())) == expected.end()) {
+      EXPECT_EQ(0,exact.getProb(start,actionProbs,end,-1,groupProbs));
+    }
+  }
+}
+
+TEST(ExactOutcomesTest,MatchesEnumeration) {
+  compareWithEnumeration(Point2D(5,5),2,30);
+  compareWithEnumeration(Point2D(5,5),5,20);
+  compareWithEnumeration(Point2D(3,3),5,20);
+  compareWithEnumeration(Point2D(3,2),4,20); // moves overlap on the small axis
+  compareWithEnumeration(Point2D(4,4),6,3);
+}
+
+TEST(ExactOutcomesTest,Chain) {
+  // each agent wants the cell of the next one
+  PositionList start;
+  std::vector<ActionProbs> actionProbs;
+  for (int i = 0; i < 3; i++) {
+    start.push_back(Point2D(i,0));
+    actionProbs.push_back(ActionProbs(Action::RIGHT));
+  }
+  // and one that can't interact with them
+  start.push_back(Point2D(0,3));
+  actionProbs.push_back(ActionProbs(Action::UP));
+
+  ExactOutcomes exact(Point2D(6,6));
+  std::vector<double> groupProbs;
+  PositionList end(start);
+  end[3] = Point2D(0,4);
+  end[2] = Point2D(3,0);
+  EXPECT_NEAR(1.0 / 2,exact.getProb(start,actionProbs,end,-1,groupProbs),1e-6);
+  end[1] = Point2D(2,0);
+  EXPECT_NEAR(1.0 / 3,exact.getProb(start,actionProbs,end,-1,groupProbs),1e-6);
+  end[0] = Point2D(1,0);
+  EXPECT_NEAR(1.0 / 6,exact.getProb(start,actionProbs,end,-1,groupProbs),1e-6);
+  EXPECT_NEAR(1.0 / 6,groupProbs[0],1e-6);
+  EXPECT_NEAR(1.0,groupProbs[3],1e-6);
+  end[2] = Point2D(2,0);
+  EXPECT_EQ(0,exact.getProb(start,actionProbs,end,-1,groupProbs));
+}
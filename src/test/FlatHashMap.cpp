@@ -0,0 +1,65 @@
+/*
+File: FlatHashMap.cpp
+Author: Samuel Barrett
+Description: tests the FlatHashMap class
+Created:  2013-08-13
+Modified: 2013-08-13
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <map>
+#include <rl_pursuit/common/FlatHashMap.h>
+#include <rl_pursuit/common/RNG.h>
+
+TEST(TestFlatHashMap,InsertFind) {
+  FlatHashMap<uint64_t,float> map(16);
+  EXPECT_TRUE(map.find(5) == map.end());
+  EXPECT_TRUE(map.insert(std::make_pair(5,1.5)).second);
+  EXPECT_FALSE(map.insert(std::make_pair(5,2.5)).second);
+  EXPECT_FLOAT_EQ(1.5,map.find(5)->second);
+  map[7] += 2.0;
+  EXPECT_FLOAT_EQ(2.0,map.find(7)->second);
+  EXPECT_EQ((size_t)2,map.size());
+  map.clear();
+  EXPECT_EQ((size_t)0,map.size());
+  EXPECT_TRUE(map.find(5) == map.end());
+}
+
+TEST(TestFlatHashMap,MatchesMap) {
+  FlatHashMap<uint64_t,unsigned int> map(16);
+  std::map<uint64_t,unsigned int> expected;
+  RNG rng(0);
+  for (unsigned int i = 0; i < 5000; i++) {
+    uint64_t key = rng.randomInt(2000);
+    if (rng.randomFloat() < 0.3) {
+      EXPECT_EQ(expected.erase(key),map.erase(key));
+    } else {
+      expected[key] += i;
+      map[key] += i;
+    }
+  }
+  EXPECT_LT(0u,map.numRehashes());
+  EXPECT_EQ(expected.size(),map.size());
+  unsigned int count = 0;
+  for (FlatHashMap<uint64_t,unsigned int>::iterator it = map.begin(); it != map.end(); ++it) {
+    EXPECT_EQ(expected[it->first],it->second);
+    count++;
+  }
+  EXPECT_EQ(expected.size(),count);
+}
+
+TEST(TestFlatHashMap,EraseWhileIterating) {
+  FlatHashMap<int,int> map;
+  for (int i = 0; i < 100; i++)
+    map[i] = i;
+  FlatHashMap<int,int>::iterator it = map.begin();
+  while (it != map.end()) {
+    if (it->second % 2 == 0)
+      map.erase(it++);
+    else
+      ++it;
+  }
+  EXPECT_EQ((size_t)50,map.size());
+  for (int i = 0; i < 100; i++)
+    EXPECT_EQ(i % 2 == 1,map.find(i) != map.end());
+}
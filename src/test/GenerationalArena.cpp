@@ -0,0 +1,61 @@
+/*
+File: GenerationalArena.cpp
+Author: Samuel Barrett
+Description: tests the GenerationalArena class
+Created:  2013-08-14
+Modified: 2013-08-14
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <set>
+#include <rl_pursuit/common/GenerationalArena.h>
+
+TEST(TestGenerationalArena,Allocate) {
+  GenerationalArena<int> arena(4);
+  std::set<int*> ptrs;
+  for (int i = 0; i < 10; i++) {
+    int *ptr = arena.allocate(i);
+    EXPECT_EQ(i,*ptr);
+    ptrs.insert(ptr);
+  }
+  EXPECT_EQ((size_t)10,ptrs.size());
+  EXPECT_EQ((size_t)10,arena.size());
+  EXPECT_EQ(0u,arena.generation());
+}
+
+TEST(TestGenerationalArena,ReleaseGenerations) {
+  GenerationalArena<int> arena(4);
+  int *first = arena.allocate(1);
+  arena.startGeneration();
+  int *second = arena.allocate(2);
+  arena.allocate(3);
+  arena.startGeneration();
+  EXPECT_EQ(2u,arena.generation());
+  EXPECT_TRUE(arena.isLive(0));
+  EXPECT_EQ((size_t)3,arena.size());
+
+  arena.releaseBefore(1);
+  EXPECT_FALSE(arena.isLive(0));
+  EXPECT_TRUE(arena.isLive(1));
+  EXPECT_EQ((size_t)2,arena.size());
+  EXPECT_EQ(2,*second);
+
+  // the released chunk gets reused
+  EXPECT_EQ(first,arena.allocate(4));
+
+  // the current generation is always kept
+  arena.releaseBefore(10);
+  EXPECT_TRUE(arena.isLive(2));
+  EXPECT_FALSE(arena.isLive(1));
+  EXPECT_EQ((size_t)1,arena.size());
+}
+
+TEST(TestGenerationalArena,Clear) {
+  GenerationalArena<int> arena(4);
+  for (int i = 0; i < 10; i++)
+    arena.allocate(i);
+  arena.clear();
+  EXPECT_EQ((size_t)0,arena.size());
+  EXPECT_FALSE(arena.isLive(0));
+  EXPECT_TRUE(arena.isLive(arena.generation()));
+}
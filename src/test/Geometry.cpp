@@ -0,0 +1,52 @@
+/*
+File: Geometry.cpp
+Author: Samuel Barrett
+Description: tests that the geometry tables match the functions in Common
+Created:  2013-08-18
+Modified: 2013-08-18
+*/
+
+#include <algorithm>
+#include <rl_pursuit/gtest/gtest.h>
+#include <rl_pursuit/model/Geometry.h>
+
+void compareWithCommon(const Point2D &dims) {
+  Geometry geometry(dims);
+  // a margin past the grid, including values outside of the tables
+  int margin = 3 * std::max(dims.x,dims.y);
+  for (int x = -margin; x < dims.x + margin; x++) {
+    for (int y = -margin; y < dims.y + margin; y++) {
+      Point2D pos(x,y);
+      ASSERT_EQ(wrapPoint(dims,pos),geometry.wrapPoint(pos));
+      for (unsigned int a = 0; a < Action::NUM_MOVES; a++)
+        ASSERT_EQ(movePosition(dims,pos,(Action::Type)a),geometry.movePosition(pos,(Action::Type)a));
+      ASSERT_EQ(movePosition(dims,pos,Point2D(2 * x,-y)),geometry.movePosition(pos,Point2D(2 * x,-y)));
+    }
+  }
+  for (int x1 = -1; x1 <= dims.x; x1++) {
+    for (int y1 = -1; y1 <= dims.y; y1++) {
+      Point2D start(x1,y1);
+      for (int x2 = -dims.x; x2 < 2 * dims.x; x2++) {
+        for (int y2 = -dims.y; y2 < 2 * dims.y; y2++) {
+          Point2D end(x2,y2);
+          ASSERT_EQ(getDifferenceToPoint(dims,start,end),geometry.getDifferenceToPoint(start,end));
+          ASSERT_EQ(getDistanceToPoint(dims,start,end),geometry.getDistanceToPoint(start,end));
+        }
+      }
+    }
+  }
+}
+
+TEST(GeometryTest,MatchesCommon) {
+  compareWithCommon(Point2D(5,5));
+  compareWithCommon(Point2D(6,6));
+  compareWithCommon(Point2D(7,4));
+  compareWithCommon(Point2D(1,3));
+}
+
+TEST(GeometryTest,Shared) {
+  boost::shared_ptr<const Geometry> geometry = Geometry::get(Point2D(5,5));
+  EXPECT_EQ(geometry.get(),Geometry::get(Point2D(5,5)).get());
+  EXPECT_NE(geometry.get(),Geometry::get(Point2D(5,6)).get());
+  EXPECT_EQ(Point2D(5,6),Geometry::get(Point2D(5,6))->getDims());
+}
@@ -0,0 +1,125 @@
+/*
+File: MCTS.cpp
+Author: Samuel Barrett
+Description: tests the monte-carlo tree search
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <vector>
+#include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/planning/MCTS.h>
+#include <rl_pursuit/planning/UCTEstimator.h>
+#include <rl_pursuit/planning/ModelUpdaterSingle.h>
+#include <rl_pursuit/planning/IdentityStateMapping.h>
+
+// moves one state along whatever the action, and remembers the actions
+class ChainModel: public Model<int,unsigned int> {
+public:
+  void setState(const int &nstate) {
+    state = nstate;
+  }
+  void takeAction(const unsigned int &action, float &reward, int &nstate, bool &terminal, int &depth_count) {
+    actions.push_back(action);
+    state++;
+    nstate = state;
+    reward = 0;
+    terminal = false;
+    depth_count = 1;
+  }
+  void getFirstAction(const int &, unsigned int &action) {
+    action = 0;
+  }
+  bool getNextAction(const int &, unsigned int &action) {
+    action++;
+    return action < 2;
+  }
+  std::string generateDescription(unsigned int) {
+    return "ChainModel";
+  }
+
+  int state;
+  std::vector<unsigned int> actions;
+};
+
+// rollouts end after one step, each thread gets its own model
+class OneStepUpdater: public ModelUpdater<int,unsigned int> {
+public:
+  boost::shared_ptr<Model<int,unsigned int> > selectModel(const int &state) {
+    return selectModel(state,boost::shared_ptr<RNG>(),0);
+  }
+  boost::shared_ptr<Model<int,unsigned int> > selectModel(const int &state, boost::shared_ptr<RNG>, unsigned int) {
+    boost::shared_ptr<Model<int,unsigned int> > model(new OneStepModel());
+    model->setState(state);
+    return model;
+  }
+  void updateSimulationAction(const unsigned int &, const int &) {}
+  void updateRealWorldAction(const int &, const unsigned int &, const int &) {}
+
+private:
+  class OneStepModel: public ChainModel {
+  public:
+    void takeAction(const unsigned int &action, float &reward, int &nstate, bool &terminal, int &depth_count) {
+      ChainModel::takeAction(action,reward,nstate,terminal,depth_count);
+      reward = action;
+      terminal = true;
+    }
+  };
+};
+
+TEST(MCTSTest,DefaultPolicyIgnoresTreeStats) {
+  // the states past the root already have stats preferring action 0, but
+  // once the rollout has left the tree its actions are uniformly random
+  boost::shared_ptr<RNG> rng(new RNG(0));
+  UCTEstimator<int,unsigned int>::Params uctParams;
+  uctParams.rewardBound = 1.0;
+  boost::shared_ptr<UCTEstimator<int,unsigned int> > uct(new UCTEstimator<int,unsigned int>(rng,uctParams));
+  std::vector<ActionStats<unsigned int> > stats;
+  stats.push_back(ActionStats<unsigned int>(0,1000,1));
+  stats.push_back(ActionStats<unsigned int>(1,1000,0));
+  unsigned int maxDepth = 40;
+  for (unsigned int state = 1; state <= maxDepth; state++)
+    uct->addActionStats(state,stats);
+
+  boost::shared_ptr<ChainModel> model(new ChainModel());
+  MCTS<int,unsigned int>::Params p;
+  p.maxPlayouts = 1;
+  p.maxDepth = maxDepth;
+  p.expandOneNode = true;
+  MCTS<int,unsigned int> mcts(uct,boost::shared_ptr<ModelUpdater<int,unsigned int> >(new ModelUpdaterSingle<int,unsigned int>(model)),boost::shared_ptr<StateMapping<int,unsigned int> >(new IdentityStateMapping<int,unsigned int>()),p);
+  unsigned int terminations;
+  mcts.search(0,terminations);
+
+  // the first action expanded the root
+  ASSERT_EQ(maxDepth,model->actions.size());
+  unsigned int numSecondActions = 0;
+  for (unsigned int i = 1; i < model->actions.size(); i++)
+    numSecondActions += model->actions[i];
+  EXPECT_GT(numSecondActions,5u);
+  EXPECT_LT(numSecondActions,maxDepth - 5);
+}
+
+TEST(MCTSTest,WorkerStatsOnlyCountForTheWorldAction) {
+  boost::shared_ptr<RNG> rng(new RNG(0));
+  UCTEstimator<int,unsigned int>::Params uctParams;
+  uctParams.rewardBound = 1.0;
+  boost::shared_ptr<UCTEstimator<int,unsigned int> > uct(new UCTEstimator<int,unsigned int>(rng,uctParams));
+  MCTS<int,unsigned int>::Params p;
+  p.maxPlayouts = 6;
+  MCTS<int,unsigned int> mcts(uct,boost::shared_ptr<ModelUpdater<int,unsigned int> >(new OneStepUpdater()),boost::shared_ptr<StateMapping<int,unsigned int> >(new IdentityStateMapping<int,unsigned int>()),p);
+  boost::shared_ptr<RNG> workerRNG(new RNG(1));
+  mcts.addWorker(boost::shared_ptr<UCTEstimator<int,unsigned int> >(new UCTEstimator<int,unsigned int>(workerRNG,uctParams)),workerRNG);
+
+  unsigned int terminations;
+  EXPECT_EQ(6u,mcts.search(0,terminations));
+  EXPECT_EQ(1u,mcts.selectWorldAction(0));
+
+  // only the main thread's half of the playouts stay in its tree
+  std::vector<ActionStats<unsigned int> > stats;
+  uct->getActionStats(0,stats);
+  unsigned int visits = 0;
+  for (unsigned int i = 0; i < stats.size(); i++)
+    visits += stats[i].visits;
+  EXPECT_EQ(3u,visits);
+}
@@ -3,10 +3,12 @@ File: ModelUpdaterBayes.cpp
 Author: Samuel Barrett
 Description: tests ModelUpdaterBayes
 Created:  2011-10-18
-Modified: 2011-10-18
+Modified: 2013-08-19
 */
 
 #include <rl_pursuit/gtest/gtest.h>
+#include <limits>
+#include <math.h>
 #include <rl_pursuit/controller/ModelUpdaterBayes.h>
 #include "AgentDummyTest.h"
 #include <rl_pursuit/factory/PlanningFactory.h>
@@ -283,6 +285,84 @@ TEST_F(ModelUpdaterBayesTest,PolynomialActionUpdates) {
     EXPECT_NEAR(expectedProbs[i],probs[i],0.00001);
 }
 
+TEST_F(ModelUpdaterBayesTest,ThreadedUpdates) {
+  // the same beliefs as the BayesianActionUpdates, with the models spread over threads
+  updater->setNumThreads(3);
+  for (unsigned int i = 0; i < 5; i++) {
+    trueAgents[i]->setAction(Action::LEFT);
+    for (unsigned int j = 0; j < 3; j++)
+      modelsDummy[j][i]->setAction(Action::LEFT);
+  }
+  modelsDummy[1][3]->setAction(Action::RIGHT);
+  ActionProbs a;
+  a[Action::LEFT] = 0.75;
+  a[Action::RIGHT] = 0.25;
+  modelsDummy[2][3]->setAction(a);
+
+  Observation prevObs;
+  Observation currentObs;
+  world->generateObservation(prevObs);
+  world->step();
+  world->generateObservation(currentObs);
+  updater->updateRealWorldAction(prevObs,Action::LEFT,currentObs);
+  checkModelsSteps(0);
+  std::vector<double> probs = updater->getBeliefs();
+  EXPECT_NEAR(1.0 / 1.75,probs[0],0.00001);
+  EXPECT_EQ(0,probs[1]);
+  EXPECT_NEAR(0.75 / 1.75,probs[2],0.00001);
+
+  // the incorrect model was removed
+  updater->updateControllerInformation(currentObs);
+  checkNumSteps(modelsDummy[0],1);
+  checkNumSteps(modelsDummy[1],0);
+  checkNumSteps(modelsDummy[2],1);
+}
+
+TEST_F(ModelUpdaterBayesTest,MaxModels) {
+  // only the best two models are kept, although the third is above minModelProb
+  ModelUpdaterBayes::Params p;
+  p.maxModels = 2;
+  updater = boost::shared_ptr<ModelUpdaterBayes>(new ModelUpdaterBayes(rng,models,p));
+  for (unsigned int i = 0; i < 5; i++) {
+    trueAgents[i]->setAction(Action::LEFT);
+    for (unsigned int j = 0; j < 3; j++)
+      modelsDummy[j][i]->setAction(Action::LEFT);
+  }
+  ActionProbs a;
+  a[Action::LEFT] = 0.5;
+  a[Action::RIGHT] = 0.5;
+  modelsDummy[1][3]->setAction(a);
+  a[Action::LEFT] = 0.75;
+  a[Action::RIGHT] = 0.25;
+  modelsDummy[2][3]->setAction(a);
+
+  Observation prevObs;
+  Observation currentObs;
+  world->generateObservation(prevObs);
+  world->step();
+  world->generateObservation(currentObs);
+  updater->updateRealWorldAction(prevObs,Action::LEFT,currentObs);
+  std::vector<double> probs = updater->getBeliefs();
+  EXPECT_NEAR(1.0 / 1.75,probs[0],0.00001);
+  EXPECT_EQ(0,probs[1]);
+  EXPECT_NEAR(0.75 / 1.75,probs[2],0.00001);
+}
+
+TEST_F(ModelUpdaterBayesTest,LogBeliefs) {
+  // far too small to normalize as probabilities
+  std::vector<double> logProbs;
+  logProbs.push_back(-2000);
+  logProbs.push_back(-2000 - log(3.0));
+  logProbs.push_back(-std::numeric_limits<double>::infinity());
+  EXPECT_TRUE(updater->normalizeLogProbs(logProbs));
+  EXPECT_NEAR(0.75,exp(logProbs[0]),1e-10);
+  EXPECT_NEAR(0.25,exp(logProbs[1]),1e-10);
+  EXPECT_EQ(0,exp(logProbs[2]));
+  // nothing left to normalize
+  logProbs[0] = logProbs[1] = logProbs[2];
+  EXPECT_FALSE(updater->normalizeLogProbs(logProbs));
+}
+
 TEST_F(ModelUpdaterBayesTest,AdvancedTests) {
   std::vector<double> modelPrior(3);
   modelPrior[0] = 1.0;
@@ -302,6 +382,74 @@ TEST_F(ModelUpdaterBayesTest,AdvancedTests) {
     EXPECT_NEAR(modelPrior[i], sampleCounts[i] / (double)numSamples, 0.01);
 }
 
+TEST_F(ModelUpdaterBayesTest,ParallelSelection) {
+  // the workers sample from their own streams without touching the updater's
+  std::vector<double> modelPrior(3);
+  modelPrior[0] = 1.0;
+  modelPrior[1] = 0.5;
+  modelPrior[2] = 1.5;
+  for (unsigned int i = 0; i < 3; i++)
+    models[i].prob = modelPrior[i];
+  resetUpdater(BAYESIAN_UPDATES);
+  updater->normalizeProbs(modelPrior);
+  EXPECT_TRUE(updater->canSelectModelsInParallel());
+  boost::shared_ptr<RNG> workerRNG(new RNG(rng->getStream(1)));
+  RNG before(*rng);
+  unsigned int numSamples = 100000;
+
+  std::vector<unsigned int> sampleCounts(3,0);
+  for (unsigned int i = 0; i < numSamples; i++)
+    sampleCounts[updater->sampleModelInd(0,*workerRNG)]++;
+  for (unsigned int i = 0; i < 3; i++)
+    EXPECT_NEAR(modelPrior[i], sampleCounts[i] / (double)numSamples, 0.01);
+
+  // the copies in use aren't shared, and only come from the worker's own pools
+  updater->setNumSearchWorkers(2);
+  boost::shared_ptr<WorldMDP> copy1 = updater->selectModel(0,workerRNG,1);
+  boost::shared_ptr<WorldMDP> copy2 = updater->selectModel(0,workerRNG,1);
+  ASSERT_TRUE(copy1.get() != NULL);
+  EXPECT_NE(copy1.get(),copy2.get());
+  for (unsigned int i = 0; i < 3; i++) {
+    EXPECT_NE(updater->models[i].mdp.get(),copy1.get());
+    EXPECT_EQ(0u,updater->models[i].pool.size());
+    EXPECT_EQ(0u,updater->models[i].workerPools[0].size());
+  }
+  EXPECT_EQ(before.randomUInt(),rng->randomUInt());
+
+  // finished copies are rewound instead of cloned again
+  copy1.reset();
+  copy2.reset();
+  for (unsigned int i = 0; i < 100; i++)
+    updater->selectModel(0,workerRNG,1);
+  for (unsigned int i = 0; i < 3; i++)
+    EXPECT_GE(2u,updater->models[i].workerPools[1].size());
+}
+
+// an agent whose clones share something they write in step
+class AgentSharedStepTest: public AgentDummyTest {
+public:
+  AgentSharedStepTest(boost::shared_ptr<RNG> rng, const Point2D &dims):
+    AgentDummyTest(rng,dims)
+  {}
+  AgentSharedStepTest* clone() {
+    return new AgentSharedStepTest(*this);
+  }
+  bool canStepInParallel() const {
+    return false;
+  }
+};
+
+TEST_F(ModelUpdaterBayesTest,ParallelSelectionNeedsParallelAgents) {
+  std::vector<boost::shared_ptr<Agent> > agents(modelsDummy[2].begin(),modelsDummy[2].end());
+  agents[3] = boost::shared_ptr<Agent>(new AgentSharedStepTest(rng,dims));
+  models[2].mdp->setAgents(agents);
+  resetUpdater(BAYESIAN_UPDATES);
+  EXPECT_FALSE(updater->canSelectModelsInParallel());
+  boost::shared_ptr<RNG> workerRNG(new RNG(rng->getStream(1)));
+  updater->setNumSearchWorkers(1);
+  EXPECT_TRUE(updater->selectModel(0,workerRNG,0).get() == NULL);
+}
+
 TEST_F(ModelUpdaterBayesTest,CopyModel) {
   /*
   std::vector<boost::shared_ptr<Agent> > copy;
@@ -0,0 +1,52 @@
+/*
+File: NextStateStats.cpp
+Author: Samuel Barrett
+Description: tests the NextStateStats class
+Created:  2013-08-15
+Modified: 2013-08-15
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <map>
+#include <boost/cstdint.hpp>
+#include <rl_pursuit/planning/NextStateStats.h>
+#include <rl_pursuit/common/RNG.h>
+
+TEST(TestNextStateStats,MatchesWeightedMaps) {
+  NextStateStats<uint64_t> stats;
+  std::map<uint64_t,unsigned int> visits;
+  std::map<uint64_t,float> vals;
+  RNG rng(0);
+  for (unsigned int i = 0; i < 1000; i++) {
+    uint64_t state = rng.randomInt(20);
+    float newQ = rng.randomFloat();
+    visits[state]++;
+    vals[state] += (newQ - vals[state]) / visits[state];
+    float value = stats.update(state,newQ);
+
+    float expected = 0;
+    unsigned int total = 0;
+    for (std::map<uint64_t,unsigned int>::iterator it = visits.begin(); it != visits.end(); ++it) {
+      expected += it->second * vals[it->first];
+      total += it->second;
+    }
+    EXPECT_NEAR(expected / total,value,1e-4);
+  }
+  EXPECT_EQ(visits.size(),stats.size());
+  EXPECT_EQ(1000u,stats.getTotalVisits());
+  for (NextStateStats<uint64_t>::const_iterator it = stats.begin(); it != stats.end(); ++it) {
+    EXPECT_EQ(visits[it->state],it->visits);
+    EXPECT_NEAR(vals[it->state],it->val,1e-4);
+  }
+}
+
+TEST(TestNextStateStats,Copy) {
+  NextStateStats<uint64_t> stats;
+  for (uint64_t i = 0; i < 5; i++)
+    stats.addVisit(i);
+  NextStateStats<uint64_t> copy(stats);
+  stats.addVisit(7);
+  EXPECT_EQ((size_t)5,copy.size());
+  EXPECT_EQ((size_t)6,stats.size());
+  EXPECT_EQ(5u,copy.getTotalVisits());
+}
@@ -0,0 +1,111 @@
+/*
+File: ParallelUCTEstimator.cpp
+Author: Samuel Barrett
+Description: Tests the shared tree UCT estimator.
+Created:  2013-08-12
+Modified: 2013-08-19
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <set>
+#include <boost/bind.hpp>
+#include <boost/thread.hpp>
+#include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/planning/ParallelUCTEstimator.h>
+
+class ThreeActionModel: public Model<int,unsigned int> {
+public:
+  void setState(const int &) {}
+  void takeAction(const unsigned int &, float &reward, int &state, bool &terminal, int &depth_count) {
+    reward = 0;
+    state = 0;
+    terminal = true;
+    depth_count = 1;
+  }
+  void getFirstAction(const int &, unsigned int &action) {
+    action = 0;
+  }
+  bool getNextAction(const int &, unsigned int &action) {
+    action++;
+    return action < 3;
+  }
+  std::string generateDescription(unsigned int) {
+    return "ThreeActionModel";
+  }
+};
+
+class TestParallelUCT : public ::testing::Test {
+public:
+  TestParallelUCT():
+    rng(new RNG(0))
+  {
+    uctParams.lambda = 1.0;
+    uctParams.gamma = 0.9;
+    uctParams.rewardBound = 1.0;
+    uct = boost::shared_ptr<ParallelUCTEstimator<int,unsigned int> >(new ParallelUCTEstimator<int,unsigned int>(rng,uctParams,params));
+  }
+
+  void runRollouts(unsigned int numRollouts) {
+    uct->setModel(boost::shared_ptr<Model<int,unsigned int> >(new ThreeActionModel()));
+    for (unsigned int i = 0; i < numRollouts; i++) {
+      uct->startRollout();
+      unsigned int action = uct->selectPlanningAction(0);
+      uct->visit(0,action,(action == 2) ? 1 : 0);
+      uct->finishRollout(1,true);
+    }
+  }
+
+protected:
+  boost::shared_ptr<RNG> rng;
+  UCTEstimator<int,unsigned int>::Params uctParams;
+  ParallelUCTEstimator<int,unsigned int>::Params params;
+  boost::shared_ptr<ParallelUCTEstimator<int,unsigned int> > uct;
+};
+
+static void startPendingRollout(ParallelUCTEstimator<int,unsigned int> *uct, unsigned int action) {
+  uct->setModel(boost::shared_ptr<Model<int,unsigned int> >(new ThreeActionModel()));
+  uct->startRollout();
+  uct->visit(0,action,0);
+}
+
+TEST_F(TestParallelUCT,VirtualLossAvoidsPendingAction) {
+  // another thread is still rolling out action 1, so the unseen actions look better
+  boost::thread other(boost::bind(&startPendingRollout,uct.get(),1u));
+  other.join();
+  uct->setModel(boost::shared_ptr<Model<int,unsigned int> >(new ThreeActionModel()));
+  for (int i = 0; i < 20; i++)
+    EXPECT_NE(1u,uct->selectPlanningAction(0));
+}
+
+TEST_F(TestParallelUCT,OwnPendingVisitsArentLosses) {
+  // a rollout that comes back to a state isn't put off by its own visit
+  startPendingRollout(uct.get(),1);
+  unsigned int numSelected = 0;
+  for (int i = 0; i < 40; i++) {
+    if (uct->selectPlanningAction(0) == 1)
+      numSelected++;
+  }
+  EXPECT_GT(numSelected,0u);
+  uct->finishRollout(1,true);
+}
+
+TEST_F(TestParallelUCT,ThreadsShareTree) {
+  unsigned int numThreads = 4;
+  unsigned int numRollouts = 250;
+  boost::thread_group threads;
+  for (unsigned int i = 0; i < numThreads; i++)
+    threads.create_thread(boost::bind(&TestParallelUCT::runRollouts,this,numRollouts));
+  threads.join_all();
+
+  std::vector<ActionStats<unsigned int> > stats;
+  uct->getActionStats(0,stats);
+  unsigned int totalVisits = 0;
+  for (unsigned int i = 0; i < stats.size(); i++) {
+    totalVisits += stats[i].visits;
+    EXPECT_FLOAT_EQ((stats[i].action == 2) ? 1 : 0,stats[i].val);
+  }
+  EXPECT_EQ(numThreads * numRollouts,totalVisits);
+
+  uct->setModel(boost::shared_ptr<Model<int,unsigned int> >(new ThreeActionModel()));
+  EXPECT_EQ(2u,uct->selectWorldAction(0));
+}
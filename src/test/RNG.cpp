@@ -0,0 +1,96 @@
+/*
+File: RNG.cpp
+Author: Samuel Barrett
+Description: tests the bulk generation and stream splitting of RNG
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <vector>
+#include <rl_pursuit/common/RNG.h>
+
+static void expectSameStream(RNG a, RNG b) {
+  for (unsigned int i = 0; i < 100; i++)
+    ASSERT_EQ(a.randomUInt(),b.randomUInt());
+}
+
+TEST(RNGTest,BulkMatchesSingle) {
+  RNG single(5);
+  RNG bulk(5);
+  uint32_t uints[37];
+  float floats[37];
+  int32_t ints[37];
+  bulk.randomUInts(uints,37);
+  bulk.randomFloats(floats,37);
+  bulk.randomInts(ints,37,7);
+  for (unsigned int i = 0; i < 37; i++)
+    EXPECT_EQ(single.randomUInt(),uints[i]);
+  for (unsigned int i = 0; i < 37; i++)
+    EXPECT_EQ(single.randomFloat(),floats[i]);
+  for (unsigned int i = 0; i < 37; i++)
+    EXPECT_EQ(single.randomInt(7),ints[i]);
+  expectSameStream(single,bulk);
+}
+
+TEST(RNGTest,RandomOrdering) {
+  // the same shuffle as drawing one index at a time
+  RNG rng(3);
+  RNG expectedRNG(3);
+  for (unsigned int size = 0; size < 40; size++) {
+    std::vector<uint32_t> inds(size);
+    std::vector<uint32_t> expected(size);
+    rng.randomOrdering(inds);
+    for (unsigned int i = 0; i < size; i++)
+      expected[i] = i;
+    for (int i = (int)size - 1; i >= 0; i--)
+      std::swap(expected[i],expected[expectedRNG.randomInt(i + 1)]);
+    EXPECT_EQ(expected,inds);
+  }
+  expectSameStream(rng,expectedRNG);
+}
+
+TEST(RNGTest,Discard) {
+  uint64_t counts[] = {0,1,2,5,127,128,1000,12345};
+  for (unsigned int i = 0; i < sizeof(counts) / sizeof(uint64_t); i++) {
+    RNG stepped(11);
+    RNG skipped(11);
+    stepped.randomUInt(); // not from the seeded state
+    skipped.randomUInt();
+    for (uint64_t j = 0; j < counts[i]; j++)
+      stepped.randomUInt();
+    skipped.discard(counts[i]);
+    expectSameStream(stepped,skipped);
+  }
+}
+
+TEST(RNGTest,Jump) {
+  RNG jumped(2);
+  RNG discarded(2);
+  jumped.jump();
+  discarded.discard((uint64_t)1 << 63);
+  discarded.discard((uint64_t)1 << 63);
+  expectSameStream(jumped,discarded);
+}
+
+TEST(RNGTest,Streams) {
+  RNG rng(7);
+  rng.randomUInt();
+  RNG orig(rng);
+
+  // the child continues where the parent was, and the parent skips past it
+  RNG child = rng.split();
+  expectSameStream(orig,child);
+  expectSameStream(orig.getStream(0),rng);
+
+  RNG twice(orig);
+  twice.jump();
+  twice.jump();
+  expectSameStream(orig.getStream(1),twice);
+
+  // the streams are different, and getStream doesn't change the original
+  RNG stream0 = orig.getStream(0);
+  RNG stream5 = orig.getStream(5);
+  EXPECT_NE(stream0.randomUInt(),stream5.randomUInt());
+  expectSameStream(orig,child);
+}
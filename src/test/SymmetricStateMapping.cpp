@@ -0,0 +1,142 @@
+/*
+File: SymmetricStateMapping.cpp
+Author: Samuel Barrett
+Description: tests mapping symmetric planning states to the same state
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <algorithm>
+#include <set>
+#include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/controller/SymmetricStateMapping.h>
+
+class SymmetricStateMappingTest: public ::testing::Test {
+public:
+  SymmetricStateMappingTest():
+    dims(5,5),
+    numAgents(5),
+    adhocInd(2),
+    mapping(dims,numAgents,adhocInd,true,true,true),
+    rng(0)
+  {
+  }
+
+  Observation randomObservation() {
+    Observation obs;
+    obs.preyInd = 0;
+    obs.positions.push_back(0.5f * dims);
+    for (unsigned int i = 1; i < numAgents; i++)
+      obs.positions.push_back(Point2D(rng.randomInt(dims.x),rng.randomInt(dims.y)));
+    obs.absPrey = obs.positions[0];
+    return obs;
+  }
+
+  State_t getState(const Observation &obs) {
+    return getStateFromObs(dims,obs,true);
+  }
+
+  State_t getCanonicalState(const Observation &obs) {
+    State_t state = getState(obs);
+    mapping.map(state);
+    return state;
+  }
+
+protected:
+  Point2D dims;
+  unsigned int numAgents;
+  int adhocInd;
+  SymmetricStateMapping mapping;
+  RNG rng;
+};
+
+TEST_F(SymmetricStateMappingTest,SymmetricStatesShareKeys) {
+  unsigned int numAdhocSwapsChanged = 0;
+  for (unsigned int trial = 0; trial < 500; trial++) {
+    Observation obs = randomObservation();
+    State_t canonical = getCanonicalState(obs);
+    // the canonical state is its own canonical state
+    State_t state = canonical;
+    EXPECT_EQ(SymmetricStateMapping::IDENTITY,mapping.map(state));
+    EXPECT_EQ(canonical,state);
+
+    for (unsigned int transform = 0; transform < SymmetricStateMapping::NUM_TRANSFORMS; transform++) {
+      Observation transformed(obs);
+      for (unsigned int i = 1; i < numAgents; i++)
+        transformed.positions[i] = mapping.transformPosition(obs.positions[i],transform);
+      // swap two of the teammates
+      std::swap(transformed.positions[1],transformed.positions[4]);
+      EXPECT_EQ(canonical,getCanonicalState(transformed));
+    }
+
+    // but the ad hoc agent isn't interchangeable
+    Observation swapped(obs);
+    std::swap(swapped.positions[1],swapped.positions[adhocInd]);
+    if (getCanonicalState(swapped) != canonical)
+      numAdhocSwapsChanged++;
+  }
+  EXPECT_GT(numAdhocSwapsChanged,400u);
+}
+
+TEST_F(SymmetricStateMappingTest,ActionsFollowTheTransform) {
+  for (unsigned int trial = 0; trial < 500; trial++) {
+    Observation obs = randomObservation();
+    State_t mapped = getState(obs);
+    SymmetricStateMapping::Transform transform = mapping.map(mapped);
+    PositionList positions(numAgents);
+    getPositionsFromState(mapped,dims,positions,true);
+    for (unsigned int i = 0; i < Action::NUM_ACTIONS; i++) {
+      Action::Type action = (Action::Type)i;
+      Action::Type mappedAction = mapping.mapAction(action,transform);
+      EXPECT_EQ(action,mapping.unmapAction(mappedAction,transform));
+      // moving the ad hoc agent and then mapping is the same as mapping and
+      // then moving the ad hoc agent with the mapped action
+      Observation moved(obs);
+      moved.positions[adhocInd] = movePosition(dims,moved.positions[adhocInd],action);
+      Observation movedMapped(obs);
+      for (unsigned int j = 0; j < numAgents; j++)
+        movedMapped.positions[j] = positions[j];
+      movedMapped.positions[adhocInd] = movePosition(dims,movedMapped.positions[adhocInd],mappedAction);
+      EXPECT_EQ(getCanonicalState(moved),getCanonicalState(movedMapped));
+    }
+  }
+}
+
+TEST(SymmetricStateMapping,FewerStates) {
+  // the prey, the ad hoc agent and two teammates
+  Point2D dims(5,5);
+  SymmetricStateMapping mapping(dims,4,1,true,true,true);
+  State_t numStates = 25 * 25 * 25;
+  std::set<State_t> canonicalStates;
+  for (State_t state = 0; state < numStates; state++) {
+    State_t canonical = state;
+    mapping.map(canonical);
+    canonicalStates.insert(canonical);
+  }
+  // up to 8 rotations and reflections times 2 orderings of the teammates
+  EXPECT_GE(canonicalStates.size() * 16,numStates);
+  EXPECT_LT(canonicalStates.size() * 10,numStates);
+}
+
+TEST(SymmetricStateMapping,RectangularGrids) {
+  // only the reflections keep the grid the same
+  Point2D dims(6,4);
+  SymmetricStateMapping mapping(dims,3,1,true,true,false);
+  Observation obs;
+  obs.preyInd = 0;
+  obs.positions.push_back(0.5f * dims);
+  obs.positions.push_back(Point2D(0,1));
+  obs.positions.push_back(Point2D(4,3));
+  State_t canonical = getStateFromObs(dims,obs,true);
+  SymmetricStateMapping::Transform transform = mapping.map(canonical);
+  EXPECT_EQ(0u,transform & SymmetricStateMapping::TRANSPOSE);
+  for (unsigned int t = 0; t < SymmetricStateMapping::TRANSPOSE; t++) {
+    Observation transformed(obs);
+    for (unsigned int i = 1; i < 3; i++)
+      transformed.positions[i] = mapping.transformPosition(obs.positions[i],t);
+    State_t state = getStateFromObs(dims,transformed,true);
+    mapping.map(state);
+    EXPECT_EQ(canonical,state);
+  }
+}
@@ -10,6 +10,7 @@ Modified: 2011-08-23
 */
 
 #include <rl_pursuit/planning/Model.h>
+#include <rl_pursuit/common/Util.h>
 
 typedef int State;
 typedef unsigned int Action;
@@ -33,7 +34,8 @@ public:
     return state;
   }
 
-  void takeAction(const Action &action, float &reward, State &state, bool &terminal) {
+  void takeAction(const Action &action, float &reward, State &state, bool &terminal, int &depth_count) {
+    depth_count = 1;
     //std::cout << "takeAction(" << state << "," << action << ") --> ";
     int direction = 2 * (state % 2) - 1;
     switch (action) {
@@ -59,6 +61,19 @@ public:
     //std::cout << std::boolalpha << state << "," << reward << "," << terminal << std::endl;
   }
 
+  void getFirstAction(const State &, Action &action) {
+    action = 0;
+  }
+
+  bool getNextAction(const State &, Action &action) {
+    action++;
+    return action < numActions();
+  }
+
+  std::string generateDescription(unsigned int indentation = 0) {
+    return indent(indentation) + "ToyModel";
+  }
+
 private:
   unsigned int size;
   State state;
@@ -3,13 +3,16 @@ File: UCTEstimator.cpp
 Author: Samuel Barrett
 Description: Tests the UCT estimator.
 Created:  2011-08-29
-Modified: 2011-08-29
+Modified: 2013-08-19
 */
 
 #include <rl_pursuit/gtest/gtest.h>
+#include <algorithm>
 #include <set>
+#include <vector>
 #include <rl_pursuit/common/RNG.h>
 #include <rl_pursuit/planning/UCTEstimator.h>
+#include "ToyModel.h"
 
 class TestUCT : public ::testing::Test {
 public:
@@ -34,7 +37,37 @@ protected:
   }
 
   virtual void createUCT() {
-    uct = boost::shared_ptr<UCTEstimator<int,unsigned int> >(new UCTEstimator<int,unsigned int>(rng,numActions,lambda,gamma,rewardBound,rewardRangePerStep,initialValue,initialStateVisits,initialStateActionVisits,unseenValue,true));
+    UCTEstimator<int,unsigned int>::Params p;
+    p.lambda = lambda;
+    p.gamma = gamma;
+    p.rewardBound = rewardBound;
+    p.rewardRangePerStep = rewardRangePerStep;
+    p.initialValue = initialValue;
+    p.initialStateVisits = initialStateVisits;
+    p.initialStateActionVisits = initialStateActionVisits;
+    p.unseenValue = unseenValue;
+    p.theoreticallyCorrectLambda = true;
+    uct = boost::shared_ptr<UCTEstimator<int,unsigned int> >(new UCTEstimator<int,unsigned int>(rng,p));
+    // the estimator gets the actions from the model
+    uct->setModel(boost::shared_ptr<Model<int,unsigned int> >(new ToyModel(10)));
+  }
+
+  // the action's value without the exploration bonus, from the public stats
+  float calcActionValue(int state, unsigned int action) {
+    std::vector<ActionStats<unsigned int> > stats;
+    uct->getActionStats(state,stats);
+    for (unsigned int i = 0; i < stats.size(); i++) {
+      if (stats[i].action == action)
+        return stats[i].val;
+    }
+    return initialValue;
+  }
+
+  float maxValueForState(int state) {
+    float maxVal = calcActionValue(state,0);
+    for (unsigned int a = 1; a < numActions; a++)
+      maxVal = std::max(maxVal,calcActionValue(state,a));
+    return maxVal;
   }
 
   virtual void runLambdaGammaTest(float lambda,float gamma,unsigned int numActions, int states[], unsigned int actions[], float rewards[]) {
@@ -44,17 +77,17 @@ protected:
     uct->startRollout();
     for (unsigned int i = 0; i < numActions; i++)
       uct->visit(states[i],actions[i],rewards[i]);
-    uct->finishRollout(states[numActions+1],true);
+    uct->finishRollout(states[numActions],true);
 
     float val = 0;
     for (int i = numActions-1; i >= 0; i--) {
       val += rewards[i];
       for (unsigned int a = 0; a < 3; a++) {
-        //std::cerr << i << " " << a << " " << val << " " << uct->calcActionValue(states[i],a) << std::endl;
+        //std::cerr << i << " " << a << " " << val << " " << calcActionValue(states[i],a) << std::endl;
         if (a == actions[i])
-          EXPECT_EQ(val,uct->calcActionValue(states[i],a,false));
+          EXPECT_EQ(val,calcActionValue(states[i],a));
         else
-          EXPECT_EQ(0.0,uct->calcActionValue(states[i],a,false));
+          EXPECT_EQ(0.0,calcActionValue(states[i],a));
       }
       val *= gamma * lambda;
     }
@@ -91,20 +124,20 @@ TEST_F(TestUCT,UnseenWorldState) {
 
   EXPECT_EQ(numActions,actions.size());
   for (unsigned int action = 0; action < numActions; action++)
-    EXPECT_EQ(initialValue,uct->calcActionValue(state,action,false));
-  EXPECT_EQ(initialValue,uct->maxValueForState(state));
+    EXPECT_EQ(initialValue,calcActionValue(state,action));
+  EXPECT_EQ(initialValue,maxValueForState(state));
   
   initialValue = 10;
   createUCT();
   for (unsigned int action = 0; action < numActions; action++)
-    EXPECT_EQ(initialValue,uct->calcActionValue(state,action,false));
-  EXPECT_EQ(initialValue,uct->maxValueForState(state));
+    EXPECT_EQ(initialValue,calcActionValue(state,action));
+  EXPECT_EQ(initialValue,maxValueForState(state));
   
   initialValue = -10;
   createUCT();
   for (unsigned int action = 0; action < numActions; action++)
-    EXPECT_EQ(initialValue,uct->calcActionValue(state,action,false));
-  EXPECT_EQ(initialValue,uct->maxValueForState(state));
+    EXPECT_EQ(initialValue,calcActionValue(state,action));
+  EXPECT_EQ(initialValue,maxValueForState(state));
 }
 
 TEST_F(TestUCT,SimpleLambda0Gamma0) {
@@ -116,12 +149,12 @@ TEST_F(TestUCT,SimpleLambda0Gamma0) {
   uct->visit(1,0,1.0);
   uct->finishRollout(2,true);
 
-  EXPECT_EQ(0.0,uct->calcActionValue(0,0,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(0,1,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(0,2,false));
-  EXPECT_EQ(1.0,uct->calcActionValue(1,0,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(1,1,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(1,2,false));
+  EXPECT_EQ(0.0,calcActionValue(0,0));
+  EXPECT_EQ(0.0,calcActionValue(0,1));
+  EXPECT_EQ(0.0,calcActionValue(0,2));
+  EXPECT_EQ(1.0,calcActionValue(1,0));
+  EXPECT_EQ(0.0,calcActionValue(1,1));
+  EXPECT_EQ(0.0,calcActionValue(1,2));
 }
 
 TEST_F(TestUCT,SimpleLambda1Gamma0) {
@@ -133,12 +166,12 @@ TEST_F(TestUCT,SimpleLambda1Gamma0) {
   uct->visit(1,0,1.0);
   uct->finishRollout(2,true);
 
-  EXPECT_EQ(0.0,uct->calcActionValue(0,0,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(0,1,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(0,2,false));
-  EXPECT_EQ(1.0,uct->calcActionValue(1,0,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(1,1,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(1,2,false));
+  EXPECT_EQ(0.0,calcActionValue(0,0));
+  EXPECT_EQ(0.0,calcActionValue(0,1));
+  EXPECT_EQ(0.0,calcActionValue(0,2));
+  EXPECT_EQ(1.0,calcActionValue(1,0));
+  EXPECT_EQ(0.0,calcActionValue(1,1));
+  EXPECT_EQ(0.0,calcActionValue(1,2));
 }
 
 TEST_F(TestUCT,SimpleLambda1Gamma1) {
@@ -150,12 +183,12 @@ TEST_F(TestUCT,SimpleLambda1Gamma1) {
   uct->visit(1,0,1.0);
   uct->finishRollout(2,true);
 
-  EXPECT_EQ(1.0,uct->calcActionValue(0,0,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(0,1,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(0,2,false));
-  EXPECT_EQ(1.0,uct->calcActionValue(1,0,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(1,1,false));
-  EXPECT_EQ(0.0,uct->calcActionValue(1,2,false));
+  EXPECT_EQ(1.0,calcActionValue(0,0));
+  EXPECT_EQ(0.0,calcActionValue(0,1));
+  EXPECT_EQ(0.0,calcActionValue(0,2));
+  EXPECT_EQ(1.0,calcActionValue(1,0));
+  EXPECT_EQ(0.0,calcActionValue(1,1));
+  EXPECT_EQ(0.0,calcActionValue(1,2));
 }
 
 TEST_F(TestUCT,SimpleLambda075Gamma1) {
@@ -189,3 +222,54 @@ TEST_F(TestUCT,MultiRewardLambda075Gamma066) {
   float rewards[3] = {0.5,-0.2,1.0};
   runLambdaGammaTest(0.75,0.66,numActions,states,actions,rewards);
 }
+
+TEST(TestUCTReroot,KeepsReachableSubtree) {
+  UCTEstimator<int,unsigned int>::Params params;
+  params.rewardBound = 1.0;
+  params.trackNextStates = true;
+  UCTEstimator<int,unsigned int> uct(boost::shared_ptr<RNG>(new RNG(0)),params);
+  uct.setModel(boost::shared_ptr<Model<int,unsigned int> >(new ToyModel(10)));
+  int paths[3][3] = {{0,1,2},{0,5,6},{7,8,9}};
+  for (unsigned int i = 0; i < 3; i++) {
+    uct.startRollout();
+    for (unsigned int j = 0; j < 3; j++)
+      uct.visit(paths[i][j],i,0);
+    uct.finishRollout(paths[i][2]+1,true);
+  }
+
+  uct.reroot(1);
+  std::vector<ActionStats<unsigned int> > stats;
+  int kept[2] = {1,2};
+  for (unsigned int i = 0; i < 2; i++) {
+    uct.getActionStats(kept[i],stats);
+    EXPECT_EQ((size_t)1,stats.size());
+  }
+  int dropped[6] = {0,5,6,7,8,9};
+  for (unsigned int i = 0; i < 6; i++) {
+    uct.getActionStats(dropped[i],stats);
+    EXPECT_EQ((size_t)0,stats.size());
+  }
+}
+
+TEST(TestUCTDefaultPolicy,BacksUpTailRewards) {
+  UCTEstimator<int,unsigned int>::Params params;
+  params.rewardBound = 1.0;
+  params.gamma = 0.5;
+  UCTEstimator<int,unsigned int> uct(boost::shared_ptr<RNG>(new RNG(0)),params);
+  uct.setModel(boost::shared_ptr<Model<int,unsigned int> >(new ToyModel(10)));
+  uct.startRollout();
+  uct.visit(0,1,0);
+  EXPECT_TRUE(uct.isInTree(0));
+  EXPECT_FALSE(uct.isInTree(1));
+  uct.visitDefaultPolicy(1,0);
+  uct.visitDefaultPolicy(2,1);
+  uct.finishRollout(3,true);
+
+  // only the expanded node is stored, with the discounted reward of the tail
+  EXPECT_FALSE(uct.isInTree(1));
+  EXPECT_FALSE(uct.isInTree(2));
+  std::vector<ActionStats<unsigned int> > stats;
+  uct.getActionStats(0,stats);
+  ASSERT_EQ((size_t)1,stats.size());
+  EXPECT_FLOAT_EQ(0.25,stats[0].val);
+}
@@ -0,0 +1,31 @@
+/*
+File: WorkerPool.cpp
+Author: Samuel Barrett
+Description: tests running tasks on the worker pool
+Created:  2013-08-19
+Modified: 2013-08-19
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <vector>
+#include <boost/bind.hpp>
+#include <rl_pursuit/common/WorkerPool.h>
+
+static void countTask(unsigned int ind, std::vector<unsigned int> *counts) {
+  (*counts)[ind]++;
+}
+
+TEST(WorkerPoolTest,EveryTaskOnce) {
+  unsigned int threadCounts[] = {1,2,4,9};
+  for (unsigned int i = 0; i < sizeof(threadCounts) / sizeof(unsigned int); i++) {
+    WorkerPool pool(threadCounts[i]);
+    EXPECT_EQ(threadCounts[i],pool.getNumThreads());
+    // the pool is reused, with more and fewer tasks than threads
+    for (unsigned int numTasks = 0; numTasks < 50; numTasks += 7) {
+      std::vector<unsigned int> counts(numTasks,0);
+      for (unsigned int run = 0; run < 20; run++)
+        pool.run(numTasks,boost::bind(&countTask,_1,&counts));
+      EXPECT_EQ(std::vector<unsigned int>(numTasks,20),counts);
+    }
+  }
+}
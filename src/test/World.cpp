@@ -3,7 +3,7 @@ File: World.cpp
 Author: Samuel Barrett
 Description: tests the world controller
 Created:  2011-08-29
-Modified: 2011-08-29
+Modified: 2013-08-19
 */
 
 #include <rl_pursuit/gtest/gtest.h>
@@ -11,6 +11,7 @@ Modified: 2011-08-29
 #include <boost/shared_ptr.hpp>
 #include <rl_pursuit/common/RNG.h>
 #include <rl_pursuit/model/WorldModel.h>
+#include <rl_pursuit/controller/PredatorTeammateAware.h>
 #include <rl_pursuit/controller/World.h>
 #include <rl_pursuit/factory/WorldFactory.h>
 #include "AgentDummyTest.h"
@@ -46,6 +47,21 @@ public:
     return world->getOutcomeProbApprox(prevObs,currentObs,agentProbs);//,abstractAgents);
   }
 
+  double getOutcomeProb(int startPositions[5][2], int endPositions[5][2], ActionProbs actions[5]) {
+    Observation prevObs;
+    Observation currentObs;
+    for (unsigned int i = 0; i < 5; i++) {
+      prevObs.positions.push_back(Point2D(startPositions[i][0],startPositions[i][1]));
+      currentObs.positions.push_back(Point2D(endPositions[i][0],endPositions[i][1]));
+      agents[i]->setAction(actions[i]);
+    }
+    prevObs.preyInd = currentObs.preyInd = 0;
+    prevObs.absPrey = prevObs.positions[0];
+    currentObs.absPrey = currentObs.positions[0];
+    std::vector<double> agentProbs;
+    return world->getOutcomeProb(prevObs,currentObs,agentProbs);
+  }
+
 protected:
   boost::shared_ptr<RNG> rng;
   boost::shared_ptr<WorldModel> model;
@@ -206,7 +222,57 @@ TEST_F(WorldTest,OutcomeProbApproxComplex) {
   EXPECT_NEAR(1.0,total,0.001);
 }
 
-TEST_F(WorldTest,PossibleOutcomesApprox) {
+TEST_F(WorldTest,OutcomeProbComplex) {
+  // the same situation as OutcomeProbApproxComplex, but the chain of agents
+  // moving up is ordered exactly
+  ActionProbs a;
+  a[Action::NOOP] = 0.8;
+  a[Action::UP] = 0.15;
+  a[Action::DOWN] = 0.05;
+  double outcomeProb;
+  double total = 0;
+  double prob;
+
+  Action::Type lastActions[3] = {Action::NOOP,Action::UP,Action::DOWN};
+  int lastDests[3][2] = {{4,0},{4,1},{4,4}};
+
+  for (int actionInd = 0; actionInd < 3; actionInd++) {
+    int startPositions[5][2] = {{0,0},{1,0},{1,1},{3,0},{4,0}};
+    int endPositions[5][2]   = {{0,0},{1,0},{1,1},{3,0},{4,0}};
+    ActionProbs actions[5] = {ActionProbs(Action::RIGHT),ActionProbs(Action::UP),ActionProbs(Action::UP),ActionProbs(Action::NOOP),a};
+
+    double lastActionProb = a[lastActions[actionInd]];
+    endPositions[4][0] = lastDests[actionInd][0];
+    endPositions[4][1] = lastDests[actionInd][1];
+
+    outcomeProb = getOutcomeProb(startPositions,endPositions,actions);
+    EXPECT_NEAR(0.0,outcomeProb,0.001);
+
+    // the front of the chain always moves
+    endPositions[2][1] = 2;
+    outcomeProb = getOutcomeProb(startPositions,endPositions,actions);
+    prob = lastActionProb * 0.5;
+    EXPECT_NEAR(prob,outcomeProb,0.001);
+    total += prob;
+
+    endPositions[1][1] = 1;
+    outcomeProb = getOutcomeProb(startPositions,endPositions,actions);
+    prob = lastActionProb / 3;
+    EXPECT_NEAR(prob,outcomeProb,0.001);
+    total += prob;
+
+    endPositions[0][0] = 1;
+    outcomeProb = getOutcomeProb(startPositions,endPositions,actions);
+    prob = lastActionProb / 6;
+    EXPECT_NEAR(prob,outcomeProb,0.001);
+    total += prob;
+  }
+
+  // make sure we've tested every viable outcome
+  EXPECT_NEAR(1.0,total,0.001);
+}
+
+TEST_F(WorldTest,PossibleOutcomes) {
   std::vector<std::vector<WorldStepOutcome> > outcomesByAction;
   model->setAgentPosition(1,Point2D(1,2));
   ActionProbs action;
@@ -218,5 +284,89 @@ TEST_F(WorldTest,PossibleOutcomesApprox) {
   action[Action::DOWN] = 0.25;
   action[Action::NOOP] = 0.25;
   agents[2]->setAction(action);
-  world->getPossibleOutcomesApprox(abstractAgents,agents[4],outcomesByAction);
+  world->getPossibleOutcomes(abstractAgents,agents[4],outcomesByAction);
+
+  ASSERT_EQ((unsigned int)Action::NUM_ACTIONS,outcomesByAction.size());
+  for (unsigned int a = 0; a < Action::NUM_ACTIONS; a++) {
+    double total = 0;
+    for (unsigned int i = 0; i < outcomesByAction[a].size(); i++) {
+      const WorldStepOutcome &outcome = outcomesByAction[a][i];
+      EXPECT_EQ((Action::Type)a,outcome.agentDummyAction);
+      EXPECT_EQ(model->getAgentPosition(4,(Action::Type)a),outcome.obs.positions[4]);
+      total += outcome.prob;
+    }
+    EXPECT_NEAR(1.0,total,0.001);
+  }
+  // agent 1 at (1,2) and agent 2 at (2,2) can block each other, and end up in
+  // (1,3)(1,2), (1,3)(2,2), (1,3)(2,1), (1,2)(2,2), (2,2)(2,1), or (1,2)(2,1)
+  EXPECT_EQ(6u,outcomesByAction[Action::NOOP].size());
+}
+
+TEST_F(WorldTest,OutcomeLikelihood) {
+  // the same probabilities as setting the fixed agent's action, but nothing is stepped
+  ActionProbs a;
+  a[Action::LEFT] = 0.75;
+  a[Action::UP] = 0.25;
+  for (unsigned int i = 0; i < agents.size(); i++)
+    agents[i]->setAction(a);
+  Observation prevObs;
+  world->generateObservation(prevObs);
+  for (int exact = 0; exact < 2; exact++) {
+    for (unsigned int action = 0; action < Action::NUM_ACTIONS; action++) {
+      for (unsigned int i = 0; i < agents.size(); i++) {
+        Observation currentObs(prevObs);
+        currentObs.positions[i] = movePosition(model->getDims(),prevObs.positions[i],(Action::Type)action);
+        currentObs.absPrey = currentObs.positions[0];
+        std::vector<double> agentProbs;
+        std::vector<double> expectedAgentProbs;
+        double prob = world->getOutcomeLikelihood(prevObs,currentObs,4,Action::UP,agentProbs,exact);
+        for (unsigned int j = 0; j < agents.size(); j++)
+          EXPECT_EQ(0u,agents[j]->numSteps);
+
+        agents[4]->setAction(Action::UP);
+        double expected;
+        if (exact)
+          expected = world->getOutcomeProb(prevObs,currentObs,expectedAgentProbs);
+        else
+          expected = world->getOutcomeProbApprox(prevObs,currentObs,expectedAgentProbs);
+        agents[4]->setAction(a);
+        for (unsigned int j = 0; j < agents.size(); j++)
+          agents[j]->numSteps = 0;
+        EXPECT_EQ(expected,prob);
+        EXPECT_EQ(expectedAgentProbs,agentProbs);
+      }
+    }
+  }
+  for (unsigned int i = 0; i < agents.size(); i++)
+    EXPECT_EQ(Point2D(i,i),model->getAgentPosition(i));
+}
+
+TEST(World,ManyPredators) {
+  // more teammate aware predators than cells around the prey still capture it
+  boost::shared_ptr<RNG> rng(new RNG(1));
+  Point2D dims(20,20);
+  boost::shared_ptr<WorldModel> model = createWorldModel(dims);
+  boost::shared_ptr<World> world = createWorld(rng,model,0.0,true);
+  std::vector<AgentModel> agentModels;
+  createAgentModels(-1,agentModels,16);
+  ASSERT_EQ(17u,agentModels.size());
+  world->addAgent(agentModels[0],AgentPtr(new AgentDummyTest(rng,dims)),true);
+  for (unsigned int i = 1; i < agentModels.size(); i++)
+    world->addAgent(agentModels[i],AgentPtr(new PredatorTeammateAware(rng,dims)),true);
+  world->randomizePositions();
+
+  Observation obs;
+  world->generateObservation(obs);
+  for (unsigned int i = 1; i < obs.positions.size(); i++) {
+    obs.myInd = i;
+    Point2D dest = getTeammateAwareDesiredPosition(model->getGeometry(),obs);
+    EXPECT_LE(model->getGeometry().getDistanceToPoint(dest,obs.preyPos()),1u);
+  }
+
+  unsigned int numSteps = 0;
+  while (!model->isPreyCaptured() && (numSteps < 100)) {
+    world->step();
+    numSteps++;
+  }
+  EXPECT_TRUE(model->isPreyCaptured());
 }
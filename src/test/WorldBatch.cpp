@@ -0,0 +1,77 @@
+/*
+File: WorldBatch.cpp
+Author: Samuel Barrett
+Description: tests that the batched worlds follow the same trajectories as
+  worlds stepped one at a time
+Created:  2013-08-17
+Modified: 2013-08-17
+*/
+
+#include <rl_pursuit/gtest/gtest.h>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/controller/World.h>
+#include <rl_pursuit/controller/WorldBatch.h>
+#include <rl_pursuit/controller/AgentRandom.h>
+#include <rl_pursuit/controller/PredatorGreedy.h>
+#include <rl_pursuit/controller/PredatorProbabilisticDestinations.h>
+#include <rl_pursuit/factory/WorldFactory.h>
+
+void compareWithWorlds(const Point2D &dims, BatchPolicy_t predatorPolicy, double actionNoise, bool centerPrey) {
+  const unsigned int numWorlds = 7;
+  const unsigned int seed = 3;
+  WorldBatch batch(dims,numWorlds,actionNoise,centerPrey,seed);
+  batch.addAgent(PREY,BatchPolicy::RANDOM);
+  for (int i = 0; i < 4; i++)
+    batch.addAgent(PREDATOR,predatorPolicy);
+  batch.randomizePositions();
+
+  std::vector<boost::shared_ptr<World> > worlds;
+  for (unsigned int i = 0; i < numWorlds; i++) {
+    boost::shared_ptr<RNG> rng(new RNG(seed + i));
+    boost::shared_ptr<World> world = createWorld(rng,dims,actionNoise,centerPrey);
+    world->addAgent(AgentModel(0,0,PREY),boost::shared_ptr<Agent>(new AgentRandom(rng,dims)),true);
+    for (int j = 0; j < 4; j++) {
+      boost::shared_ptr<Agent> agent;
+      if (predatorPolicy == BatchPolicy::GREEDY)
+        agent = boost::shared_ptr<Agent>(new PredatorGreedy(rng,dims));
+      else
+        agent = boost::shared_ptr<Agent>(new PredatorProbabilisticDestinations(rng,dims));
+      world->addAgent(AgentModel(0,0,PREDATOR),agent,true);
+    }
+    world->randomizePositions();
+    worlds.push_back(world);
+  }
+
+  std::vector<unsigned char> captured;
+  unsigned int numCaptures = 0;
+  for (unsigned int step = 0; step < 500; step++) {
+    batch.step();
+    numCaptures += batch.findCaptures(captured);
+    for (unsigned int i = 0; i < numWorlds; i++) {
+      worlds[i]->step();
+      for (unsigned int j = 0; j < batch.getNumAgents(); j++)
+        ASSERT_EQ(worlds[i]->getModel()->getAgentPosition(j),batch.getAgentPosition(i,j));
+      bool isCaptured = worlds[i]->getModel()->isPreyCaptured();
+      ASSERT_EQ(isCaptured,batch.isPreyCaptured(i));
+      ASSERT_EQ(isCaptured,(bool)captured[i]);
+      if (isCaptured) {
+        worlds[i]->randomizePreyPosition();
+        batch.randomizePreyPosition(i);
+      }
+    }
+  }
+  EXPECT_GT(numCaptures,0u);
+}
+
+TEST(WorldBatchTest,Greedy) {
+  compareWithWorlds(Point2D(5,5),BatchPolicy::GREEDY,0.0,false);
+  compareWithWorlds(Point2D(7,7),BatchPolicy::GREEDY,0.0,true);
+  compareWithWorlds(Point2D(6,6),BatchPolicy::GREEDY,0.1,true);
+}
+
+TEST(WorldBatchTest,ProbabilisticDestinations) {
+  compareWithWorlds(Point2D(5,5),BatchPolicy::PROBABILISTIC_DESTINATIONS,0.0,true);
+  compareWithWorlds(Point2D(8,8),BatchPolicy::PROBABILISTIC_DESTINATIONS,0.1,false);
+}
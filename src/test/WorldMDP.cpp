@@ -3,7 +3,7 @@ File: WorldMDP.cpp
 Author: Samuel Barrett
 Description: test the world mdp
 Created:  2011-09-09
-Modified: 2011-09-09
+Modified: 2013-08-19
 */
 
 #include <rl_pursuit/gtest/gtest.h>
@@ -17,7 +17,7 @@ Modified: 2011-09-09
 
 TEST(WorldMDP,GetSetPositions) {
   Observation obs;
-  std::vector<Point2D> positions(5);
+  PositionList positions(5);
   Point2D dims(50,50);
   RNG rng(0);
   unsigned int numTests = 5000;
@@ -44,6 +44,27 @@ TEST(WorldMDP,GetSetPositions) {
   }
 }
 
+TEST(WorldMDP,HashedStates) {
+  Point2D dims(50,50);
+  EXPECT_TRUE(isStatePackedExactly(Point2D(5,5),5,false));
+  EXPECT_TRUE(isStatePackedExactly(dims,5,true));
+  EXPECT_FALSE(isStatePackedExactly(dims,9,true));
+
+  // hashed states still ignore where the prey is when using its symmetry
+  RNG rng(0);
+  Observation obs;
+  for (unsigned int i = 0; i < 9; i++)
+    obs.positions.push_back(Point2D(rng.randomInt(dims.x),rng.randomInt(dims.y)));
+  Observation shifted(obs);
+  for (unsigned int i = 0; i < 9; i++)
+    shifted.positions[i] = movePosition(dims,obs.positions[i],Point2D(7,3));
+  State_t state = getStateFromObs(dims,obs,true);
+  EXPECT_EQ(state,getStateFromObs(dims,shifted,true));
+  EXPECT_NE(state,getStateFromObs(dims,shifted,false));
+  shifted.positions[8] = movePosition(dims,shifted.positions[8],Action::RIGHT);
+  EXPECT_NE(state,getStateFromObs(dims,shifted,true));
+}
+
 class WorldMDPTest: public ::testing::Test {
 public:
   WorldMDPTest():
@@ -104,7 +125,7 @@ TEST_F(WorldMDPTest,TakeAction) {
     EXPECT_EQ(1u,agents[i]->numSteps);
   Point2D offset(2,2);
   Point2D start;
-  std::vector<Point2D> positions(5);
+  PositionList positions(5);
   getPositionsFromState(state,dims,positions,true);
   for (int i = 0; i < 5; i++) {
     start = Point2D(i,0);
@@ -190,3 +211,74 @@ TEST_F(WorldMDPTest,SetAgents) {
   for (int i = 0; i < 5; i++)
     EXPECT_EQ(2u,newAgents[i]->numSteps);
 }
+
+TEST_F(WorldMDPTest,IncrementalStates) {
+  // every key is checked against the one from scratch, and for collisions
+  mdp->setIncrementalStates(true,true);
+  RNG actionRNG(1);
+  float reward;
+  State_t state;
+  bool terminal;
+  Observation obs;
+  for (unsigned int i = 0; i < 5000; i++) {
+    for (int j = 0; j < 5; j++)
+      agents[j]->setAction((Action::Type)actionRNG.randomInt(Action::NUM_ACTIONS));
+    mdp->takeAction((Action::Type)actionRNG.randomInt(Action::NUM_ACTIONS),reward,state,terminal);
+    mdp->generateAdhocObservation(obs);
+    ASSERT_EQ(mdp->getState(obs),state);
+  }
+  EXPECT_EQ(0u,mdp->getNumStateKeyCollisions());
+
+  // they can't be unpacked, but the planner can return to its root
+  mdp->setPreyPos(obs.absPrey);
+  state = mdp->getRootState(obs);
+  boost::shared_ptr<WorldMDP> copy = mdp->clone();
+  for (int j = 0; j < 5; j++)
+    agents[j]->setAction(Action::LEFT);
+  mdp->takeAction(Action::LEFT,reward,state,terminal);
+  EXPECT_NE(mdp->getState(obs),state);
+  mdp->setState(mdp->getState(obs));
+  Observation res;
+  mdp->generateAdhocObservation(res);
+  EXPECT_EQ(obs,res);
+  copy->setState(mdp->getState(obs));
+  copy->generateAdhocObservation(res);
+  EXPECT_EQ(obs,res);
+}
+
+TEST(WorldMDP,HashedRootState) {
+  // too many agents to pack the state, but the planner can return to its root
+  boost::shared_ptr<RNG> rng(new RNG(0));
+  Point2D dims(50,50);
+  boost::shared_ptr<WorldMDP> mdp = createWorldMDP(rng,dims,true,false,NO_MODEL_UPDATES,StateConverter(5,5),0.0,true);
+  std::vector<AgentModel> agentModels;
+  std::vector<boost::shared_ptr<Agent> > agents;
+  createAgentModels(0,agentModels,8);
+  for (unsigned int i = 0; i < agentModels.size(); i++) {
+    agentModels[i].pos = Point2D(3 * i,i);
+    boost::shared_ptr<AgentDummyTest> agent(new AgentDummyTest(rng,dims));
+    if (agentModels[i].type == ADHOC)
+      mdp->setAdhocAgent(agent);
+    agents.push_back(agent);
+  }
+  mdp->addAgents(agentModels,agents);
+  ASSERT_FALSE(isStatePackedExactly(dims,agentModels.size(),true));
+
+  Observation obs;
+  mdp->generateAdhocObservation(obs);
+  mdp->setPreyPos(obs.absPrey);
+  State_t state = mdp->getRootState(obs);
+  boost::shared_ptr<WorldMDP> copy = mdp->clone();
+  Observation moved(obs);
+  for (unsigned int i = 0; i < agentModels.size(); i++)
+    moved.positions[i] = Point2D(i,3 * i);
+  mdp->setState(moved);
+  mdp->setState(state);
+  copy->setState(state);
+
+  Observation res;
+  mdp->generateAdhocObservation(res);
+  EXPECT_EQ(obs,res);
+  copy->generateAdhocObservation(res);
+  EXPECT_EQ(obs,res);
+}
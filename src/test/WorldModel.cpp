@@ -3,7 +3,7 @@ File: WorldModel.cpp
 Author: Samuel Barrett
 Description: tests the world model
 Created:  2011-08-29
-Modified: 2011-08-29
+Modified: 2013-08-19
 */
 
 #include <rl_pursuit/gtest/gtest.h>
@@ -119,3 +119,79 @@ TEST_F(WorldModelTest,Capture) {
   model->setAgentPosition(4,Point2D(1,2));
   EXPECT_TRUE(model->isPreyCaptured());
 }
+
+TEST_F(WorldModelTest,Occupancy) {
+  // compare against scanning the agents while they move around and overlap
+  RNG rng(0);
+  Point2D dims = model->getDims();
+  for (int step = 0; step < 1000; step++) {
+    unsigned int ind = rng.randomInt(model->getNumAgents());
+    model->setAgentPosition(ind,Point2D(rng.randomInt(dims.x),rng.randomInt(dims.y)));
+    for (int x = 0; x < dims.x; x++) {
+      for (int y = 0; y < dims.y; y++) {
+        for (int skipInd = -1; skipInd < 5; skipInd++) {
+          for (int maxInd = -1; maxInd <= 5; maxInd++) {
+            int expected = -1;
+            int end = (maxInd < 0) ? 5 : maxInd;
+            for (int i = 0; i < end; i++) {
+              if ((i != skipInd) && (model->getAgentPosition(i) == Point2D(x,y))) {
+                expected = i;
+                break;
+              }
+            }
+            ASSERT_EQ(expected,model->getCollision(Point2D(x,y),skipInd,maxInd));
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST_F(WorldModelTest,LiveObservation) {
+  // the live views match observations generated from scratch as agents move
+  RNG rng(1);
+  Point2D dims = model->getDims();
+  for (int step = 0; step < 1000; step++) {
+    unsigned int ind = rng.randomInt(model->getNumAgents());
+    model->setAgentPosition(ind,Point2D(rng.randomInt(dims.x),rng.randomInt(dims.y)));
+    for (int center = 0; center < 2; center++) {
+      Observation expected;
+      expected.preyInd = 0;
+      expected.myInd = 0;
+      for (unsigned int i = 0; i < model->getNumAgents(); i++)
+        expected.positions.push_back(model->getAgentPosition(i));
+      expected.absPrey = model->getAgentPosition(0);
+      if (center)
+        expected.centerPrey(model->getGeometry());
+      Observation &obs = model->getObservation(center);
+      obs.myInd = 0;
+      ASSERT_EQ(expected,obs);
+    }
+  }
+}
+
+TEST_F(WorldModelTest,StateKey) {
+  // the incremental key matches the one from scratch as agents move
+  RNG rng(2);
+  Point2D dims = model->getDims();
+  for (int usePreySymmetry = 0; usePreySymmetry < 2; usePreySymmetry++) {
+    boost::shared_ptr<const ZobristTable> table = ZobristTable::get(dims,model->getNumAgents(),usePreySymmetry);
+    model->setZobristTable(table);
+    for (int step = 0; step < 1000; step++) {
+      unsigned int ind = rng.randomInt(model->getNumAgents());
+      model->setAgentPosition(ind,Point2D(rng.randomInt(dims.x),rng.randomInt(dims.y)));
+      Observation obs;
+      model->generateObservation(obs,step % 2);
+      ASSERT_EQ(table->getKey(obs),model->getStateKey());
+    }
+
+    // moving everyone together only matters without the prey symmetry
+    uint64_t key = model->getStateKey();
+    for (unsigned int i = 0; i < model->getNumAgents(); i++)
+      model->setAgentPosition(i,movePosition(dims,model->getAgentPosition(i),Point2D(2,1)));
+    if (usePreySymmetry)
+      EXPECT_EQ(key,model->getStateKey());
+    else
+      EXPECT_NE(key,model->getStateKey());
+  }
+}
@@ -0,0 +1,100 @@
+/*
+File: geometrySpeed.cpp
+Author: Samuel Barrett
+Description: compares the geometry tables against the functions in Common
+  for moving and measuring between random positions.
+  Usage: geometrySpeed [numCalls] [size ...], defaulting to 5 20 100
+Created:  2013-08-18
+Modified: 2013-08-18
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+#include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/common/Util.h>
+#include <rl_pursuit/model/Geometry.h>
+
+const unsigned int NUM_POSITIONS = 1024; // a power of 2
+
+// the sum keeps the compiler from dropping the calls
+void report(const std::string &name, double time, unsigned int numCalls, unsigned int sum) {
+  std::cout << "  " << name << ": " << 1e9 * time / numCalls << " ns/call (" << sum << ")" << std::endl;
+}
+
+void runCommon(const Point2D &dims, const std::vector<Point2D> &positions, unsigned int numCalls) {
+  std::cout << " Common:" << std::endl;
+  unsigned int sum = 0;
+  double time = getTime();
+  for (unsigned int i = 0; i < numCalls; i++) {
+    Point2D pos = movePosition(dims,positions[i & (NUM_POSITIONS - 1)],(Action::Type)(i % Action::NUM_MOVES));
+    sum += pos.x + pos.y;
+  }
+  report("movePosition",getTime() - time,numCalls,sum);
+
+  sum = 0;
+  time = getTime();
+  for (unsigned int i = 0; i < numCalls; i++) {
+    Point2D diff = getDifferenceToPoint(dims,positions[i & (NUM_POSITIONS - 1)],positions[(i + 1) & (NUM_POSITIONS - 1)]);
+    sum += diff.x + diff.y;
+  }
+  report("getDifferenceToPoint",getTime() - time,numCalls,sum);
+
+  sum = 0;
+  time = getTime();
+  for (unsigned int i = 0; i < numCalls; i++)
+    sum += getDistanceToPoint(dims,positions[i & (NUM_POSITIONS - 1)],positions[(i + 1) & (NUM_POSITIONS - 1)]);
+  report("getDistanceToPoint",getTime() - time,numCalls,sum);
+}
+
+void runGeometry(const Geometry &geometry, const std::vector<Point2D> &positions, unsigned int numCalls) {
+  std::cout << " Geometry:" << std::endl;
+  unsigned int sum = 0;
+  double time = getTime();
+  for (unsigned int i = 0; i < numCalls; i++) {
+    Point2D pos = geometry.movePosition(positions[i & (NUM_POSITIONS - 1)],(Action::Type)(i % Action::NUM_MOVES));
+    sum += pos.x + pos.y;
+  }
+  report("movePosition",getTime() - time,numCalls,sum);
+
+  sum = 0;
+  time = getTime();
+  for (unsigned int i = 0; i < numCalls; i++) {
+    Point2D diff = geometry.getDifferenceToPoint(positions[i & (NUM_POSITIONS - 1)],positions[(i + 1) & (NUM_POSITIONS - 1)]);
+    sum += diff.x + diff.y;
+  }
+  report("getDifferenceToPoint",getTime() - time,numCalls,sum);
+
+  sum = 0;
+  time = getTime();
+  for (unsigned int i = 0; i < numCalls; i++)
+    sum += geometry.getDistanceToPoint(positions[i & (NUM_POSITIONS - 1)],positions[(i + 1) & (NUM_POSITIONS - 1)]);
+  report("getDistanceToPoint",getTime() - time,numCalls,sum);
+}
+
+int main(int argc, const char *argv[])
+{
+  unsigned int numCalls = 20000000;
+  if (argc > 1)
+    numCalls = atoi(argv[1]);
+  std::vector<int> sizes;
+  for (int i = 2; i < argc; i++)
+    sizes.push_back(atoi(argv[i]));
+  if (sizes.size() == 0) {
+    sizes.push_back(5);
+    sizes.push_back(20);
+    sizes.push_back(100);
+  }
+
+  RNG rng(0);
+  for (unsigned int i = 0; i < sizes.size(); i++) {
+    Point2D dims(sizes[i],sizes[i]);
+    std::vector<Point2D> positions(NUM_POSITIONS);
+    for (unsigned int j = 0; j < NUM_POSITIONS; j++)
+      positions[j] = Point2D(rng.randomInt(dims.x),rng.randomInt(dims.y));
+    std::cout << dims << std::endl;
+    runCommon(dims,positions,numCalls);
+    runGeometry(*Geometry::get(dims),positions,numCalls);
+  }
+  return 0;
+}
@@ -0,0 +1,90 @@
+/*
+File: worldStepSpeed.cpp
+Author: Samuel Barrett
+Description: measures how many steps per second the world simulation runs,
+  with a random prey and greedy predators, restarting when the prey is caught.
+  Usage: worldStepSpeed [numSteps] [size] [numWorlds] [numPredators], where
+  numWorlds > 0 steps that many worlds together with WorldBatch
+Created:  2013-08-17
+Modified: 2013-08-19
+*/
+
+#include <iostream>
+#include <cstdlib>
+#include <boost/shared_ptr.hpp>
+#include <rl_pursuit/common/RNG.h>
+#include <rl_pursuit/common/Util.h>
+#include <rl_pursuit/model/WorldModel.h>
+#include <rl_pursuit/controller/World.h>
+#include <rl_pursuit/controller/AgentRandom.h>
+#include <rl_pursuit/controller/PredatorGreedy.h>
+#include <rl_pursuit/controller/WorldBatch.h>
+
+void runBatch(const Point2D &dims, unsigned int numSteps, unsigned int numWorlds, unsigned int numPredators) {
+  WorldBatch batch(dims,numWorlds,0.1,true,0);
+  batch.addAgent(PREY,BatchPolicy::RANDOM);
+  for (unsigned int i = 0; i < numPredators; i++)
+    batch.addAgent(PREDATOR,BatchPolicy::GREEDY);
+  batch.randomizePositions();
+
+  std::vector<unsigned char> captured;
+  unsigned int numCaptures = 0;
+  unsigned int numBatchSteps = numSteps / numWorlds;
+  double time = getTime();
+  for (unsigned int i = 0; i < numBatchSteps; i++) {
+    batch.step();
+    if (batch.findCaptures(captured) == 0)
+      continue;
+    for (unsigned int j = 0; j < numWorlds; j++) {
+      if (captured[j]) {
+        numCaptures++;
+        batch.randomizePreyPosition(j);
+      }
+    }
+  }
+  time = getTime() - time;
+  numSteps = numBatchSteps * numWorlds;
+  std::cout << "time: " << time << std::endl;
+  std::cout << "numSteps: " << numSteps << " numCaptures: " << numCaptures << " numWorlds: " << numWorlds << " numPredators: " << numPredators << std::endl;
+  std::cout << "stepsPerSecond: " << numSteps / time << std::endl;
+}
+
+int main(int argc, const char *argv[])
+{
+  unsigned int numSteps = 1000000;
+  if (argc > 1)
+    numSteps = atoi(argv[1]);
+  int size = 5;
+  if (argc > 2)
+    size = atoi(argv[2]);
+  Point2D dims(size,size);
+  unsigned int numPredators = 4;
+  if (argc > 4)
+    numPredators = atoi(argv[4]);
+  if ((argc > 3) && (atoi(argv[3]) > 0)) {
+    runBatch(dims,numSteps,atoi(argv[3]),numPredators);
+    return 0;
+  }
+  boost::shared_ptr<RNG> rng(new RNG(0));
+  boost::shared_ptr<WorldModel> model(new WorldModel(dims));
+  World world(rng,model,0.1,true);
+  world.addAgent(AgentModel(0,0,PREY),boost::shared_ptr<Agent>(new AgentRandom(rng,dims)),true);
+  for (unsigned int i = 0; i < numPredators; i++)
+    world.addAgent(AgentModel(0,0,PREDATOR),boost::shared_ptr<Agent>(new PredatorGreedy(rng,dims)),true);
+  world.randomizePositions();
+
+  unsigned int numCaptures = 0;
+  double time = getTime();
+  for (unsigned int i = 0; i < numSteps; i++) {
+    world.step();
+    if (model->isPreyCaptured()) {
+      numCaptures++;
+      world.randomizePreyPosition();
+    }
+  }
+  time = getTime() - time;
+  std::cout << "time: " << time << std::endl;
+  std::cout << "numSteps: " << numSteps << " numCaptures: " << numCaptures << " numPredators: " << numPredators << std::endl;
+  std::cout << "stepsPerSecond: " << numSteps / time << std::endl;
+  return 0;
+}